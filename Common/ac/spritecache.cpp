@@ -22,6 +22,12 @@
 #pragma warning (disable: 4996 4312)  // disable deprecation warnings
 #endif
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 #include "ac/common.h" // quit
 #include "ac/gamestructdefines.h"
 #include "ac/spritecache.h"
@@ -30,6 +36,8 @@
 #include "gfx/bitmap.h"
 #include "util/compress.h"
 #include "util/file.h"
+#include "util/memory.h"
+#include "util/memorymap.h"
 #include "util/stream.h"
 
 using namespace AGS::Common;
@@ -39,8 +47,14 @@ extern void initialize_sprite(int);
 extern void pre_save_sprite(int);
 extern void get_new_size_for_sprite(int, int, int, int &, int &);
 
-#define START_OF_LIST -1
-#define END_OF_LIST   -1
+// Part of the cache size reserved for the protected MRU segment, in percents
+#define MRU_PROTECTED_PERCENT 80
+// Sprites larger than this part of cache size are never protected, in percents
+#define MRU_LARGE_SPRITE_PERCENT 12
+// Largest sprite file which is mapped into memory by the 32-bit builds; the
+// whole file is mapped in one view, so the larger ones would take too much
+// of the address space
+#define MAX_MAPPED_FILE_SIZE_32BIT (256 * 1024 * 1024)
 
 const char *spindexid = "SPRINDEX";
 
@@ -71,10 +85,78 @@ SpriteCache::SpriteData::~SpriteData()
 }
 
 
+// Background sprite loader: reads and decompresses requested sprites using
+// its own file stream. The loaded bitmaps are handed back to the cache, which
+// finishes their initialization on the main thread.
+struct SpriteCache::SpriteLoader
+{
+    struct Request
+    {
+        sprkey_t Index;
+        soff_t   Offset;
+    };
+
+    struct Result
+    {
+        sprkey_t Index;
+        int      ColorDepth;
+        Bitmap  *Image;
+    };
+
+    std::unique_ptr<Stream>  In;
+    SpriteCompression        Compress = kSprCompress_None;
+    // Memory mapped sprite file, owned by the cache
+    const MemoryMappedFile  *Map = nullptr;
+    std::thread              Thread;
+    std::mutex               Mutex;
+    std::condition_variable  CV;
+    bool                     Running = false;
+    std::deque<Request>      Queue;
+    std::vector<Result>      Results;
+    // Index of the sprite that is being loaded right now
+    sprkey_t                 Loading = -1;
+    // Quick test for the finished results, without locking a mutex
+    std::atomic<bool>        HasResults;
+
+    SpriteLoader() : HasResults(false) {}
+
+    void Run()
+    {
+        std::unique_lock<std::mutex> lk(Mutex);
+        for (;;)
+        {
+            CV.wait(lk, [this] { return !Running || !Queue.empty(); });
+            if (!Running)
+                break;
+            Request req = Queue.front();
+            Queue.pop_front();
+            Loading = req.Index;
+            lk.unlock();
+
+            int coldep;
+            Bitmap *image;
+            if (!Map || !SpriteCache::ReadSpriteMapped(*Map, Compress, req.Offset, image, coldep))
+            {
+                In->Seek(req.Offset, kSeekBegin);
+                image = SpriteCache::ReadSprite(In.get(), Compress, coldep);
+            }
+
+            lk.lock();
+            Result res = { req.Index, coldep, image };
+            Results.push_back(res);
+            Loading = -1;
+            HasResults = true;
+            CV.notify_all();
+        }
+    }
+};
+
+
 SpriteCache::SpriteCache(std::vector<SpriteInfo> &sprInfos)
     : _sprInfos(sprInfos)
 {
-    _compressed = false;
+    _compress = kSprCompress_None;
+    _policy = kSprCache_SegmentedLRU;
     Init();
 }
 
@@ -117,19 +199,48 @@ void SpriteCache::SetMaxCacheSize(size_t size)
     _maxCacheSize = size;
 }
 
+void SpriteCache::SetCachePolicy(SpriteCachePolicy policy)
+{
+    if (_policy == policy)
+        return;
+    _policy = policy;
+    // Plain LRU has no protected segment, move everything to probation
+    if (_policy == kSprCache_LRU)
+    {
+        while (_mru[kMRU_Protected].Oldest >= 0)
+        {
+            sprkey_t index = _mru[kMRU_Protected].Oldest;
+            MRUUnlink(index);
+            MRULinkNewest(index, kMRU_Probation);
+        }
+    }
+}
+
+const SpriteCacheStats &SpriteCache::GetStats() const
+{
+    return _stats;
+}
+
+void SpriteCache::ResetStats()
+{
+    _stats = SpriteCacheStats();
+}
+
 void SpriteCache::Init()
 {
     _cacheSize = 0;
     _lockedSize = 0;
     _maxCacheSize = (size_t)DEFAULTCACHESIZE_KB * 1024;
-    _liststart = -1;
-    _listend = -1;
     _lastLoad = -2;
+    MRUReset();
 }
 
 void SpriteCache::Reset()
 {
+    StopLoader();
+    _mapping.reset();
     _stream.reset();
+    _filename = "";
     // TODO: find out if it's safe to simply always delete _spriteData.Image with array element
     for (size_t i = 0; i < _spriteData.size(); ++i)
     {
@@ -141,8 +252,7 @@ void SpriteCache::Reset()
     }
     _spriteData.clear();
 
-    _mrulist.clear();
-    _mrubacklink.clear();
+    _mruLinks.clear();
 
     Init();
 }
@@ -159,6 +269,7 @@ void SpriteCache::SetSprite(sprkey_t index, Bitmap *sprite)
         Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Error, "SetSprite: attempt to assign nullptr to index %d", index);
         return;
     }
+    MRUUnlink(index);
     _spriteData[index].Image = sprite;
     _spriteData[index].Flags = SPRCACHEFLAG_LOCKED; // NOT from asset file
     _spriteData[index].Offset = 0;
@@ -197,6 +308,7 @@ void SpriteCache::RemoveSprite(sprkey_t index, bool freeMemory)
 {
     if (freeMemory)
         delete _spriteData[index].Image;
+    MRUUnlink(index);
     InitNullSpriteParams(index);
 #ifdef DEBUG_SPRITECACHE
     Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Debug, "RemoveSprite: %d", index);
@@ -213,8 +325,7 @@ sprkey_t SpriteCache::EnlargeTo(sprkey_t topmost)
     size_t newsize = topmost + 1;
     _sprInfos.resize(newsize);
     _spriteData.resize(newsize);
-    _mrulist.resize(newsize);
-    _mrubacklink.resize(newsize);
+    _mruLinks.resize(newsize);
     return topmost;
 }
 
@@ -268,57 +379,131 @@ Bitmap *SpriteCache::operator [] (sprkey_t index)
     if (index < 0 || (size_t)index >= _spriteData.size())
         return nullptr;
 
+    if (_loader && _loader->HasResults)
+        CollectLoadedSprites();
+
     // Externally added sprite, don't put it into MRU list
     if (_spriteData[index].IsExternalSprite())
         return _spriteData[index].Image;
 
     // Sprite exists in file but is not in mem, load it
     if ((_spriteData[index].Image == nullptr) && _spriteData[index].IsAssetSprite())
-        LoadSprite(index);
-
-    // Locked sprite that shouldn't be put into MRU list
-    if (_spriteData[index].IsLocked())
-        return _spriteData[index].Image;
-
-    if (_liststart < 0)
-    {
-        _liststart = index;
-        _listend = index;
-        _mrulist[index] = END_OF_LIST;
-        _mrubacklink[index] = START_OF_LIST;
-    } 
-    else if (_listend != index)
     {
-        // this is the oldest element being bumped to newest, so update start link
-        if (index == _liststart)
+        if ((_spriteData[index].Flags & SPRCACHEFLAG_LOADING) != 0)
+            WaitForSprite(index);
+        if (_spriteData[index].Image == nullptr)
         {
-            _liststart = _mrulist[index];
-            _mrubacklink[_liststart] = START_OF_LIST;
+            _stats.Misses++;
+            LoadSprite(index);
         }
-        // already in list, link previous to next
-        else if (_mrulist[index] > 0)
+        else
         {
-            _mrulist[_mrubacklink[index]] = _mrulist[index];
-            _mrubacklink[_mrulist[index]] = _mrubacklink[index];
+            _stats.Hits++;
         }
-
-        // set this as the newest element in the list
-        _mrulist[index] = END_OF_LIST;
-        _mrulist[_listend] = index;
-        _mrubacklink[index] = _listend;
-        _listend = index;
     }
+    else
+    {
+        _stats.Hits++;
+    }
+
+    // Locked sprite that shouldn't be put into MRU list
+    if (_spriteData[index].IsLocked())
+        return _spriteData[index].Image;
 
+    UpdateMRU(index);
     return _spriteData[index].Image;
 }
 
-void SpriteCache::DisposeOldest()
+void SpriteCache::MRUUnlink(sprkey_t index)
 {
-    if (_liststart < 0)
+    MRULink &link = _mruLinks[index];
+    if (link.Segment == kMRU_None)
         return;
+    MRUList &list = _mru[link.Segment];
+    if (link.Prev >= 0)
+        _mruLinks[link.Prev].Next = link.Next;
+    else
+        list.Oldest = link.Next;
+    if (link.Next >= 0)
+        _mruLinks[link.Next].Prev = link.Prev;
+    else
+        list.Newest = link.Prev;
+    list.Size -= link.Size;
+    link = MRULink();
+}
+
+void SpriteCache::MRULinkNewest(sprkey_t index, MRUSegment seg)
+{
+    MRULink &link = _mruLinks[index];
+    MRUList &list = _mru[seg];
+    link.Segment = seg;
+    link.Size = _spriteData[index].Size;
+    link.Prev = list.Newest;
+    link.Next = -1;
+    link.Used = true;
+    if (list.Newest >= 0)
+        _mruLinks[list.Newest].Next = index;
+    else
+        list.Oldest = index;
+    list.Newest = index;
+    list.Size += link.Size;
+}
+
+void SpriteCache::MRUReset()
+{
+    for (size_t i = 0; i < _mruLinks.size(); ++i)
+        _mruLinks[i] = MRULink();
+    for (int i = 0; i < kNumMRUSegments; ++i)
+        _mru[i] = MRUList();
+}
 
-    sprkey_t sprnum = _liststart;
+void SpriteCache::AddToMRU(sprkey_t index)
+{
+    if (_mruLinks[index].Segment != kMRU_None)
+        return;
+    MRULinkNewest(index, kMRU_Probation);
+    _mruLinks[index].Used = false;
+}
 
+void SpriteCache::UpdateMRU(sprkey_t index)
+{
+    const MRUSegment seg = _mruLinks[index].Segment;
+    const bool was_used = _mruLinks[index].Used;
+    if (seg != kMRU_None && was_used && _mru[seg].Newest == index &&
+        (seg == kMRU_Protected || _policy == kSprCache_LRU))
+        return; // already the newest in its segment
+    MRUUnlink(index);
+
+    // First time used sprites, and sprites too large to be protected, are put
+    // into probation; other sprites are protected after being used repeatedly.
+    const bool protect = _policy == kSprCache_SegmentedLRU && seg != kMRU_None && was_used &&
+        (size_t)_spriteData[index].Size <= _maxCacheSize / 100 * MRU_LARGE_SPRITE_PERCENT;
+    if (!protect)
+    {
+        MRULinkNewest(index, kMRU_Probation);
+        return;
+    }
+
+    MRULinkNewest(index, kMRU_Protected);
+    // Demote oldest protected sprites back to probation if the segment is full
+    const size_t protected_limit = _maxCacheSize / 100 * MRU_PROTECTED_PERCENT;
+    while (_mru[kMRU_Protected].Size > protected_limit && _mru[kMRU_Protected].Oldest != index)
+    {
+        sprkey_t demote = _mru[kMRU_Protected].Oldest;
+        MRUUnlink(demote);
+        MRULinkNewest(demote, kMRU_Probation);
+    }
+}
+
+bool SpriteCache::DisposeOldest()
+{
+    sprkey_t sprnum = _mru[kMRU_Probation].Oldest;
+    if (sprnum < 0)
+        sprnum = _mru[kMRU_Protected].Oldest;
+    if (sprnum < 0)
+        return false;
+
+    MRUUnlink(sprnum);
     if ((_spriteData[sprnum].Image != nullptr) && !_spriteData[sprnum].IsLocked())
     {
         // Free the memory
@@ -329,50 +514,22 @@ void SpriteCache::DisposeOldest()
             quitprintf("SpriteCache::DisposeOldest: attempted to remove sprite %d that was added externally or does not exist", sprnum);
         }
         _cacheSize -= _spriteData[sprnum].Size;
+        _stats.Evictions++;
+        _stats.EvictedBytes += _spriteData[sprnum].Size;
 
         delete _spriteData[sprnum].Image;
         _spriteData[sprnum].Image = nullptr;
     }
 
-    if (_liststart == _listend)
-    {
-        // there was one huge sprite, removing it has now emptied the cache completely
-        if (_cacheSize > 0)
-        {
-            Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Error, "SPRITE CACHE ERROR: Sprite cache should be empty, but still has %d bytes", _cacheSize);
-        }
-        _mrulist[_liststart] = 0;
-        _liststart = -1;
-        _listend = -1;
-    }
-    else
-    {
-        sprkey_t oldstart = _liststart;
-        _liststart = _mrulist[_liststart];
-        _mrulist[oldstart] = 0;
-        _mrubacklink[_liststart] = START_OF_LIST;
-        if (oldstart == _liststart)
-        {
-            // Somehow, we have got a recursive link to itself, so we
-            // the game will freeze (since it is not actually freeing any
-            // memory)
-            // There must be a bug somewhere causing this, but for now
-            // let's just reset the cache
-            Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Error, "RUNTIME CACHE ERROR: CACHE INCONSISTENT: RESETTING\n\tAt size %d (of %d), start %d end %d  fwdlink=%d",
-                        _cacheSize, _maxCacheSize, oldstart, _listend, _liststart);
-            DisposeAll();
-        }
-    }
-
 #ifdef DEBUG_SPRITECACHE
     Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Debug, "DisposeOldest: disposed %d, size now %d KB", sprnum, _cacheSize / 1024);
 #endif
+    return true;
 }
 
 void SpriteCache::DisposeAll()
 {
-    _liststart = -1;
-    _listend = -1;
+    MRUReset();
     for (size_t i = 0; i < _spriteData.size(); ++i)
     {
         if (!_spriteData[i].IsLocked() && // not locked
@@ -381,8 +538,6 @@ void SpriteCache::DisposeAll()
             delete _spriteData[i].Image;
             _spriteData[i].Image = nullptr;
         }
-        _mrulist[i] = 0;
-        _mrubacklink[i] = 0;
     }
     _cacheSize = _lockedSize;
 }
@@ -394,11 +549,16 @@ void SpriteCache::Precache(sprkey_t index)
 
     soff_t sprSize = 0;
 
+    if ((_spriteData[index].Flags & SPRCACHEFLAG_LOADING) != 0)
+        WaitForSprite(index);
+
     if (_spriteData[index].Image == nullptr)
         sprSize = LoadSprite(index);
     else if (!_spriteData[index].IsLocked())
         sprSize = _spriteData[index].Size;
 
+    // locked sprites are not disposed, so not tracked by MRU
+    MRUUnlink(index);
     // make sure locked sprites can't fill the cache
     _maxCacheSize += sprSize;
     _lockedSize += sprSize;
@@ -422,76 +582,179 @@ void SpriteCache::SeekToSprite(sprkey_t index)
         _stream->Seek(_spriteData[index].Offset, kSeekBegin);
 }
 
-size_t SpriteCache::LoadSprite(sprkey_t index)
+void SpriteCache::FreeUpSpace()
 {
-    int hh = 0;
-
     while (_cacheSize > _maxCacheSize)
     {
-        DisposeOldest();
-        hh++;
-        if (hh > 1000)
+        if (!DisposeOldest())
+            break; // the rest are locked or otherwise not disposable
+    }
+}
+
+Bitmap *SpriteCache::ReadSprite(Stream *in, SpriteCompression compress, int &coldep)
+{
+    coldep = in->ReadInt16();
+    if (coldep == 0)
+        return nullptr;
+
+    int wdd = in->ReadInt16();
+    int htt = in->ReadInt16();
+    Bitmap *image = BitmapHelper::CreateBitmap(wdd, htt, coldep * 8);
+    if (image == nullptr)
+        return nullptr;
+
+    if (compress != kSprCompress_None)
+    {
+        if (!UnCompressSprite(image, compress, in))
+        {
+            delete image;
+            return nullptr;
+        }
+    }
+    else
+    {
+        if (coldep == 1)
         {
-            Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Error, "RUNTIME CACHE ERROR: STUCK IN FREE_UP_MEM; RESETTING CACHE");
-            DisposeAll();
+            for (int hh = 0; hh < htt; hh++)
+                in->ReadArray(&image->GetScanLineForWriting(hh)[0], coldep, wdd);
+        }
+        else if (coldep == 2)
+        {
+            for (int hh = 0; hh < htt; hh++)
+                in->ReadArrayOfInt16((int16_t*)&image->GetScanLineForWriting(hh)[0], wdd);
+        }
+        else
+        {
+            for (int hh = 0; hh < htt; hh++)
+                in->ReadArrayOfInt32((int32_t*)&image->GetScanLineForWriting(hh)[0], wdd);
         }
     }
+    return image;
+}
+
+size_t SpriteCache::LoadSprite(sprkey_t index)
+{
+    FreeUpSpace();
 
     if (index < 0 || (size_t)index >= _spriteData.size())
         quit("sprite cache array index out of bounds");
 
     sprkey_t load_index = GetDataIndex(index);
-    SeekToSprite(load_index);
 
-    int coldep = _stream->ReadInt16();
+    int coldep;
+    Bitmap *image;
+    bool from_stream = false;
+    if (!_mapping || !ReadSpriteMapped(*_mapping, _compress, _spriteData[load_index].Offset, image, coldep))
+    {
+        SeekToSprite(load_index);
+        image = ReadSprite(_stream.get(), _compress, coldep);
+        from_stream = true;
+    }
 
     if (coldep == 0)
     {
         Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Error, "LoadSprite: asked to load sprite %d (for slot %d) which does not exist.", load_index, index);
-        _lastLoad = load_index;
+        if (from_stream)
+            _lastLoad = load_index;
         return 0;
     }
 
-    int wdd = _stream->ReadInt16();
-    int htt = _stream->ReadInt16();
-    // update the stored width/height
-    _sprInfos[index].Width = wdd;
-    _sprInfos[index].Height = htt;
-
-    _spriteData[index].Image = BitmapHelper::CreateBitmap(wdd, htt, coldep * 8);
-    if (_spriteData[index].Image == nullptr)
+    if (image == nullptr)
     {
         Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Warn, "LoadSprite: failed to init sprite %d, remapping to sprite 0.", index);
         RemapSpriteToSprite0(index);
         return 0;
     }
 
-    Bitmap *image = _spriteData[index].Image;
-    if (this->_compressed) 
+    if (from_stream)
+        _lastLoad = load_index;
+    return InitLoadedSprite(index, image, coldep);
+}
+
+bool SpriteCache::ReadSpriteMapped(const MemoryMappedFile &map, SpriteCompression compress,
+    soff_t offset, Bitmap *&image, int &coldep)
+{
+    if (compress == kSprCompress_RLE)
+        return false; // RLE is only read from the stream
+    // sprite header: color depth, width and height
+    const uint8_t *data = map.GetAt(offset, sizeof(int16_t) * 3);
+    if (!data)
+        return false;
+    image = nullptr;
+    coldep = Memory::ReadInt16LE(data);
+    if (coldep == 0)
+        return true;
+    const int wdd = Memory::ReadInt16LE(data + sizeof(int16_t));
+    const int htt = Memory::ReadInt16LE(data + sizeof(int16_t) * 2);
+    if (coldep < 0 || wdd < 0 || htt < 0)
+        return false;
+    soff_t data_offset = offset + sizeof(int16_t) * 3;
+    const size_t pitch = (size_t)wdd * coldep;
+    size_t data_len = pitch * htt;
+    if (compress == kSprCompress_LZ4)
     {
-        _stream->ReadInt32(); // skip data size
-        UnCompressSprite(image, _stream.get());
+        const uint8_t *len_data = map.GetAt(data_offset, sizeof(int32_t));
+        if (!len_data)
+            return false;
+        data_len = (uint32_t)Memory::ReadInt32LE(len_data);
+        data_offset += sizeof(int32_t);
     }
-    else
+    const uint8_t *pixels = map.GetAt(data_offset, data_len);
+    if (!pixels)
+        return false;
+
+    image = BitmapHelper::CreateBitmap(wdd, htt, coldep * 8);
+    if (image == nullptr)
+        return true;
+    if (compress == kSprCompress_LZ4)
     {
-        if (coldep == 1)
+        if (!UnCompressSpriteLZ4(image, pixels, data_len))
         {
-            for (hh = 0; hh < htt; hh++)
-                _stream->ReadArray(&image->GetScanLineForWriting(hh)[0], coldep, wdd);
-        }
-        else if (coldep == 2)
-        {
-            for (hh = 0; hh < htt; hh++)
-                _stream->ReadArrayOfInt16((int16_t*)&image->GetScanLineForWriting(hh)[0], wdd);
-        }
-        else
-        {
-            for (hh = 0; hh < htt; hh++)
-                _stream->ReadArrayOfInt32((int32_t*)&image->GetScanLineForWriting(hh)[0], wdd);
+            delete image;
+            image = nullptr;
         }
+        return true;
     }
+    // rows are stored without padding, and in native byte order on little-endian systems
+    for (int hh = 0; hh < htt; ++hh, pixels += pitch)
+        memcpy(image->GetScanLineForWriting(hh), pixels, pitch);
+    return true;
+}
 
-    _lastLoad = load_index;
+void SpriteCache::MapFile(const char *filename)
+{
+    _mapping.reset();
+#if AGS_PLATFORM_ENDIAN_LITTLE
+    // RLE sprites are unpacked byte by byte from the stream, no use in mapping them
+    if (_compress == kSprCompress_RLE)
+        return;
+    AssetLocation loc;
+    if (!AssetManager::GetAssetLocation(filename, loc))
+        return;
+#if !AGS_PLATFORM_64BIT
+    if (loc.Size > MAX_MAPPED_FILE_SIZE_32BIT)
+    {
+        Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Init, "SpriteCache: '%s' is too large to be mapped into memory, will use file stream", filename);
+        return;
+    }
+#endif
+    _mapping.reset(new MemoryMappedFile());
+    if (!_mapping->Open(loc.FileName, loc.Offset, loc.Size))
+    {
+        Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Warn, "SpriteCache: failed to map '%s' into memory, will use file stream", filename);
+        _mapping.reset();
+        return;
+    }
+    Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Init, "SpriteCache: mapped '%s' into memory", filename);
+#endif
+}
+
+size_t SpriteCache::InitLoadedSprite(sprkey_t index, Bitmap *image, int coldep)
+{
+    // update the stored width/height
+    _sprInfos[index].Width = image->GetWidth();
+    _sprInfos[index].Height = image->GetHeight();
+    _spriteData[index].Image = image;
 
     // Stop it adding the sprite to the used list just because it's loaded
     // TODO: this messy hack is required, because initialize_sprite calls operator[]
@@ -519,8 +782,126 @@ size_t SpriteCache::LoadSprite(sprkey_t index)
     return size;
 }
 
+void SpriteCache::Prefetch(sprkey_t index)
+{
+    if (index < 0 || (size_t)index >= _spriteData.size())
+        return;
+    SpriteData &spr = _spriteData[index];
+    if ((spr.Image != nullptr) || !spr.IsAssetSprite() ||
+        (spr.Flags & (SPRCACHEFLAG_REMAPPED | SPRCACHEFLAG_LOADING)) != 0)
+        return;
+    if (!_loader && !StartLoader())
+        return;
+    if (!_loader->Running)
+        return; // failed to start before
+
+    spr.Flags |= SPRCACHEFLAG_LOADING;
+    std::lock_guard<std::mutex> lk(_loader->Mutex);
+    SpriteLoader::Request req = { index, spr.Offset };
+    _loader->Queue.push_back(req);
+    _loader->CV.notify_one();
+}
+
+bool SpriteCache::StartLoader()
+{
+    _loader.reset(new SpriteLoader());
+    if (_filename.IsEmpty())
+        return false;
+    // The loader has its own stream, so that it never interferes with the
+    // synchronous loading
+    _loader->In.reset(Common::AssetManager::OpenAsset(_filename));
+    if (!_loader->In)
+    {
+        Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Error, "SpriteCache: failed to open '%s' for the background loader", _filename.GetCStr());
+        return false;
+    }
+    _loader->Compress = _compress;
+    _loader->Map = _mapping.get();
+    _loader->Running = true;
+    _loader->Thread = std::thread(&SpriteLoader::Run, _loader.get());
+    return true;
+}
+
+void SpriteCache::StopLoader()
+{
+    if (!_loader)
+        return;
+    if (_loader->Thread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lk(_loader->Mutex);
+            _loader->Running = false;
+            _loader->CV.notify_all();
+        }
+        _loader->Thread.join();
+    }
+    for (size_t i = 0; i < _loader->Results.size(); ++i)
+        delete _loader->Results[i].Image;
+    _loader.reset();
+    for (size_t i = 0; i < _spriteData.size(); ++i)
+        _spriteData[i].Flags &= ~SPRCACHEFLAG_LOADING;
+}
+
+void SpriteCache::CollectLoadedSprites()
+{
+    std::vector<SpriteLoader::Result> results;
+    {
+        std::lock_guard<std::mutex> lk(_loader->Mutex);
+        results.swap(_loader->Results);
+        _loader->HasResults = false;
+    }
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const sprkey_t index = results[i].Index;
+        Bitmap *image = results[i].Image;
+        // The sprite could have been loaded synchronously, or replaced, or
+        // removed since it was requested; in which case the result is dropped
+        const bool wanted = (size_t)index < _spriteData.size() &&
+            (_spriteData[index].Flags & SPRCACHEFLAG_LOADING) != 0 &&
+            _spriteData[index].Image == nullptr;
+        if (wanted)
+            _spriteData[index].Flags &= ~SPRCACHEFLAG_LOADING;
+        if (!wanted || !image)
+        {
+            // failed sprites will be reloaded synchronously and reported when used
+            delete image;
+            continue;
+        }
+
+        FreeUpSpace();
+        InitLoadedSprite(index, image, results[i].ColorDepth);
+        _stats.Prefetched++;
+        // put the prefetched sprite in the MRU list so that it could be disposed
+        // like any other sprite, if it does not get used after all
+        if (!_spriteData[index].IsLocked())
+            AddToMRU(index);
+    }
+}
+
+void SpriteCache::WaitForSprite(sprkey_t index)
+{
+    if (!_loader)
+        return;
+    {
+        std::unique_lock<std::mutex> lk(_loader->Mutex);
+        std::deque<SpriteLoader::Request>::iterator it = std::find_if(_loader->Queue.begin(), _loader->Queue.end(),
+            [index](const SpriteLoader::Request &req) { return req.Index == index; });
+        if (it != _loader->Queue.end())
+        {
+            // loader did not begin this sprite yet, faster to load it right now
+            _loader->Queue.erase(it);
+            _spriteData[index].Flags &= ~SPRCACHEFLAG_LOADING;
+            return;
+        }
+        _loader->CV.wait(lk, [this, index] { return _loader->Loading != index; });
+    }
+    CollectLoadedSprites();
+}
+
 void SpriteCache::RemapSpriteToSprite0(sprkey_t index)
 {
+    MRUUnlink(index);
     _sprInfos[index].Flags = _sprInfos[0].Flags;
     _sprInfos[index].Width = _sprInfos[0].Width;
     _sprInfos[index].Height = _sprInfos[0].Height;
@@ -535,9 +916,34 @@ void SpriteCache::RemapSpriteToSprite0(sprkey_t index)
 
 const char *spriteFileSig = " Sprite File ";
 
-void SpriteCache::CompressSprite(Bitmap *sprite, Stream *out)
+void SpriteCache::CompressSprite(Bitmap *sprite, SpriteCompression compress, Stream *out)
 {
     const int depth = sprite->GetBPP();
+    if (compress == kSprCompress_LZ4)
+    {
+        // pixel data is compressed as a whole, in little-endian byte order
+        const size_t data_len = sprite->GetLineLength() * sprite->GetHeight();
+        std::vector<uint8_t> data(data_len);
+        for (int y = 0; y < sprite->GetHeight(); y++)
+            memcpy(&data[y * sprite->GetLineLength()], sprite->GetScanLine(y), sprite->GetLineLength());
+#if AGS_PLATFORM_ENDIAN_BIG
+        if (depth == 2)
+        {
+            for (size_t i = 0; i < data_len; i += 2)
+                Memory::WriteInt16LE(&data[i], Memory::ReadInt16(&data[i]));
+        }
+        else if (depth == 4)
+        {
+            for (size_t i = 0; i < data_len; i += 4)
+                Memory::WriteInt32LE(&data[i], Memory::ReadInt32(&data[i]));
+        }
+#endif
+        std::vector<uint8_t> packed(lz4_compress_bound(data_len));
+        const size_t packed_len = lz4_compress_block(data.data(), data_len, packed.data(), packed.size());
+        out->Write(packed.data(), packed_len);
+        return;
+    }
+
     if (depth == 1)
     {
         for (int y = 0; y < sprite->GetHeight(); y++)
@@ -555,8 +961,16 @@ void SpriteCache::CompressSprite(Bitmap *sprite, Stream *out)
     }
 }
 
-void SpriteCache::UnCompressSprite(Bitmap *sprite, Stream *in)
+bool SpriteCache::UnCompressSprite(Bitmap *sprite, SpriteCompression compress, Stream *in)
 {
+    const size_t data_len = (uint32_t)in->ReadInt32();
+    if (compress == kSprCompress_LZ4)
+    {
+        std::vector<uint8_t> data(data_len);
+        in->Read(data.data(), data_len);
+        return UnCompressSpriteLZ4(sprite, data.data(), data_len);
+    }
+
     const int depth = sprite->GetBPP();
     if (depth == 1)
     {
@@ -573,15 +987,41 @@ void SpriteCache::UnCompressSprite(Bitmap *sprite, Stream *in)
         for (int y = 0; y < sprite->GetHeight(); y++)
             cunpackbitl32((unsigned int*)&sprite->GetScanLineForWriting(y)[0], sprite->GetWidth(), in);
     }
+    return true;
+}
+
+bool SpriteCache::UnCompressSpriteLZ4(Bitmap *sprite, const uint8_t *data, size_t data_len)
+{
+    // freshly created bitmap has no padding between the rows
+    uint8_t *pixels = sprite->GetDataForWriting();
+    const size_t pixels_len = sprite->GetLineLength() * sprite->GetHeight();
+    if (!lz4_decompress_block(data, data_len, pixels, pixels_len))
+    {
+        Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Error, "UnCompressSprite: corrupt sprite data");
+        return false;
+    }
+#if AGS_PLATFORM_ENDIAN_BIG
+    if (sprite->GetBPP() == 2)
+    {
+        for (size_t i = 0; i < pixels_len; i += 2)
+            Memory::WriteInt16(&pixels[i], Memory::ReadInt16LE(&pixels[i]));
+    }
+    else if (sprite->GetBPP() == 4)
+    {
+        for (size_t i = 0; i < pixels_len; i += 4)
+            Memory::WriteInt32(&pixels[i], Memory::ReadInt32LE(&pixels[i]));
+    }
+#endif
+    return true;
 }
 
-int SpriteCache::SaveToFile(const char *filename, bool compressOutput, SpriteFileIndex &index)
+int SpriteCache::SaveToFile(const char *filename, SpriteCompression compressOutput, SpriteFileIndex &index)
 {
     Stream *output = Common::File::CreateFile(filename);
     if (output == nullptr)
         return -1;
 
-    if (compressOutput)
+    if (compressOutput != kSprCompress_None)
     {
         // re-open the file so that it can be seeked
         delete output;
@@ -592,12 +1032,14 @@ int SpriteCache::SaveToFile(const char *filename, bool compressOutput, SpriteFil
 
     int spriteFileIDCheck = (int)time(nullptr);
 
-    // sprite file version
-    output->WriteInt16(kSprfVersion_Current);
+    // sprite file version; the LZ4 storage is the only feature which requires
+    // the latest format, other files are kept readable by the older engines
+    output->WriteInt16(compressOutput == kSprCompress_LZ4 ?
+        kSprfVersion_StorageFormats : kSprfVersion_HighSpriteLimit);
 
     output->WriteArray(spriteFileSig, strlen(spriteFileSig), 1);
 
-    output->WriteInt8(compressOutput ? 1 : 0);
+    output->WriteInt8(compressOutput);
     output->WriteInt32(spriteFileIDCheck);
 
     sprkey_t lastslot = FindTopmostSprite();
@@ -619,7 +1061,7 @@ int SpriteCache::SaveToFile(const char *filename, bool compressOutput, SpriteFil
         spriteoffs[i] = output->GetPosition();
 
         // if compressing uncompressed sprites, load the sprite into memory
-        if ((_spriteData[i].Image == nullptr) && (this->_compressed != compressOutput))
+        if ((_spriteData[i].Image == nullptr) && (this->_compress != compressOutput))
             (*this)[i];
 
         if (_spriteData[i].Image != nullptr)
@@ -634,13 +1076,13 @@ int SpriteCache::SaveToFile(const char *filename, bool compressOutput, SpriteFil
             output->WriteInt16(spritewidths[i]);
             output->WriteInt16(spriteheights[i]);
 
-            if (compressOutput)
+            if (compressOutput != kSprCompress_None)
             {
                 size_t lenloc = output->GetPosition();
                 // write some space for the length data
                 output->WriteInt32(0);
 
-                CompressSprite(image, output);
+                CompressSprite(image, compressOutput, output);
 
                 size_t fileSizeSoFar = output->GetPosition();
                 // write the length of the compressed data
@@ -676,7 +1118,7 @@ int SpriteCache::SaveToFile(const char *filename, bool compressOutput, SpriteFil
         if (colDepth == 0)
             continue;
 
-        if (this->_compressed != compressOutput)
+        if (this->_compress != compressOutput)
         {
             // shouldn't be able to get here
             delete [] memBuffer;
@@ -695,7 +1137,7 @@ int SpriteCache::SaveToFile(const char *filename, bool compressOutput, SpriteFil
         output->WriteInt16(height);
 
         int sizeToCopy;
-        if (this->_compressed)
+        if (this->_compress != kSprCompress_None)
         {
             sizeToCopy = _stream->ReadInt32();
             output->WriteInt32(sizeToCopy);
@@ -760,9 +1202,12 @@ HError SpriteCache::InitFile(const char *filename, const char *sprindex_filename
     soff_t spr_initial_offs = 0;
     int spriteFileID = 0;
 
+    StopLoader();
+    _mapping.reset();
     _stream.reset(Common::AssetManager::OpenAsset(filename));
     if (_stream == nullptr)
         return new Error(String::FromFormat("Failed to open spriteset file '%s'.", filename));
+    _filename = filename;
 
     spr_initial_offs = _stream->GetPosition();
 
@@ -786,15 +1231,22 @@ HError SpriteCache::InitFile(const char *filename, const char *sprindex_filename
 
     if (vers == kSprfVersion_Uncompressed)
     {
-        this->_compressed = false;
+        this->_compress = kSprCompress_None;
     }
     else if (vers == kSprfVersion_Compressed)
     {
-        this->_compressed = true;
+        this->_compress = kSprCompress_RLE;
     }
     else if (vers >= kSprfVersion_Last32bit)
     {
-        this->_compressed = (_stream->ReadInt8() == 1);
+        int compress = _stream->ReadInt8();
+        if (compress < kSprCompress_None || compress > kSprCompress_Last ||
+            (vers < kSprfVersion_StorageFormats && compress > kSprCompress_RLE))
+        {
+            _stream.reset();
+            return new Error(String::FromFormat("Unsupported spriteset compression type: %d.", compress));
+        }
+        this->_compress = (SpriteCompression)compress;
         spriteFileID = _stream->ReadInt32();
     }
 
@@ -813,6 +1265,7 @@ HError SpriteCache::InitFile(const char *filename, const char *sprindex_filename
         topmost = 200;
 
     EnlargeTo(topmost);
+    MapFile(filename);
 
     // if there is a sprite index file, use it
     if (LoadSpriteIndexFile(sprindex_filename, spriteFileID, spr_initial_offs, topmost))
@@ -867,7 +1320,7 @@ HError SpriteCache::RebuildSpriteIndex(AGS::Common::Stream *in, sprkey_t topmost
         }
         else if (vers >= kSprfVersion_Last32bit)
         {
-            spriteDataSize = this->_compressed ? in->ReadInt32() : wdd * coldep * htt;
+            spriteDataSize = this->_compress != kSprCompress_None ? in->ReadInt32() : wdd * coldep * htt;
         }
         else
         {
@@ -965,19 +1418,29 @@ bool SpriteCache::LoadSpriteIndexFile(const char *filename, int expectedFileID,
 
 void SpriteCache::DetachFile()
 {
+    StopLoader();
+    _mapping.reset();
     _stream.reset();
     _lastLoad = -2;
 }
 
 int SpriteCache::AttachFile(const char *filename)
 {
+    StopLoader();
     _stream.reset(Common::AssetManager::OpenAsset((char *)filename));
     if (_stream == nullptr)
         return -1;
+    _filename = filename;
+    MapFile(filename);
     return 0;
 }
 
 bool SpriteCache::IsFileCompressed() const
 {
-    return _compressed;
+    return _compress != kSprCompress_None;
+}
+
+SpriteCompression SpriteCache::GetFileCompression() const
+{
+    return _compress;
 }
@@ -40,7 +40,7 @@
 #include "core/platform.h"
 #include "util/error.h"
 
-namespace AGS { namespace Common { class Stream; class Bitmap; } }
+namespace AGS { namespace Common { class Stream; class Bitmap; class MemoryMappedFile; } }
 using namespace AGS; // FIXME later
 typedef AGS::Common::HError HAGSError;
 
@@ -52,6 +52,8 @@ struct SpriteInfo;
 #define SPRCACHEFLAG_REMAPPED       0x02
 // Locked sprites are ones that should not be freed when out of cache space.
 #define SPRCACHEFLAG_LOCKED         0x04
+// Tells that the sprite was requested from the background loader.
+#define SPRCACHEFLAG_LOADING        0x08
 
 // Max size of the sprite cache, in bytes
 #if AGS_PLATFORM_OS_ANDROID || AGS_PLATFORM_OS_IOS
@@ -68,7 +70,17 @@ enum SpriteFileVersion
     kSprfVersion_Last32bit = 6,
     kSprfVersion_64bit = 10,
     kSprfVersion_HighSpriteLimit = 11,
-    kSprfVersion_Current = kSprfVersion_HighSpriteLimit
+    kSprfVersion_StorageFormats = 12, // compression type may be other than RLE
+    kSprfVersion_Current = kSprfVersion_StorageFormats
+};
+
+// Sprite data compression type
+enum SpriteCompression
+{
+    kSprCompress_None = 0,
+    kSprCompress_RLE,   // legacy per-line run-length encoding
+    kSprCompress_LZ4,   // LZ4 block of the whole pixel data
+    kSprCompress_Last = kSprCompress_LZ4
 };
 
 enum SpriteIndexFileVersion
@@ -83,6 +95,29 @@ enum SpriteIndexFileVersion
 
 typedef int32_t sprkey_t;
 
+// Policy of choosing which sprites to dispose when the cache is full
+enum SpriteCachePolicy
+{
+    // Least recently used sprites are disposed first
+    kSprCache_LRU,
+    // Segmented LRU: sprites used only once since they were loaded are kept
+    // in the "probationary" segment and disposed before the ones that were
+    // used repeatedly (these are moved to the "protected" segment).
+    // Sprites too large relative to the cache are never protected.
+    kSprCache_SegmentedLRU,
+    kNumSprCachePolicies
+};
+
+// Sprite cache usage counters
+struct SpriteCacheStats
+{
+    uint64_t Hits = 0;         // requested sprite was in memory
+    uint64_t Misses = 0;       // requested sprite had to be loaded at once
+    uint64_t Prefetched = 0;   // sprites loaded in background
+    uint64_t Evictions = 0;    // sprites disposed to free up space
+    uint64_t EvictedBytes = 0; // total size of the disposed sprites
+};
+
 // SpriteFileIndex contains sprite file's table of contents
 struct SpriteFileIndex
 {
@@ -129,6 +164,11 @@ public:
     sprkey_t    FindTopmostSprite() const;
     // Loads sprite and and locks in memory (so it cannot get removed implicitly)
     void        Precache(sprkey_t index);
+    // Requests the sprite to be loaded by the background thread, so that it
+    // is ready by the time it is needed; does nothing if it's already loaded.
+    // If the sprite is asked for before the loading completes, the cache
+    // waits for it, or loads it at once if the loader did not start on it yet.
+    void        Prefetch(sprkey_t index);
     // Remap the given index to the sprite 0
     void        RemapSpriteToSprite0(sprkey_t index);
     // Unregisters sprite from the bank and optionally deletes bitmap
@@ -147,18 +187,26 @@ public:
     void        SubstituteBitmap(sprkey_t index, Common::Bitmap *);
     // Sets max cache size in bytes
     void        SetMaxCacheSize(size_t size);
+    // Sets the eviction policy; may be done at any time
+    void        SetCachePolicy(SpriteCachePolicy policy);
+    // Gets cache usage counters
+    const SpriteCacheStats &GetStats() const;
+    // Resets cache usage counters
+    void        ResetStats();
 
     // Loads sprite reference information and inits sprite stream
     HAGSError   InitFile(const char *filename, const char *sprindex_filename);
     // Tells if bitmaps in the file are compressed
     bool        IsFileCompressed() const;
+    // Gets the compression type of the bitmaps in the file
+    SpriteCompression GetFileCompression() const;
     // Opens file stream
     int         AttachFile(const char *filename);
     // Closes file stream
     void        DetachFile();
     // Saves all sprites to file; fills in index data for external use
     // TODO: refactor to be able to save main file and index file separately (separate function for gather data?)
-    int         SaveToFile(const char *filename, bool compressOutput, SpriteFileIndex &index);
+    int         SaveToFile(const char *filename, SpriteCompression compressOutput, SpriteFileIndex &index);
     // Saves sprite index table in a separate file
     int         SaveSpriteIndex(const char *filename, const SpriteFileIndex &index);
 
@@ -174,8 +222,18 @@ private:
     size_t      LoadSprite(sprkey_t index);
     // Seek stream to sprite
     void        SeekToSprite(sprkey_t index);
-    // Delete the oldest image in cache
-    void        DisposeOldest();
+    // Delete the image chosen by eviction policy; returns false if
+    // there was nothing to dispose
+    bool        DisposeOldest();
+    // Delete the oldest images until the cache fits into the size limit
+    void        FreeUpSpace();
+    // Registers use of the sprite for the eviction policy
+    void        UpdateMRU(sprkey_t index);
+    // Adds the sprite to the probationary segment, unless it's already listed
+    void        AddToMRU(sprkey_t index);
+    // Assigns freshly loaded bitmap to the sprite slot and lets engine
+    // prepare it for use; returns the new cached size of the sprite
+    size_t      InitLoadedSprite(sprkey_t index, Common::Bitmap *image, int coldep);
 
     // Information required for the sprite streaming
     // TODO: split into sprite cache and sprite stream data
@@ -205,31 +263,93 @@ private:
     std::vector<SpriteInfo> &_sprInfos;
     // Array of sprite references
     std::vector<SpriteData> _spriteData;
-    bool _compressed;        // are sprites compressed
+    SpriteCompression _compress; // sprites compression type
 
     std::unique_ptr<Common::Stream> _stream; // the sprite stream
+    // Memory-mapped sprite file, used to read uncompressed sprites
+    std::unique_ptr<Common::MemoryMappedFile> _mapping;
     sprkey_t _lastLoad; // last loaded sprite index
 
+    // Name of the sprite file asset, for the background loader's own stream
+    Common::String _filename;
+    // Background loader; created by the first prefetch request
+    struct SpriteLoader;
+    std::unique_ptr<SpriteLoader> _loader;
+
     size_t _maxCacheSize;  // cache size limit
     size_t _lockedSize;    // size in bytes of currently locked images
     size_t _cacheSize;     // size in bytes of currently cached images
 
-    // MRU list: the way to track which sprites were used recently.
+    // MRU lists: the way to track which sprites were used recently.
     // When clearing up space for new sprites, cache first deletes the sprites
-    // that were last time used long ago.
-    std::vector<sprkey_t> _mrulist;
-    std::vector<sprkey_t> _mrubacklink;
-    int _liststart;
-    int _listend;
+    // from the probationary segment, that were last time used long ago;
+    // then from the protected segment. Plain LRU policy only uses the
+    // probationary segment.
+    enum MRUSegment
+    {
+        kMRU_None,
+        kMRU_Probation,
+        kMRU_Protected,
+        kNumMRUSegments
+    };
+    struct MRULink
+    {
+        sprkey_t Prev = -1;  // older sprite
+        sprkey_t Next = -1;  // newer sprite
+        size_t   Size = 0;   // size counted in the segment
+        MRUSegment Segment = kMRU_None;
+        bool     Used = false; // was requested since added to the list
+    };
+    struct MRUList
+    {
+        sprkey_t Oldest = -1;
+        sprkey_t Newest = -1;
+        size_t   Size = 0;   // total size of the listed sprites
+    };
+    SpriteCachePolicy _policy;
+    std::vector<MRULink> _mruLinks;
+    MRUList _mru[kNumMRUSegments];
+    SpriteCacheStats _stats;
+
+    // Unlinks sprite from its MRU list, if it is in one
+    void        MRUUnlink(sprkey_t index);
+    // Links sprite as the newest in the given MRU list
+    void        MRULinkNewest(sprkey_t index, MRUSegment seg);
+    // Clears all MRU lists
+    void        MRUReset();
 
     // Loads sprite index file
     bool        LoadSpriteIndexFile(const char *filename, int expectedFileID, soff_t spr_initial_offs, sprkey_t topmost);
     // Rebuilds sprite index from the main sprite file
     HAGSError   RebuildSpriteIndex(AGS::Common::Stream *in, sprkey_t topmost, SpriteFileVersion vers);
     // Writes compressed sprite to the stream
-    void        CompressSprite(Common::Bitmap *sprite, Common::Stream *out);
-    // Uncompresses sprite from stream into the given bitmap
-    void        UnCompressSprite(Common::Bitmap *sprite, Common::Stream *in);
+    static void CompressSprite(Common::Bitmap *sprite, SpriteCompression compress, Common::Stream *out);
+    // Uncompresses sprite from stream into the given bitmap;
+    // returns false if the sprite data is corrupt
+    static bool UnCompressSprite(Common::Bitmap *sprite, SpriteCompression compress, Common::Stream *in);
+    // Uncompresses LZ4 sprite data from memory into the given bitmap
+    static bool UnCompressSpriteLZ4(Common::Bitmap *sprite, const uint8_t *data, size_t data_len);
+    // Reads sprite from the current stream position; returns nullptr and zero
+    // color depth if the sprite does not exist, or nullptr and actual color depth
+    // if failed to create a bitmap or the data is corrupt. Does not touch any
+    // cache data, so that it may be run by the background loader.
+    static Common::Bitmap *ReadSprite(Common::Stream *in, SpriteCompression compress, int &coldep);
+    // Reads uncompressed or LZ4 sprite from the mapped file; returns false if the sprite
+    // data is not within the mapped region, otherwise same as ReadSprite
+    static bool ReadSpriteMapped(const Common::MemoryMappedFile &map, SpriteCompression compress,
+                                 soff_t offset, Common::Bitmap *&image, int &coldep);
+    // Maps the sprite file into memory, if it's supported for this file
+    void        MapFile(const char *filename);
+
+    // Starts the background loader thread
+    bool        StartLoader();
+    // Stops the background loader and drops all of its pending requests
+    void        StopLoader();
+    // Takes the sprites that background loader has finished and puts them in cache
+    void        CollectLoadedSprites();
+    // Makes sure the requested sprite is not being loaded in background;
+    // waits for the loader if it's already working on this sprite
+    void        WaitForSprite(sprkey_t index);
 
     // Initialize the empty sprite slot
     void        InitNullSpriteParams(sprkey_t index);
@@ -21,9 +21,12 @@
 #include "font/wfnfontrenderer.h"
 #include "gfx/bitmap.h"
 #include "gui/guidefines.h" // MAXLINE
+#include "util/string_types.h"
 #include "util/string_utils.h"
 
 #define STD_BUFFER_SIZE 3000
+// Number of cached text widths per font, must be a power of 2
+#define TEXT_WIDTH_CACHE_SIZE 256
 
 using namespace AGS::Common;
 
@@ -32,20 +35,38 @@ namespace AGS
 namespace Common
 {
 
+// Measured text width, cached by the text's hash
+struct TextWidthEntry
+{
+    String  Text;
+    int     Width = 0;
+};
+
 struct Font
 {
     IAGSFontRenderer   *Renderer;
     IAGSFontRenderer2  *Renderer2;
     FontInfo            Info;
+    // Cached metrics, only for the built-in renderers
+    std::vector<TextWidthEntry> WidthCache;
+    int                 Height; // font height, or -1 if not known yet
 
     Font();
+    void ResetCache();
 };
 
 Font::Font()
     : Renderer(nullptr)
     , Renderer2(nullptr)
+    , Height(-1)
 {}
 
+void Font::ResetCache()
+{
+    WidthCache.clear();
+    Height = -1;
+}
+
 } // Common
 } // AGS
 
@@ -100,6 +121,7 @@ IAGSFontRenderer* font_replace_renderer(size_t fontNumber, IAGSFontRenderer* ren
   IAGSFontRenderer* oldRender = fonts[fontNumber].Renderer;
   fonts[fontNumber].Renderer = renderer;
   fonts[fontNumber].Renderer2 = nullptr;
+  fonts[fontNumber].ResetCache();
   return oldRender;
 }
 
@@ -135,7 +157,22 @@ int wgettextwidth(const char *texx, size_t fontNumber)
 {
   if (fontNumber >= fonts.size() || !fonts[fontNumber].Renderer)
     return 0;
-  return fonts[fontNumber].Renderer->GetTextWidth(texx, fontNumber);
+  Font &fnt = fonts[fontNumber];
+  // Only cache the vector fonts: measuring bitmap font is as fast as looking
+  // the text up, and plugin renderers are not guaranteed to be consistent
+  if (!fnt.Renderer2 || fnt.Renderer2->IsBitmapFont())
+    return fnt.Renderer->GetTextWidth(texx, fontNumber);
+
+  if (fnt.WidthCache.empty())
+    fnt.WidthCache.resize(TEXT_WIDTH_CACHE_SIZE);
+  const size_t len = strlen(texx);
+  const uint32_t hash = FNV::Hash1a(texx, len);
+  TextWidthEntry &entry = fnt.WidthCache[hash & (TEXT_WIDTH_CACHE_SIZE - 1)];
+  if (entry.Text.GetLength() == len && strcmp(entry.Text.GetCStr(), texx) == 0)
+    return entry.Width;
+  entry.Text = texx;
+  entry.Width = fnt.Renderer->GetTextWidth(texx, fontNumber);
+  return entry.Width;
 }
 
 int wgettextheight(const char *text, size_t fontNumber)
@@ -168,7 +205,12 @@ int getfontheight(size_t fontNumber)
   // are allowed to return varied results depending on the text parameter.
   // We use special line of text to get more or less reliable font height.
   const char *height_test_string = "ZHwypgfjqhkilIK";
-  return fonts[fontNumber].Renderer->GetTextHeight(height_test_string, fontNumber);
+  Font &fnt = fonts[fontNumber];
+  if (!fnt.Renderer2)
+    return fnt.Renderer->GetTextHeight(height_test_string, fontNumber);
+  if (fnt.Height < 0)
+    fnt.Height = fnt.Renderer->GetTextHeight(height_test_string, fontNumber);
+  return fnt.Height;
 }
 
 int getfontlinespacing(size_t fontNumber)
@@ -225,6 +267,19 @@ void unescape_script_string(const char *cstr, std::vector<char> &out)
     out.insert(out.end(), cstr, off + 1);
 }
 
+// Tells if the beginning of the text, up to and including the given
+// character, fits into the width
+static bool text_fits_width(char *text, size_t last, int width, int fontNumber)
+{
+    // temporarily terminate the line here and test its width
+    const char next_char = text[last + 1];
+    text[last + 1] = 0;
+    const bool fits = wgettextwidth_compensate(text, fontNumber) <= width;
+    // restore the character that was there before
+    text[last + 1] = next_char;
+    return fits;
+}
+
 // Break up the text into lines
 size_t split_lines(const char *todis, SplitLines &lines, int wii, int fonnt, size_t max_lines) {
     // NOTE: following hack accomodates for the legacy math mistake in split_lines.
@@ -254,15 +309,23 @@ size_t split_lines(const char *todis, SplitLines &lines, int wii, int fonnt, siz
             break;
         }
 
-        // temporarily terminate the line here and test its width
-        nextCharWas = theline[i + 1];
-        theline[i + 1] = 0;
+        // Text width only grows with each added character, so if the line fits
+        // up to the end of the next word, then skip right past that word
+        if (i == 0 || theline[i] == ' ') {
+            size_t word_end = i;
+            while ((theline[word_end + 1] != 0) && (theline[word_end + 1] != ' ') && (theline[word_end + 1] != '\n'))
+                word_end++;
+            if ((theline[i] != '\n') && (word_end > i) && text_fits_width(theline, word_end, wii, fonnt)) {
+                i = word_end + 1;
+                continue;
+            }
+        }
 
         // force end of line with the \n character
         if (theline[i] == '\n')
             splitAt = i;
         // otherwise, see if we are too wide
-        else if (wgettextwidth_compensate(theline, fonnt) > wii) {
+        else if (!text_fits_width(theline, i, wii, fonnt)) {
             int endline = i;
             while ((theline[endline] != ' ') && (endline > 0))
                 endline--;
@@ -274,9 +337,6 @@ size_t split_lines(const char *todis, SplitLines &lines, int wii, int fonnt, siz
             splitAt = endline;
         }
 
-        // restore the character that was there before
-        theline[i + 1] = nextCharWas;
-
         if (splitAt != -1) {
             if (splitAt == 0 && !((theline[0] == ' ') || (theline[0] == '\n'))) {
               // cannot split with current width restriction
@@ -346,6 +406,7 @@ bool wloadfont_size(size_t fontNumber, const FontInfo &font_info)
   if (fonts[fontNumber].Renderer)
   {
       fonts[fontNumber].Info = font_info;
+      fonts[fontNumber].ResetCache();
       return true;
   }
   return false;
@@ -374,4 +435,5 @@ void wfreefont(size_t fontNumber)
     fonts[fontNumber].Renderer->FreeMemory(fontNumber);
 
   fonts[fontNumber].Renderer = nullptr;
+  fonts[fontNumber].ResetCache();
 }
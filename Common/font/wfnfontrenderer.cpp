@@ -27,7 +27,6 @@ static unsigned char GetCharCode(unsigned char wanted_code, const WFNFont* font)
     return wanted_code < font->GetCharCount() ? wanted_code : '?';
 }
 
-static int RenderChar(Bitmap *ds, const int at_x, const int at_y, const WFNChar &wfn_char, const int scale, const color_t text_color);
 
 void WFNFontRenderer::AdjustYCoordinateForFont(int *ycoord, int fontNumber)
 {
@@ -83,47 +82,55 @@ void WFNFontRenderer::RenderText(const char *text, int fontNumber, BITMAP *desti
   int oldeip = get_our_eip();
   set_our_eip(415);
 
-  const WFNFont* font = _fontData[fontNumber].Font;
-  const FontRenderParams &params = _fontData[fontNumber].Params;
+  const FontData &font_data = _fontData[fontNumber];
+  const WFNFont* font = font_data.Font;
+  const int scale = font_data.Params.SizeMultiplier;
   render_wrapper.WrapAllegroBitmap(destination, true);
 
   for (; *text; ++text)
-    x += RenderChar(&render_wrapper, x, y, font->GetChar(GetCharCode(*text, font)), params.SizeMultiplier, colour);
+  {
+    const unsigned char code = GetCharCode(*text, font);
+    const GlyphSpans &spans = font_data.Glyphs[code];
+    for (size_t i = 0; i < spans.size(); ++i)
+    {
+      const int span_x = x + spans[i].X * scale;
+      const int span_y = y + spans[i].Y * scale;
+      render_wrapper.FillRect(Rect(span_x, span_y, span_x + spans[i].Width * scale - 1, span_y + scale - 1), colour);
+    }
+    x += font->GetChar(code).Width * scale;
+  }
 
   set_our_eip(oldeip);
 }
 
-int RenderChar(Bitmap *ds, const int at_x, const int at_y, const WFNChar &wfn_char, const int scale, const color_t text_color)
+void WFNFontRenderer::BuildGlyphSpans(const WFNFont *font, std::vector<GlyphSpans> &glyphs)
 {
-  const int width = wfn_char.Width;
-  const int height = wfn_char.Height;
-  const unsigned char *actdata = wfn_char.Data;
-  const int bytewid = wfn_char.GetRowByteCount();
-
-  int x = at_x;
-  int y = at_y;
-  for (int h = 0; h < height; ++h)
+  // all the possible codes, characters missing in font are empty
+  glyphs.assign(256, GlyphSpans());
+  for (size_t code = 0; code < glyphs.size(); ++code)
   {
-    for (int w = 0; w < width; ++w)
+    const WFNChar &wfn_char = font->GetChar(code);
+    const unsigned char *actdata = wfn_char.Data;
+    const int bytewid = wfn_char.GetRowByteCount();
+    GlyphSpans &spans = glyphs[code];
+    for (int h = 0; h < wfn_char.Height; ++h)
     {
-      if (((actdata[h * bytewid + (w / 8)] & (0x80 >> (w % 8))) != 0)) {
-        if (scale > 1)
+      for (int w = 0; w < wfn_char.Width;)
+      {
+        if ((actdata[h * bytewid + (w / 8)] & (0x80 >> (w % 8))) == 0)
         {
-          ds->FillRect(Rect(x + w, y + h, x + w + (scale - 1),
-              y + h + (scale - 1)), text_color);
-        } 
-        else
-        {
-          ds->PutPixel(x + w, y + h, text_color);
+          ++w;
+          continue;
         }
+        GlyphSpan span;
+        span.X = w;
+        span.Y = h;
+        for (; w < wfn_char.Width && (actdata[h * bytewid + (w / 8)] & (0x80 >> (w % 8))) != 0; ++w);
+        span.Width = w - span.X;
+        spans.push_back(span);
       }
-
-      x += scale - 1;
     }
-    y += scale - 1;
-    x = at_x;
   }
-  return width * scale;
 }
 
 bool WFNFontRenderer::LoadFromDisk(int fontNumber, int fontSize)
@@ -164,6 +171,7 @@ bool WFNFontRenderer::LoadFromDiskEx(int fontNumber, int fontSize, const FontRen
   }
   _fontData[fontNumber].Font = font;
   _fontData[fontNumber].Params = params ? *params : FontRenderParams();
+  BuildGlyphSpans(font, _fontData[fontNumber].Glyphs);
   return true;
 }
 
@@ -16,6 +16,8 @@
 #define __AC_WFNFONTRENDERER_H
 
 #include <map>
+#include <vector>
+#include "core/types.h"
 #include "font/agsfontrenderer.h"
 
 class WFNFont;
@@ -35,11 +37,24 @@ public:
   bool LoadFromDiskEx(int fontNumber, int fontSize, const FontRenderParams *params) override;
 
 private:
+  // Horizontal run of the glyph's pixels, in unscaled glyph coordinates
+  struct GlyphSpan
+  {
+    int16_t X;
+    int16_t Y;
+    int16_t Width;
+  };
+  typedef std::vector<GlyphSpan> GlyphSpans;
+
   struct FontData
   {
     WFNFont         *Font;
     FontRenderParams Params;
+    // Glyphs prepared for drawing, indexed by the character code
+    std::vector<GlyphSpans> Glyphs;
   };
+
+  static void BuildGlyphSpans(const WFNFont *font, std::vector<GlyphSpans> &glyphs);
   std::map<int, FontData> _fontData;
 };
 
@@ -13,6 +13,7 @@
 //=============================================================================
 
 #include "ac/spritecache.h"
+#include "font/fonts.h"
 #include "gui/guibutton.h"
 #include "gui/guimain.h" // TODO: extract helper functions
 #include "util/stream.h"
@@ -87,6 +88,37 @@ bool GUIButton::IsClippingImage() const
     return (Flags & kGUICtrl_Clip) != 0;
 }
 
+Rect GUIButton::CalcGraphicRect()
+{
+    // the default button's border is drawn around the frame
+    Rect rc = RectWH(X - 1, Y - 1, Width + 2, Height + 2);
+    if (CurrentImage > 0 && Image > 0)
+    {
+        if (!IsClippingImage() && spriteset[CurrentImage] != nullptr)
+            rc = UnionRects(rc, RectWH(X, Y, get_adjusted_spritewidth(CurrentImage),
+                get_adjusted_spriteheight(CurrentImage)));
+        if (_placeholder != kButtonPlace_None && gui_inv_pic >= 0)
+        {
+            const int inv_w = get_adjusted_spritewidth(gui_inv_pic);
+            const int inv_h = get_adjusted_spriteheight(gui_inv_pic);
+            rc = UnionRects(rc, RectWH(X + Width / 2 - inv_w / 2, Y + Height / 2 - inv_h / 2, inv_w, inv_h));
+        }
+    }
+    if (_text.IsEmpty())
+        return rc;
+    // text is aligned inside the frame, but is never clipped by it
+    PrepareTextToDraw();
+    int text_height = wgettextheight(_textToDraw.GetCStr(), Font);
+    if (TextAlignment & kMAlignVCenter)
+        text_height++;
+    const Rect text_rc = AlignInRect(RectWH(X + 2, Y + 2, Width - 4, Height - 4),
+        RectWH(0, 0, wgettextwidth(_textToDraw.GetCStr(), Font), text_height), TextAlignment);
+    // leave a margin for the pushed text offset, the text outline and glyph overhangs
+    const int margin = get_fixed_pixel_size(2);
+    return UnionRects(rc, Rect(text_rc.Left - margin, text_rc.Top - margin,
+        text_rc.Right + 1 + margin, text_rc.Bottom + 1 + margin));
+}
+
 void GUIButton::Draw(Bitmap *ds)
 {
     bool draw_disabled = !IsGUIEnabled(this);
@@ -279,9 +311,12 @@ void GUIButton::WriteToSavegame(Stream *out) const
 
 void GUIButton::DrawImageButton(Bitmap *ds, bool draw_disabled)
 {
-    // NOTE: the CLIP flag only clips the image, not the text
+    // NOTE: the CLIP flag only clips the image, not the text;
+    // the clip is combined with the one set by the caller
+    const Rect old_clip = ds->GetClip();
+    const Rect frame = RectWH(X, Y, Width, Height);
     if (IsClippingImage())
-        ds->SetClip(Rect(X, Y, X + Width - 1, Y + Height - 1));
+        ds->SetClip(AreRectsIntersecting(old_clip, frame) ? ClampToRect(old_clip, frame) : Rect());
     if (spriteset[CurrentImage] != nullptr)
         draw_gui_sprite(ds, CurrentImage, X, Y, true);
 
@@ -322,7 +357,7 @@ void GUIButton::DrawImageButton(Bitmap *ds, bool draw_disabled)
             spriteset[CurrentImage]->GetWidth(),
             spriteset[CurrentImage]->GetHeight()));
     }
-    ds->SetClip(Rect(0, 0, ds->GetWidth() - 1, ds->GetHeight() - 1));
+    ds->SetClip(old_clip);
 
     // Don't print Text of (INV) (INVSHR) (INVNS)
     if (_placeholder == kButtonPlace_None && !_unnamed)
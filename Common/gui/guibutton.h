@@ -60,6 +60,7 @@ public:
 
     const String &GetText() const;
     bool IsClippingImage() const;
+    Rect CalcGraphicRect() override;
 
     // Operations
     void Draw(Bitmap *ds) override;
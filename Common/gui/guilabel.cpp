@@ -12,6 +12,7 @@
 //
 //=============================================================================
 
+#include <algorithm>
 #include "ac/game_version.h"
 #include "font/fonts.h"
 #include "gui/guilabel.h"
@@ -43,6 +44,32 @@ String GUILabel::GetText() const
     return Text;
 }
 
+Rect GUILabel::CalcGraphicRect()
+{
+    const Rect frame = RectWH(X, Y, Width, Height);
+    PrepareTextToDraw();
+    if (SplitLinesForDrawing(Lines) == 0)
+        return frame;
+
+    // Text is aligned inside the frame, but long lines may stick out on
+    // either side; same vertical limits as in Draw
+    const int linespacing = getfontlinespacing(Font) + 1;
+    const bool limit_by_label_frame = loaded_game_file_version >= kGameVersion_272;
+    int max_width = 0;
+    int at_y = Y;
+    for (size_t i = 0;
+        i < Lines.Count() && (!limit_by_label_frame || at_y <= Y + Height);
+        ++i, at_y += linespacing)
+    {
+        max_width = std::max(max_width, wgettextwidth(Lines[i].GetCStr(), Font));
+    }
+    const int overflow = std::max(0, max_width - Width);
+    // leave a margin for the text outline and glyph overhangs
+    const int margin = get_fixed_pixel_size(2);
+    return Rect(frame.Left - overflow - margin, frame.Top - margin,
+        frame.Right + overflow + margin, std::max(frame.Bottom, at_y) + margin);
+}
+
 void GUILabel::Draw(Common::Bitmap *ds)
 {
     check_font(&Font);
@@ -32,6 +32,7 @@ public:
     GUILabel();
     
     String       GetText() const;
+    Rect         CalcGraphicRect() override;
 
     // Operations
     void Draw(Bitmap *ds) override;
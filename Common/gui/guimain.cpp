@@ -83,6 +83,8 @@ void GUIMain::InitDefaults()
     _controls.clear();
     _ctrlRefs.clear();
     _ctrlDrawOrder.clear();
+    _hasChanged = true;
+    _hasControlsChanged = false;
 }
 
 int GUIMain::FindControlUnderMouse(int leeway, bool must_be_clickable) const
@@ -222,6 +224,50 @@ void GUIMain::DrawAt(Bitmap *ds, int x, int y)
 
     Bitmap subbmp;
     subbmp.CreateSubBitmap(ds, RectWH(x, y, Width, Height));
+    for (size_t ctrl_index = 0; ctrl_index < _controls.size(); ++ctrl_index)
+        _controls[ctrl_index]->_drawnRect = Rect();
+    DrawImpl(&subbmp, Rect());
+}
+
+Rect GUIMain::DrawChangedControls(Bitmap *ds, int x, int y)
+{
+    if ((Width < 1) || (Height < 1))
+        return Rect();
+
+    // Find out the area covered by the changed controls, both before and after the change
+    const bool draw_controls = !(all_buttons_disabled && gui_disabled_style == GUIDIS_BLACKOUT);
+    Rect region;
+    for (size_t ctrl_index = 0; ctrl_index < _controls.size(); ++ctrl_index)
+    {
+        GUIObject *obj = _controls[ctrl_index];
+        if (!obj->HasChanged())
+            continue;
+        region = UnionRects(region, obj->_drawnRect);
+        if (draw_controls && obj->IsVisible() &&
+            (obj->IsEnabled() || gui_disabled_style != GUIDIS_BLACKOUT))
+            obj->_drawnRect = obj->CalcGraphicRect();
+        else
+            obj->_drawnRect = Rect();
+        region = UnionRects(region, obj->_drawnRect);
+    }
+    const Rect gui_rc = RectWH(0, 0, Width, Height);
+    if (region.IsEmpty() || !AreRectsIntersecting(gui_rc, region))
+        return Rect();
+    region = ClampToRect(gui_rc, region);
+
+    Bitmap subbmp;
+    subbmp.CreateSubBitmap(ds, RectWH(x, y, Width, Height));
+    // everything is clipped by the region, including the background
+    subbmp.SetClip(region);
+    subbmp.ClearTransparent();
+    DrawImpl(&subbmp, region);
+    return region;
+}
+
+void GUIMain::DrawImpl(Bitmap *ds, const Rect &region)
+{
+    Bitmap &subbmp = *ds;
+    const bool full_draw = region.IsEmpty();
 
     SET_EIP(376)
     // stop border being transparent, if the whole GUI isn't
@@ -262,6 +308,10 @@ void GUIMain::DrawAt(Bitmap *ds, int x, int y)
             continue;
         if (!objToDraw->IsVisible())
             continue;
+        if (full_draw)
+            objToDraw->_drawnRect = objToDraw->CalcGraphicRect();
+        else if (!AreRectsIntersecting(objToDraw->_drawnRect, region))
+            continue;
 
         objToDraw->Draw(&subbmp);
 
@@ -298,6 +348,14 @@ void GUIMain::DrawAt(Bitmap *ds, int x, int y)
     SET_EIP(380)
 }
 
+void GUIMain::ClearChanged()
+{
+    _hasChanged = false;
+    _hasControlsChanged = false;
+    for (size_t ctrl_index = 0; ctrl_index < _controls.size(); ++ctrl_index)
+        _controls[ctrl_index]->ClearChanged();
+}
+
 void GUIMain::DrawBlob(Bitmap *ds, int x, int y, color_t draw_color)
 {
     ds->FillRect(Rect(x, y, x + get_fixed_pixel_size(1), y + get_fixed_pixel_size(1)), draw_color);
@@ -318,7 +376,10 @@ void GUIMain::Poll()
         else if (ctrl_index != MouseOverCtrl)
         {
             if (MouseOverCtrl >= 0)
+            {
                 _controls[MouseOverCtrl]->OnMouseLeave();
+                _controls[MouseOverCtrl]->MarkChanged();
+            }
 
             if (ctrl_index >= 0 && !IsGUIEnabled(_controls[ctrl_index]))
                 // the control is disabled - ignore it
@@ -334,9 +395,9 @@ void GUIMain::Poll()
                 {
                     _controls[MouseOverCtrl]->OnMouseEnter();
                     _controls[MouseOverCtrl]->OnMouseMove(mousex, mousey);
+                    _controls[MouseOverCtrl]->MarkChanged();
                 }
             }
-            guis_need_update = 1;
         } 
         else if (MouseOverCtrl >= 0)
             _controls[MouseOverCtrl]->OnMouseMove(mousex, mousey);
@@ -496,7 +557,7 @@ void GUIMain::OnMouseButtonDown()
     if (_controls[MouseOverCtrl]->OnMouseDown())
         MouseOverCtrl = MOVER_MOUSEDOWNLOCKED;
     _controls[MouseDownCtrl]->OnMouseMove(mousex - X, mousey - Y);
-    guis_need_update = 1;
+    _controls[MouseDownCtrl]->MarkChanged();
 }
 
 void GUIMain::OnMouseButtonUp()
@@ -513,8 +574,8 @@ void GUIMain::OnMouseButtonUp()
         return;
 
     _controls[MouseDownCtrl]->OnMouseUp();
+    _controls[MouseDownCtrl]->MarkChanged();
     MouseDownCtrl = -1;
-    guis_need_update = 1;
 }
 
 void GUIMain::ReadFromFile(Stream *in, GuiVersion gui_version)
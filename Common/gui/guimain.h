@@ -86,6 +86,10 @@ public:
     // For example GUI with kGUIPopupMouseY style will not be shown unless
     // mouse cursor is at certain position on screen.
     bool        IsVisible() const;
+    // Tells if the whole GUI has to be redrawn
+    bool        HasChanged() const { return _hasChanged; }
+    // Tells if any of the GUI's controls have to be redrawn
+    bool        HasControlsChanged() const { return _hasControlsChanged; }
 
     int32_t FindControlUnderMouse() const;
     // this version allows some extra leeway in the Editor so that
@@ -110,6 +114,17 @@ public:
     bool    BringControlToFront(int index);
     void    Draw(Bitmap *ds);
     void    DrawAt(Bitmap *ds, int x, int y);
+    // Redraws only the changed controls, along with the parts of the GUI
+    // background and other controls which they overlap; expects the GUI
+    // to have been fully drawn on the same bitmap before. Returns the
+    // redrawn rectangle in GUI coordinates, which may be empty.
+    Rect    DrawChangedControls(Bitmap *ds, int x, int y);
+    // Marks the whole GUI for redraw
+    void    MarkChanged() { _hasChanged = true; }
+    // Notifies that some of the controls have to be redrawn
+    void    MarkControlsChanged() { _hasControlsChanged = true; }
+    // Resets the changed state of the GUI and all of its controls
+    void    ClearChanged();
     void    Poll();
     HError  RebuildArray();
     void    ResortZOrder();
@@ -143,6 +158,9 @@ public:
 
 private:
     void    DrawBlob(Bitmap *ds, int x, int y, color_t draw_color);
+    // Draws the GUI on the prepared subbitmap; if the region is not empty,
+    // only draws the controls which intersect it
+    void    DrawImpl(Bitmap *subbmp, const Rect &region);
 
     // TODO: all members are currently public; hide them later
 public:
@@ -182,6 +200,8 @@ private:
     std::vector<GUIObject*> _controls;
     // Sorted array of controls in z-order.
     std::vector<int32_t>    _ctrlDrawOrder;
+    bool    _hasChanged;         // whole GUI has to be redrawn
+    bool    _hasControlsChanged; // some of the controls have to be redrawn
 };
 
 
@@ -34,6 +34,21 @@ GUIObject::GUIObject()
     ZOrder      = -1;
     IsActivated    = false;
     _scEventCount = 0;
+    _hasChanged = true;
+}
+
+Rect GUIObject::CalcGraphicRect()
+{
+    // large enough for any GUI, but still safe to calculate the size of
+    const int half_range = INT32_MAX / 4;
+    return Rect(-half_range, -half_range, half_range, half_range);
+}
+
+void GUIObject::MarkChanged()
+{
+    _hasChanged = true;
+    if (ParentId >= 0 && (size_t)ParentId < guis.size())
+        guis[ParentId].MarkControlsChanged();
 }
 
 int GUIObject::GetEventCount() const
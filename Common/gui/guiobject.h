@@ -18,6 +18,7 @@
 #include "core/types.h"
 #include "gfx/bitmap.h"
 #include "gui/guidefines.h"
+#include "util/geometry.h"
 #include "util/string.h"
 
 #define GUIDIS_GREYOUT   1
@@ -58,9 +59,18 @@ public:
     bool            IsVisible() const;
     // implemented separately in engine and editor
     bool            IsClickable() const;
+    // Tells if the control has to be redrawn
+    bool            HasChanged() const { return _hasChanged; }
+    // Calculates the rectangle which control's graphic may cover, in the
+    // parent GUI's coordinates; includes any content drawn outside of the frame.
+    // By default the graphic is not bounded, and covers the whole parent GUI.
+    virtual Rect    CalcGraphicRect();
     
     // Operations
     virtual void    Draw(Bitmap *ds) { }
+    // Marks the control for redraw, and notifies the parent GUI
+    void            MarkChanged();
+    void            ClearChanged() { _hasChanged = false; }
     void            SetClickable(bool on);
     void            SetEnabled(bool on);
     void            SetTranslated(bool on);
@@ -110,6 +120,12 @@ protected:
     int32_t  _scEventCount;                    // number of supported script events
     String   _scEventNames[MAX_GUIOBJ_EVENTS]; // script event names
     String   _scEventArgs[MAX_GUIOBJ_EVENTS];  // script handler params
+
+private:
+    friend class GUIMain;
+
+    bool     _hasChanged;  // control has to be redrawn
+    Rect     _drawnRect;   // graphic rectangle at the time of the last draw
 };
 
 // Converts legacy alignment type used in GUI Label/ListBox data (only left/right/center)
@@ -49,6 +49,15 @@ bool GUITextBox::IsBorderShown() const
     return (TextBoxFlags & kTextBox_ShowBorder) != 0;
 }
 
+Rect GUITextBox::CalcGraphicRect()
+{
+    // long text is not clipped by the frame, and is followed by the cursor
+    const int margin = get_fixed_pixel_size(2);
+    const int text_w = 3 + wgettextwidth(Text.GetCStr(), Font) + get_fixed_pixel_size(5);
+    const int text_h = 2 + get_fixed_pixel_size(1) + getfontheight(Font);
+    return UnionRects(RectWH(X, Y, Width, Height), RectWH(X, Y, text_w + margin, text_h + margin));
+}
+
 void GUITextBox::Draw(Bitmap *ds)
 {
     check_font(&Font);
@@ -67,7 +76,7 @@ void GUITextBox::Draw(Bitmap *ds)
 
 void GUITextBox::OnKeyPress(int keycode)
 {
-    guis_need_update = 1;
+    MarkChanged();
 
     // backspace, remove character
     if (keycode == ASCII_BACKSPACE)
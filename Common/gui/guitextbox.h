@@ -30,6 +30,7 @@ public:
     GUITextBox();
 
     bool IsBorderShown() const;
+    Rect CalcGraphicRect() override;
 
     // Operations
     void Draw(Bitmap *ds) override;
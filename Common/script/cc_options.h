@@ -27,6 +27,8 @@
 #define SCOPT_NOIMPORTOVERRIDE 0x20 // do not allow an import to be re-declared
 #define SCOPT_LEFTTORIGHT 0x40   // left-to-right operator precedance
 #define SCOPT_OLDSTRINGS  0x80   // allow old-style strings
+#define SCOPT_NOSUPERINSTR   0x100 // do not fuse script operations into superinstructions when linking
+#define SCOPT_SWITCHDISPATCH 0x200 // run scripts with switch dispatch even if threaded one is available
 
 extern void ccSetOption(int, int);
 extern int ccGetOption(int);
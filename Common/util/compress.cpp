@@ -136,6 +136,177 @@ void cpackbitl32(const uint32_t *line, int size, Stream *out)
   } // end while
 }
 
+//=============================================================================
+//
+// LZ4 block format: a sequence of the tokens, each followed by a number of
+// literal bytes and a back reference to the already decoded data.
+// Token's high 4 bits is literal length, low 4 bits is match length - 4;
+// the value of 15 means that the length continues in the following bytes.
+// Back reference is a 2-byte little-endian offset. The last sequence has
+// only literals, and by the format's rules the last 5 bytes are always
+// literals and the last match starts at least 12 bytes before the end.
+//
+//=============================================================================
+
+#define LZ4_MINMATCH      4
+#define LZ4_LASTLITERALS  5
+#define LZ4_MFLIMIT       12
+#define LZ4_MAXOFFSET     65535
+#define LZ4_HASHLOG       14
+
+static inline uint32_t lz4_read32(const uint8_t *p)
+{
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline uint32_t lz4_hash(uint32_t v)
+{
+  return (v * 2654435761u) >> (32 - LZ4_HASHLOG);
+}
+
+static inline uint8_t *lz4_write_length(uint8_t *op, size_t len)
+{
+  for (; len >= 255; len -= 255)
+    *op++ = 255;
+  *op++ = (uint8_t)len;
+  return op;
+}
+
+size_t lz4_compress_bound(size_t src_len)
+{
+  return src_len + src_len / 255 + 16;
+}
+
+size_t lz4_compress_block(const uint8_t *src, size_t src_len, uint8_t *dst, size_t dst_cap)
+{
+  uint32_t table[1 << LZ4_HASHLOG] = { 0 }; // positions of the recent sequences
+  const uint8_t *ip = src;
+  const uint8_t *anchor = src; // start of the pending literals
+  const uint8_t *const iend = src + src_len;
+  uint8_t *op = dst;
+  uint8_t *const oend = dst + dst_cap;
+
+  if (src_len > LZ4_MFLIMIT) {
+    const uint8_t *const mflimit = iend - LZ4_MFLIMIT;
+    const uint8_t *const matchlimit = iend - LZ4_LASTLITERALS;
+    while (ip < mflimit) {
+      const uint32_t seq = lz4_read32(ip);
+      const uint32_t h = lz4_hash(seq);
+      const uint8_t *ref = src + table[h];
+      table[h] = (uint32_t)(ip - src);
+      if (ref >= ip || ip - ref > LZ4_MAXOFFSET || lz4_read32(ref) != seq) {
+        // skip faster over the incompressible data
+        ip += 1 + ((ip - anchor) >> 6);
+        continue;
+      }
+
+      // extend the match backwards and forwards
+      while (ip > anchor && ref > src && ip[-1] == ref[-1]) {
+        ip--;
+        ref--;
+      }
+      const uint8_t *mp = ip + LZ4_MINMATCH;
+      const uint8_t *rp = ref + LZ4_MINMATCH;
+      while (mp < matchlimit && *mp == *rp) {
+        mp++;
+        rp++;
+      }
+
+      const size_t lit_len = ip - anchor;
+      const size_t match_len = (mp - ip) - LZ4_MINMATCH;
+      if ((size_t)(oend - op) < 1 + lit_len / 255 + 1 + lit_len + 2 + match_len / 255 + 1)
+        return 0;
+      uint8_t *token = op++;
+      *token = (uint8_t)((lit_len < 15 ? lit_len : 15) << 4);
+      if (lit_len >= 15)
+        op = lz4_write_length(op, lit_len - 15);
+      memcpy(op, anchor, lit_len);
+      op += lit_len;
+      const size_t offset = ip - ref;
+      *op++ = (uint8_t)(offset & 0xFF);
+      *op++ = (uint8_t)(offset >> 8);
+      *token |= (uint8_t)(match_len < 15 ? match_len : 15);
+      if (match_len >= 15)
+        op = lz4_write_length(op, match_len - 15);
+
+      ip = mp;
+      anchor = ip;
+    }
+  }
+
+  // last literals
+  const size_t lit_len = iend - anchor;
+  if ((size_t)(oend - op) < 1 + lit_len / 255 + 1 + lit_len)
+    return 0;
+  *op++ = (uint8_t)((lit_len < 15 ? lit_len : 15) << 4);
+  if (lit_len >= 15)
+    op = lz4_write_length(op, lit_len - 15);
+  memcpy(op, anchor, lit_len);
+  op += lit_len;
+  return op - dst;
+}
+
+bool lz4_decompress_block(const uint8_t *src, size_t src_len, uint8_t *dst, size_t dst_len)
+{
+  const uint8_t *ip = src;
+  const uint8_t *const iend = src + src_len;
+  uint8_t *op = dst;
+  uint8_t *const oend = dst + dst_len;
+
+  while (ip < iend) {
+    const uint8_t token = *ip++;
+    size_t lit_len = token >> 4;
+    if (lit_len == 15) {
+      uint8_t b;
+      do {
+        if (ip >= iend)
+          return false;
+        b = *ip++;
+        lit_len += b;
+      } while (b == 255);
+    }
+    if ((size_t)(iend - ip) < lit_len || (size_t)(oend - op) < lit_len)
+      return false;
+    memcpy(op, ip, lit_len);
+    op += lit_len;
+    ip += lit_len;
+    if (ip == iend)
+      break; // last sequence has no match
+
+    if (iend - ip < 2)
+      return false;
+    const size_t offset = ip[0] | (ip[1] << 8);
+    ip += 2;
+    if (offset == 0 || offset > (size_t)(op - dst))
+      return false;
+    size_t match_len = token & 0xF;
+    if (match_len == 15) {
+      uint8_t b;
+      do {
+        if (ip >= iend)
+          return false;
+        b = *ip++;
+        match_len += b;
+      } while (b == 255);
+    }
+    match_len += LZ4_MINMATCH;
+    if ((size_t)(oend - op) < match_len)
+      return false;
+    const uint8_t *ref = op - offset;
+    if (offset >= match_len) {
+      memcpy(op, ref, match_len);
+      op += match_len;
+    } else {
+      // overlapping match repeats the recent bytes
+      for (size_t i = 0; i < match_len; ++i)
+        *op++ = *ref++;
+    }
+  }
+  return op == oend;
+}
+
 
 void csavecompressed(Stream *out, const unsigned char * tobesaved, const color pala[256])
 {
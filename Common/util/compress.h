@@ -29,6 +29,13 @@ void cpackbitl32(const uint32_t *line, int size, Common::Stream *out);
 int  cunpackbitl(uint8_t *line, int size, Common::Stream *in);
 int  cunpackbitl16(uint16_t *line, int size, Common::Stream *in);
 int  cunpackbitl32(uint32_t *line, int size, Common::Stream *in);
+// LZ4 block compression; returns the size of compressed data, or 0 if
+// it did not fit into the output buffer
+size_t lz4_compress_bound(size_t src_len);
+size_t lz4_compress_block(const uint8_t *src, size_t src_len, uint8_t *dst, size_t dst_cap);
+// LZ4 block decompression; returns false if the data is corrupt or
+// does not decompress into exactly dst_len bytes
+bool lz4_decompress_block(const uint8_t *src, size_t src_len, uint8_t *dst, size_t dst_len);
 
 //=============================================================================
 
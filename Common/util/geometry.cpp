@@ -11,6 +11,7 @@
 // http://www.opensource.org/licenses/artistic-license-2.0.php
 //
 //=============================================================================
+#include <algorithm>
 #include "util/geometry.h"
 
 //namespace AGS
@@ -30,6 +31,16 @@ bool IsRectInsideRect(const Rect &place, const Rect &item)
         item.Top >= place.Top && item.Bottom <= place.Bottom;
 }
 
+Rect UnionRects(const Rect &r1, const Rect &r2)
+{
+    if (r1.IsEmpty())
+        return r2;
+    if (r2.IsEmpty())
+        return r1;
+    return Rect(std::min(r1.Left, r2.Left), std::min(r1.Top, r2.Top),
+        std::max(r1.Right, r2.Right), std::max(r1.Bottom, r2.Bottom));
+}
+
 Size ProportionalStretch(int dest_w, int dest_h, int item_w, int item_h)
 {
     int width = item_w ? dest_w : 0;
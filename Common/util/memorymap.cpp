@@ -0,0 +1,148 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include "util/memorymap.h"
+#if AGS_PLATFORM_OS_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif !AGS_PLATFORM_OS_PSP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace AGS
+{
+namespace Common
+{
+
+MemoryMappedFile::MemoryMappedFile()
+    : _view(nullptr)
+    , _viewSize(0)
+    , _data(nullptr)
+    , _offset(0)
+    , _size(0)
+#if AGS_PLATFORM_OS_WINDOWS
+    , _fileHandle(INVALID_HANDLE_VALUE)
+    , _mapHandle(nullptr)
+#endif
+{
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    Close();
+}
+
+bool MemoryMappedFile::Open(const String &filename, soff_t offset, soff_t size)
+{
+    Close();
+    if (offset < 0 || size <= 0 || (uint64_t)size > SIZE_MAX)
+        return false;
+
+#if AGS_PLATFORM_OS_WINDOWS
+    SYSTEM_INFO sys_info;
+    GetSystemInfo(&sys_info);
+    // view must begin at the allocation granularity
+    const soff_t view_offset = offset - offset % sys_info.dwAllocationGranularity;
+    const soff_t view_size = size + (offset - view_offset);
+
+    HANDLE file = CreateFileA(filename.GetCStr(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping)
+    {
+        CloseHandle(file);
+        return false;
+    }
+    void *view = MapViewOfFile(mapping, FILE_MAP_READ, (DWORD)((uint64_t)view_offset >> 32),
+        (DWORD)((uint64_t)view_offset & 0xFFFFFFFF), (SIZE_T)view_size);
+    if (!view)
+    {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    _fileHandle = file;
+    _mapHandle = mapping;
+#elif !AGS_PLATFORM_OS_PSP
+    const long page_size = sysconf(_SC_PAGESIZE);
+    if (page_size <= 0)
+        return false;
+    // view must begin at the page boundary
+    const soff_t view_offset = offset - offset % page_size;
+    const soff_t view_size = size + (offset - view_offset);
+
+    int fd = open(filename.GetCStr(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < offset + size)
+    {
+        close(fd);
+        return false;
+    }
+    void *view = mmap(nullptr, (size_t)view_size, PROT_READ, MAP_SHARED, fd, (off_t)view_offset);
+    // the mapping stays valid after the file is closed
+    close(fd);
+    if (view == MAP_FAILED)
+        return false;
+#else
+    (void)filename;
+    return false;
+#endif
+
+#if !AGS_PLATFORM_OS_PSP
+    _view = view;
+    _viewSize = (size_t)view_size;
+    _data = static_cast<const uint8_t*>(view) + (offset - view_offset);
+    _offset = offset;
+    _size = size;
+    return true;
+#endif
+}
+
+void MemoryMappedFile::Close()
+{
+    if (!_view)
+        return;
+#if AGS_PLATFORM_OS_WINDOWS
+    UnmapViewOfFile(_view);
+    CloseHandle(_mapHandle);
+    CloseHandle(_fileHandle);
+    _mapHandle = nullptr;
+    _fileHandle = INVALID_HANDLE_VALUE;
+#elif !AGS_PLATFORM_OS_PSP
+    munmap(_view, _viewSize);
+#endif
+    _view = nullptr;
+    _viewSize = 0;
+    _data = nullptr;
+    _offset = 0;
+    _size = 0;
+}
+
+const uint8_t *MemoryMappedFile::GetAt(soff_t file_offset, soff_t length) const
+{
+    if (!_data || file_offset < _offset || length < 0 ||
+        file_offset - _offset > _size - length)
+        return nullptr;
+    return _data + (file_offset - _offset);
+}
+
+} // namespace Common
+} // namespace AGS
@@ -0,0 +1,72 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Read-only memory-mapped view of a file region.
+//
+// The mapped pages are shared with the OS file cache, and thus between all
+// the processes which map the same file.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__MEMORYMAP_H
+#define __AGS_CN_UTIL__MEMORYMAP_H
+
+#include "core/platform.h"
+#include "core/types.h"
+#include "util/string.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+class MemoryMappedFile
+{
+public:
+    MemoryMappedFile();
+    ~MemoryMappedFile();
+
+    // Maps the region of the file starting at the given offset;
+    // returns false if the mapping is not supported or failed
+    bool            Open(const String &filename, soff_t offset, soff_t size);
+    // Unmaps the file
+    void            Close();
+    // Tells if the file is mapped
+    bool            IsOpen() const { return _data != nullptr; }
+    // Gets the file offset of the mapped region
+    soff_t          GetOffset() const { return _offset; }
+    // Gets the size of the mapped region
+    soff_t          GetSize() const { return _size; }
+    // Gets pointer to the data at the given file offset, provided there is
+    // at least a given number of bytes available; otherwise returns nullptr
+    const uint8_t  *GetAt(soff_t file_offset, soff_t length) const;
+
+private:
+    MemoryMappedFile(const MemoryMappedFile&) = delete;
+    MemoryMappedFile &operator=(const MemoryMappedFile&) = delete;
+
+    void           *_view;     // beginning of the mapped view
+    size_t          _viewSize; // full size of the view, which is page aligned
+    const uint8_t  *_data;     // beginning of the requested region
+    soff_t          _offset;
+    soff_t          _size;
+#if AGS_PLATFORM_OS_WINDOWS
+    void           *_fileHandle;
+    void           *_mapHandle;
+#endif
+};
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_UTIL__MEMORYMAP_H
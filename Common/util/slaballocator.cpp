@@ -0,0 +1,137 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <stdlib.h>
+#include "util/slaballocator.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+const size_t SlabAllocator::DefaultSlabSize;
+const size_t SlabAllocator::NumSizeClasses;
+const size_t SlabAllocator::ClassGranularity;
+const size_t SlabAllocator::MaxClassSize;
+const uint32_t SlabAllocator::LargeClass;
+
+// Block sizes, including the header; spaced so that rounding up wastes
+// no more than a third of the block
+const size_t SlabAllocator::ClassSizes[SlabAllocator::NumSizeClasses] =
+    { 16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048 };
+
+SlabAllocator::SlabAllocator(size_t slab_size)
+    : _slabSize(slab_size < MaxClassSize ? MaxClassSize : slab_size)
+{
+    size_t size_class = 0;
+    for (size_t i = 0; i <= MaxClassSize / ClassGranularity; ++i)
+    {
+        while (ClassSizes[size_class] < i * ClassGranularity)
+            size_class++;
+        _classBySize[i] = (uint8_t)size_class;
+    }
+    for (size_t i = 0; i < NumSizeClasses; ++i)
+        _freeLists[i] = nullptr;
+}
+
+SlabAllocator::~SlabAllocator()
+{
+    // slabs are released by the owning pointers; large blocks which were
+    // not freed are lost, as we do not keep track of them
+}
+
+void *SlabAllocator::Allocate(size_t size)
+{
+    const size_t full_size = size + sizeof(BlockHeader);
+    if (size > UINT32_MAX - sizeof(BlockHeader))
+        return nullptr;
+
+    BlockHeader *header;
+    size_t block_size;
+    if (full_size > MaxClassSize)
+    {
+        header = static_cast<BlockHeader*>(malloc(full_size));
+        if (!header)
+            return nullptr;
+        header->SizeClass = LargeClass;
+        block_size = full_size;
+        _stats.LargeAllocations++;
+        _stats.ReservedBytes += full_size;
+    }
+    else
+    {
+        const size_t size_class = _classBySize[(full_size + ClassGranularity - 1) / ClassGranularity];
+        if (!_freeLists[size_class])
+            AddSlab(size_class);
+        FreeBlock *block = _freeLists[size_class];
+        _freeLists[size_class] = block->Next;
+        header = reinterpret_cast<BlockHeader*>(block);
+        header->SizeClass = (uint32_t)size_class;
+        block_size = ClassSizes[size_class];
+    }
+    header->Size = (uint32_t)size;
+
+    _stats.Allocations++;
+    _stats.LiveBlocks++;
+    _stats.LiveBytes += size;
+    _stats.UsedBytes += block_size;
+    return header + 1;
+}
+
+void SlabAllocator::Free(void *ptr)
+{
+    if (!ptr)
+        return;
+    BlockHeader *header = static_cast<BlockHeader*>(ptr) - 1;
+    _stats.LiveBlocks--;
+    _stats.LiveBytes -= header->Size;
+    if (header->SizeClass == LargeClass)
+    {
+        const size_t full_size = header->Size + sizeof(BlockHeader);
+        _stats.UsedBytes -= full_size;
+        _stats.ReservedBytes -= full_size;
+        free(header);
+        return;
+    }
+
+    const size_t size_class = header->SizeClass;
+    _stats.UsedBytes -= ClassSizes[size_class];
+    FreeBlock *block = reinterpret_cast<FreeBlock*>(header);
+    block->Next = _freeLists[size_class];
+    _freeLists[size_class] = block;
+}
+
+void SlabAllocator::AddSlab(size_t size_class)
+{
+    const size_t block_size = ClassSizes[size_class];
+    const size_t block_count = _slabSize / block_size;
+    // new[] returns memory aligned for any fundamental type, and all
+    // the class sizes are multiples of 16
+    uint8_t *slab = new uint8_t[block_count * block_size];
+    _slabs.emplace_back(slab);
+    _stats.ReservedBytes += block_count * block_size;
+
+    // link the blocks in their address order
+    FreeBlock *next = _freeLists[size_class];
+    for (size_t i = block_count; i > 0; --i)
+    {
+        FreeBlock *block = reinterpret_cast<FreeBlock*>(slab + (i - 1) * block_size);
+        block->Next = next;
+        next = block;
+    }
+    _freeLists[size_class] = next;
+}
+
+} // namespace Common
+} // namespace AGS
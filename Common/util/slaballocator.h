@@ -0,0 +1,106 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Allocator for the large numbers of small short-living memory blocks.
+//
+// Requested sizes are rounded up to one of the fixed size classes; blocks of
+// each class are cut from the large "slabs" and reused through the class's
+// free list. Blocks larger than the biggest class are allocated separately.
+// Slabs are kept until the allocator is destroyed.
+//
+// The allocator is not thread-safe.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__SLABALLOCATOR_H
+#define __AGS_CN_UTIL__SLABALLOCATOR_H
+
+#include <memory>
+#include <vector>
+#include "core/types.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+// Allocator usage counters
+struct SlabAllocatorStats
+{
+    uint64_t Allocations = 0;   // total number of allocations
+    uint64_t LargeAllocations = 0; // allocations bigger than any size class
+    size_t   LiveBlocks = 0;    // blocks currently allocated
+    size_t   LiveBytes = 0;     // bytes requested by the allocated blocks
+    size_t   UsedBytes = 0;     // real size of the allocated blocks
+    size_t   ReservedBytes = 0; // memory taken by slabs and large blocks
+
+    // Gets share of the reserved memory not occupied by the requested data,
+    // both due to rounding up to size classes and to free blocks in slabs
+    float GetFragmentation() const
+    {
+        return ReservedBytes > 0 ? 1.f - (float)LiveBytes / ReservedBytes : 0.f;
+    }
+};
+
+class SlabAllocator
+{
+public:
+    SlabAllocator(size_t slab_size = DefaultSlabSize);
+    ~SlabAllocator();
+
+    // Allocates block of at least given size, aligned by 8 bytes
+    void   *Allocate(size_t size);
+    // Frees the block previously returned by Allocate
+    void    Free(void *ptr);
+    // Gets usage counters
+    const SlabAllocatorStats &GetStats() const { return _stats; }
+
+    static const size_t DefaultSlabSize = 64 * 1024;
+
+private:
+    SlabAllocator(const SlabAllocator&) = delete;
+    SlabAllocator &operator=(const SlabAllocator&) = delete;
+
+    // Each block begins with a header, telling where to return it
+    struct BlockHeader
+    {
+        uint32_t SizeClass;
+        uint32_t Size; // requested size
+    };
+    // Free block, linked into the class's free list
+    struct FreeBlock
+    {
+        FreeBlock *Next;
+    };
+
+    static const size_t NumSizeClasses = 14;
+    static const size_t ClassGranularity = 16;
+    static const size_t MaxClassSize = 2048;
+    static const uint32_t LargeClass = UINT32_MAX;
+    static const size_t ClassSizes[NumSizeClasses];
+
+    // Cuts new slab into the blocks of the given class
+    void    AddSlab(size_t size_class);
+
+    size_t  _slabSize;
+    // size class index by the size in granularity units
+    uint8_t _classBySize[MaxClassSize / ClassGranularity + 1];
+    FreeBlock *_freeLists[NumSizeClasses];
+    std::vector<std::unique_ptr<uint8_t[]>> _slabs;
+    SlabAllocatorStats _stats;
+};
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_UTIL__SLABALLOCATOR_H
@@ -43,6 +43,23 @@ inline size_t Hash_LowerCase(const char *data, const size_t len)
     return hash;
 }
 
+// FNV-1a variant, which mixes each byte in before multiplying
+inline uint32_t Hash1a(const char *data, const size_t len)
+{
+    uint32_t hash = PRIME_NUMBER;
+    for (size_t i = 0; i < len; ++i)
+        hash = (hash ^ (uint8_t)(data[i])) * SECONDARY_NUMBER;
+    return hash;
+}
+
+inline uint32_t Hash1a(const char *cstr)
+{
+    uint32_t hash = PRIME_NUMBER;
+    for (; *cstr; ++cstr)
+        hash = (hash ^ (uint8_t)(*cstr)) * SECONDARY_NUMBER;
+    return hash;
+}
+
 } // namespace FNV
 
 
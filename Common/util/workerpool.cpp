@@ -0,0 +1,132 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <algorithm>
+#include <system_error>
+#include "util/workerpool.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+// Limit of the shared pool workers; the batches are not large enough to
+// make use of more
+static const size_t MaxSharedWorkers = 7;
+
+WorkerPool::WorkerPool(size_t worker_count)
+    : _job(nullptr)
+    , _count(0)
+    , _next(0)
+    , _done(0)
+    , _active(0)
+    , _batchId(0)
+    , _quit(false)
+{
+    for (size_t i = 0; i < worker_count; ++i)
+    {
+        try
+        {
+            _workers.push_back(std::thread(&WorkerPool::Run, this, i + 1));
+        }
+        catch (const std::system_error&)
+        {
+            break; // run with the workers we've got
+        }
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lk(_mutex);
+        _quit = true;
+        _startCV.notify_all();
+    }
+    for (size_t i = 0; i < _workers.size(); ++i)
+        _workers[i].join();
+}
+
+WorkerPool &WorkerPool::GetShared()
+{
+    static WorkerPool pool(std::min<size_t>(MaxSharedWorkers,
+        std::max<unsigned>(std::thread::hardware_concurrency(), 1) - 1));
+    return pool;
+}
+
+void WorkerPool::RunBatch(size_t count, const JobFunc &job)
+{
+    if (count == 0)
+        return;
+    if (_workers.empty() || count == 1)
+    {
+        for (size_t i = 0; i < count; ++i)
+            job(i, 0);
+        return;
+    }
+
+    std::lock_guard<std::mutex> batch_lk(_batchMutex);
+    {
+        std::lock_guard<std::mutex> lk(_mutex);
+        _job = &job;
+        _count = count;
+        _next = 0;
+        _done = 0;
+        _batchId++;
+        _startCV.notify_all();
+    }
+    RunJobs(0);
+    std::unique_lock<std::mutex> lk(_mutex);
+    // the workers which took the batch must leave it before the next one
+    // may reuse the batch state
+    _doneCV.wait(lk, [this]() { return _done == _count && _active == 0; });
+    _job = nullptr;
+}
+
+void WorkerPool::Run(size_t thread)
+{
+    uint32_t last_batch = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lk(_mutex);
+            _startCV.wait(lk, [this, last_batch]() { return _quit || (_job && _batchId != last_batch); });
+            if (_quit)
+                return;
+            last_batch = _batchId;
+            _active++;
+        }
+        RunJobs(thread);
+        std::lock_guard<std::mutex> lk(_mutex);
+        _active--;
+        if (_active == 0)
+            _doneCV.notify_all();
+    }
+}
+
+void WorkerPool::RunJobs(size_t thread)
+{
+    size_t done = 0;
+    for (size_t i = _next++; i < _count; i = _next++, ++done)
+        (*_job)(i, thread);
+    if (done == 0)
+        return;
+    std::lock_guard<std::mutex> lk(_mutex);
+    _done += done;
+    if (_done == _count)
+        _doneCV.notify_all();
+}
+
+} // namespace Common
+} // namespace AGS
@@ -0,0 +1,85 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Pool of worker threads which run batches of independent jobs.
+//
+// Jobs of a batch are identified by their index. The thread which runs the
+// batch takes part in doing the jobs, and waits until all of them are done.
+// Each job also receives the index of the thread it runs on, which may be
+// used to access the per-thread data: 0 is the calling thread, and the
+// workers are numbered from 1 to the number of workers.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__WORKERPOOL_H
+#define __AGS_CN_UTIL__WORKERPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "core/types.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+class WorkerPool
+{
+public:
+    typedef std::function<void(size_t job, size_t thread)> JobFunc;
+
+    // Creates the pool with the given number of worker threads;
+    // with no workers all the jobs are run on the calling thread
+    WorkerPool(size_t worker_count);
+    ~WorkerPool();
+
+    // Gets the number of threads which may run jobs, including the calling one
+    size_t GetThreadCount() const { return _workers.size() + 1; }
+    // Runs jobs from 0 to count - 1, and returns when all of them are done.
+    // Batches run one at a time; jobs must not start batches themselves.
+    void   RunBatch(size_t count, const JobFunc &job);
+
+    // Gets the pool shared by the engine; it has a worker for each
+    // CPU core except the one the game runs on
+    static WorkerPool &GetShared();
+
+private:
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool &operator=(const WorkerPool&) = delete;
+
+    void Run(size_t thread);
+    // Does the jobs of the current batch until there are none left
+    void RunJobs(size_t thread);
+
+    std::vector<std::thread> _workers;
+    std::mutex               _batchMutex; // makes the batches run one at a time
+    std::mutex               _mutex;      // guards the batch state
+    std::condition_variable  _startCV;    // notifies workers about a new batch
+    std::condition_variable  _doneCV;     // notifies the caller about finished jobs
+    const JobFunc           *_job;        // job of the current batch, or null
+    size_t                   _count;      // number of jobs in the current batch
+    std::atomic<size_t>      _next;       // next job to take
+    size_t                   _done;       // number of finished jobs
+    size_t                   _active;     // number of workers doing the batch
+    uint32_t                 _batchId;
+    bool                     _quit;
+};
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_UTIL__WORKERPOOL_H
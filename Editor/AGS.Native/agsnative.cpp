@@ -2128,7 +2128,7 @@ void SaveTempSpritefile(bool compressSprites, AGSString &saved_spritefile, AGSSt
     AGSString n_temp_spritefile = ConvertStringToNativeString(temp_spritefile);
     AGSString n_temp_indexfile = ConvertStringToNativeString(temp_indexfile);
     SpriteFileIndex index;
-    if (spriteset.SaveToFile(n_temp_spritefile, compressSprites, index) != 0)
+    if (spriteset.SaveToFile(n_temp_spritefile, compressSprites ? kSprCompress_RLE : kSprCompress_None, index) != 0)
         throw gcnew AGSEditorException(String::Format("Unable to save the sprites. An error occurred whilst writing the sprite file.{0}Temp path: {1}",
             Environment::NewLine, temp_spritefile));
     saved_spritefile = n_temp_spritefile;
@@ -52,6 +52,8 @@
 #include "ac/spritecache.h"
 #include "util/string_compat.h"
 #include <math.h>
+#include <memory>
+#include <vector>
 #include "gfx/graphicsdriver.h"
 #include "script/runtimescriptvalue.h"
 #include "ac/dynobj/cc_character.h"
@@ -1664,6 +1666,125 @@ int Character_GetSpeakingFrame(CharacterInfo *chaa) {
 // order of loops to turn character in circle from down to down
 int turnlooporder[8] = {0, 6, 1, 7, 3, 5, 2, 4};
 
+// Character walk waiting for the batch route search
+struct BatchedWalk
+{
+    int  Char;
+    bool AutoWalkAnims;
+    int  WaitWas;
+    int  AnimWaitWas;
+};
+
+static bool walk_batch_active = false;
+static std::vector<BatchedWalk> batched_walks;
+static std::vector<RouteRequest> batched_routes;
+// walkable masks kept for the next batches
+static std::vector<std::shared_ptr<Bitmap>> batch_masks;
+
+// Starts the walk along the found route, or stops the character if there's none
+static void start_walk_on_route(int chac, int mslot, int ignwal, bool autoWalkAnims, int waitWas, int animWaitWas)
+{
+    CharacterInfo *chin = &game.chars[chac];
+    if (mslot>0) {
+        chin->walking = mslot;
+        mls[mslot].direct = ignwal;
+        convert_move_path_to_room_resolution(&mls[mslot]);
+
+        // cancel any pending waits on current animations
+        // or if they were already moving, keep the current wait - 
+        // this prevents a glitch if MoveCharacter is called when they
+        // are already moving
+        if (autoWalkAnims)
+        {
+            chin->walkwait = waitWas;
+            charextra[chac].animwait = animWaitWas;
+
+            if (mls[mslot].pos[0] != mls[mslot].pos[1]) {
+                fix_player_sprite(&mls[mslot],chin);
+            }
+        }
+        else
+            chin->flags |= CHF_MOVENOTWALK;
+    }
+    else if (autoWalkAnims) // pathfinder couldn't get a route, stand them still
+        chin->frame = 0;
+}
+
+// Queues the route search for the batch, using the copy of the walkable
+// mask as it is now
+static void queue_walk_route(int chac, short srcx, short srcy, short destx, short desty, int ignwal,
+    int move_speed_x, int move_speed_y, bool autoWalkAnims, int waitWas, int animWaitWas)
+{
+    // the later walk order replaces the earlier one; the mask slots must stay
+    // in line with the requests, as the next request reuses the slot by index
+    for (size_t i = 0; i < batched_walks.size(); ++i)
+    {
+        if (batched_walks[i].Char == chac)
+        {
+            batched_walks.erase(batched_walks.begin() + i);
+            batched_routes.erase(batched_routes.begin() + i);
+            batch_masks.erase(batch_masks.begin() + i);
+            break;
+        }
+    }
+
+    const size_t index = batched_routes.size();
+    set_color_depth(8);
+    Bitmap *mask = prepare_walkable_areas(chac);
+    if (index < batch_masks.size() && batch_masks[index]->GetSize() == mask->GetSize())
+        batch_masks[index]->Blit(mask, 0, 0, 0, 0, mask->GetWidth(), mask->GetHeight());
+    else if (index < batch_masks.size())
+        batch_masks[index].reset(BitmapHelper::CreateBitmapCopy(mask));
+    else
+        batch_masks.push_back(std::shared_ptr<Bitmap>(BitmapHelper::CreateBitmapCopy(mask)));
+    set_color_depth(game.GetColorDepth());
+
+    RouteRequest req;
+    req.SrcX = srcx;
+    req.SrcY = srcy;
+    req.DstX = destx;
+    req.DstY = desty;
+    req.MoveSpeedX = move_speed_x;
+    req.MoveSpeedY = move_speed_y;
+    req.MoveList = chac + CHMLSOFFS;
+    req.NoCross = 1;
+    req.IgnoreWalls = ignwal;
+    req.Mask = batch_masks[index];
+    req.Result = 0;
+    batched_routes.push_back(req);
+
+    BatchedWalk walk;
+    walk.Char = chac;
+    walk.AutoWalkAnims = autoWalkAnims;
+    walk.WaitWas = waitWas;
+    walk.AnimWaitWas = animWaitWas;
+    batched_walks.push_back(walk);
+}
+
+void begin_walk_batch()
+{
+    walk_batch_active = true;
+}
+
+void end_walk_batch()
+{
+    walk_batch_active = false;
+    if (batched_routes.empty())
+        return;
+
+    find_routes(&batched_routes[0], batched_routes.size());
+    // start the walks in the order they were made, as if the routes were
+    // found right away
+    for (size_t i = 0; i < batched_walks.size(); ++i)
+    {
+        const BatchedWalk &walk = batched_walks[i];
+        start_walk_on_route(walk.Char, batched_routes[i].Result, batched_routes[i].IgnoreWalls,
+            walk.AutoWalkAnims, walk.WaitWas, walk.AnimWaitWas);
+    }
+    batched_walks.clear();
+    batched_routes.clear();
+}
+
 void walk_character(int chac,int tox,int toy,int ignwal, bool autoWalkAnims) {
     CharacterInfo*chin=&game.chars[chac];
     if (chin->room!=displayed_room)
@@ -1719,32 +1840,17 @@ void walk_character(int chac,int tox,int toy,int ignwal, bool autoWalkAnims) {
     }
 
     set_route_move_speed(move_speed_x, move_speed_y);
+    if (walk_batch_active)
+    {
+        queue_walk_route(chac, charX, charY, tox, toy, ignwal, move_speed_x, move_speed_y,
+            autoWalkAnims, waitWas, animWaitWas);
+        return;
+    }
+
     set_color_depth(8);
     int mslot=find_route(charX, charY, tox, toy, prepare_walkable_areas(chac), chac+CHMLSOFFS, 1, ignwal);
     set_color_depth(game.GetColorDepth());
-    if (mslot>0) {
-        chin->walking = mslot;
-        mls[mslot].direct = ignwal;
-        convert_move_path_to_room_resolution(&mls[mslot]);
-
-        // cancel any pending waits on current animations
-        // or if they were already moving, keep the current wait - 
-        // this prevents a glitch if MoveCharacter is called when they
-        // are already moving
-        if (autoWalkAnims)
-        {
-            chin->walkwait = waitWas;
-            charextra[chac].animwait = animWaitWas;
-
-            if (mls[mslot].pos[0] != mls[mslot].pos[1]) {
-                fix_player_sprite(&mls[mslot],chin);
-            }
-        }
-        else
-            chin->flags |= CHF_MOVENOTWALK;
-    }
-    else if (autoWalkAnims) // pathfinder couldn't get a route, stand them still
-        chin->frame = 0;
+    start_walk_on_route(chac, mslot, ignwal, autoWalkAnims, waitWas, animWaitWas);
 }
 
 int find_looporder_index (int curloop) {
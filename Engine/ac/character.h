@@ -176,6 +176,11 @@ void find_nearest_walkable_area (int *xx, int *yy);
 void walk_character(int chac,int tox,int toy,int ignwal, bool autoWalkAnims);
 void FindReasonableLoopForCharacter(CharacterInfo *chap);
 void walk_or_move_character(CharacterInfo *chaa, int x, int y, int blocking, int direct, bool isWalk);
+// Starts collecting the character walks, whose routes are then searched
+// all together in end_walk_batch; until then the walking characters stand still
+void begin_walk_batch();
+// Searches for the routes of the collected walks and starts them
+void end_walk_batch();
 int  is_valid_character(int newchar);
 int  wantMoveNow (CharacterInfo *chi, CharacterExtras *chex);
 void setup_player_character(int charid);
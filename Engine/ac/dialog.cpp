@@ -156,7 +156,7 @@ const char* Dialog_GetOptionText(ScriptDialog *sd, int option)
 
   option--;
 
-  return CreateNewScriptString(get_translation(dialog[sd->id].optionnames[option]));
+  return CreateInternedScriptString(get_translation(dialog[sd->id].optionnames[option]));
 }
 
 int Dialog_GetID(ScriptDialog *sd) {
@@ -87,8 +87,8 @@ extern AGSPlatformDriver *platform;
 extern RoomStruct thisroom;
 extern char noWalkBehindsAtAll;
 extern unsigned int loopcounter;
-extern char *walkBehindExists;  // whether a WB area is in this column
-extern int *walkBehindStartY, *walkBehindEndY;
+extern std::vector<WalkBehindSpan> walkBehindSpans;
+extern std::vector<int> walkBehindRowSpans;
 extern int walkBehindLeft[MAX_WALK_BEHINDS], walkBehindTop[MAX_WALK_BEHINDS];
 extern int walkBehindRight[MAX_WALK_BEHINDS], walkBehindBottom[MAX_WALK_BEHINDS];
 extern IDriverDependantBitmap *walkBehindBitmap[MAX_WALK_BEHINDS];
@@ -935,7 +935,7 @@ void draw_sprite_support_alpha(Bitmap *ds, bool ds_has_alpha, int xpos, int ypos
     else if (src_has_alpha && alpha == 0xFF)
     {
         set_alpha_blender();
-        ds->TransBlendBlt(image, xpos, ypos);
+        GfxUtil::TransBlendBlt(ds, image, xpos, ypos);
     }
     else
     {
@@ -951,11 +951,16 @@ void draw_sprite_slot_support_alpha(Bitmap *ds, bool ds_has_alpha, int xpos, int
 }
 
 
+// Tells if the DDB may be updated from the source bitmap: same colour depth, width and height
+static bool can_reuse_ddb_bitmap(IDriverDependantBitmap *bimp, Bitmap *source)
+{
+    return ((bimp->GetColorDepth() + 1) / 8 == source->GetBPP()) &&
+        (bimp->GetWidth() == source->GetWidth()) && (bimp->GetHeight() == source->GetHeight());
+}
+
 IDriverDependantBitmap* recycle_ddb_bitmap(IDriverDependantBitmap *bimp, Bitmap *source, bool hasAlpha, bool opaque) {
     if (bimp != nullptr) {
-        // same colour depth, width and height -> reuse
-        if (((bimp->GetColorDepth() + 1) / 8 == source->GetBPP()) && 
-            (bimp->GetWidth() == source->GetWidth()) && (bimp->GetHeight() == source->GetHeight()))
+        if (can_reuse_ddb_bitmap(bimp, source))
         {
             gfxDriver->UpdateDDBFromBitmap(bimp, source, hasAlpha);
             return bimp;
@@ -967,11 +972,53 @@ IDriverDependantBitmap* recycle_ddb_bitmap(IDriverDependantBitmap *bimp, Bitmap
     return bimp;
 }
 
+IDriverDependantBitmap* recycle_ddb_bitmap(IDriverDependantBitmap *bimp, Bitmap *source, bool hasAlpha, const Rect &region) {
+    if (bimp != nullptr && can_reuse_ddb_bitmap(bimp, source))
+    {
+        gfxDriver->UpdateDDBRegionFromBitmap(bimp, source, hasAlpha, region);
+        return bimp;
+    }
+    return recycle_ddb_bitmap(bimp, source, hasAlpha);
+}
+
 void invalidate_cached_walkbehinds() 
 {
     memset(&actspswbcache[0], 0, sizeof(CachedActSpsData) * actSpsCount);
 }
 
+// Tells if the sprite pixel is not transparent
+static inline bool is_sprite_pixel_opaque(const uint8_t *scanline, int x, int bpp, int maskcol)
+{
+    switch (bpp)
+    {
+    case 1: return scanline[x] != maskcol;
+    case 2: return ((const short*)scanline)[x] != (short)maskcol;
+    case 3: return memcmp(&scanline[x * 3], &maskcol, 3) != 0;
+    default: return ((const int*)scanline)[x] != maskcol;
+    }
+}
+
+// Fills the run of the sprite row with the transparent color
+static void fill_sprite_span(uint8_t *scanline, int x1, int x2, int bpp, int maskcol)
+{
+    switch (bpp)
+    {
+    case 1:
+        memset(&scanline[x1], maskcol, x2 - x1);
+        break;
+    case 2:
+        std::fill((short*)scanline + x1, (short*)scanline + x2, (short)maskcol);
+        break;
+    case 3:
+        for (int x = x1; x < x2; ++x)
+            memcpy(&scanline[x * 3], &maskcol, 3);
+        break;
+    default:
+        std::fill((int*)scanline + x1, (int*)scanline + x2, maskcol);
+        break;
+    }
+}
+
 // sort_out_walk_behinds: modifies the supplied sprite by overwriting parts
 // of it with transparent pixels where there are walk-behind areas
 // Returns whether any pixels were updated
@@ -983,110 +1030,56 @@ int sort_out_walk_behinds(Bitmap *sprit,int xx,int yy,int basel, Bitmap *copyPix
         (!sprit->IsMemoryBitmap()))
         quit("!sort_out_walk_behinds: wb bitmap not linear");
 
-    int rr,tmm, toheight;//,tcol;
     // precalculate this to try and shave some time off
-    int maskcol = sprit->GetMaskColor();
-    int spcoldep = sprit->GetColorDepth();
-    int screenhit = thisroom.WalkBehindMask->GetHeight();
-    short *shptr, *shptr2;
-    int *loptr, *loptr2;
+    const int maskcol = sprit->GetMaskColor();
+    const int spcoldep = sprit->GetColorDepth();
+    if (spcoldep > 32)
+        quit("!Sprite colour depth >32 ??");
+    const int bpp = (spcoldep + 7) / 8;
     int pixelsChanged = 0;
-    int ee = 0;
-    if (xx < 0)
-        ee = 0 - xx;
 
     if ((checkPixelsFrom != nullptr) && (checkPixelsFrom->GetColorDepth() != spcoldep))
         quit("sprite colour depth does not match background colour depth");
 
-    for ( ; ee < sprit->GetWidth(); ee++) {
-        if (ee + xx >= thisroom.WalkBehindMask->GetWidth())
-            break;
-
-        if ((!walkBehindExists[ee+xx]) ||
-            (walkBehindEndY[ee+xx] <= yy) ||
-            (walkBehindStartY[ee+xx] > yy+sprit->GetHeight()))
-            continue;
-
-        toheight = sprit->GetHeight();
+    // the part of the sprite which is over the mask
+    const int fromx = std::max(0, -xx);
+    const int tox = std::min(sprit->GetWidth(), thisroom.WalkBehindMask->GetWidth() - xx);
+    const int fromy = std::max(0, -yy);
+    const int toy = std::min(sprit->GetHeight(), thisroom.WalkBehindMask->GetHeight() - yy);
+
+    for (int rr = fromy; rr < toy; rr++) {
+        const int last_span = walkBehindRowSpans[rr + yy + 1];
+        uint8_t *sprite_row = nullptr;
+        for (int sp = walkBehindRowSpans[rr + yy]; sp < last_span; sp++) {
+            const WalkBehindSpan &span = walkBehindSpans[sp];
+            if (span.X2 - xx <= fromx)
+                continue;
+            if (span.X1 - xx >= tox)
+                break;
+            if (croom->walkbehind_base[span.Area] <= basel)
+                continue;
 
-        if (walkBehindStartY[ee+xx] < yy)
-            rr = 0;
-        else
-            rr = (walkBehindStartY[ee+xx] - yy);
-
-        // Since we will use _getpixel, ensure we only check within the screen
-        if (rr + yy < 0)
-            rr = 0 - yy;
-        if (toheight + yy > screenhit)
-            toheight = screenhit - yy;
-        if (toheight + yy > walkBehindEndY[ee+xx])
-            toheight = walkBehindEndY[ee+xx] - yy;
-        if (rr < 0)
-            rr = 0;
-
-        for ( ; rr < toheight;rr++) {
-
-            // we're ok with _getpixel because we've checked the screen edges
-            //tmm = _getpixel(thisroom.WalkBehindMask,ee+xx,rr+yy);
-            // actually, _getpixel is well inefficient, do it ourselves
-            // since we know it's 8-bit bitmap
-            tmm = thisroom.WalkBehindMask->GetScanLine(rr+yy)[ee+xx];
-            if (tmm<1) continue;
-            if (croom->walkbehind_base[tmm] <= basel) continue;
+            const int x1 = std::max(fromx, span.X1 - xx);
+            const int x2 = std::min(tox, span.X2 - xx);
+            if (!sprite_row)
+                sprite_row = sprit->GetScanLineForWriting(rr);
 
             if (copyPixelsFrom != nullptr)
             {
-                if (spcoldep <= 8)
-                {
-                    if (checkPixelsFrom->GetScanLine((rr * 100) / zoom)[(ee * 100) / zoom] != maskcol) {
-                        sprit->GetScanLineForWriting(rr)[ee] = copyPixelsFrom->GetScanLine(rr + yy)[ee + xx];
-                        pixelsChanged = 1;
-                    }
-                }
-                else if (spcoldep <= 16) {
-                    shptr = (short*)&sprit->GetScanLine(rr)[0];
-                    shptr2 = (short*)&checkPixelsFrom->GetScanLine((rr * 100) / zoom)[0];
-                    if (shptr2[(ee * 100) / zoom] != maskcol) {
-                        shptr[ee] = ((short*)(&copyPixelsFrom->GetScanLine(rr + yy)[0]))[ee + xx];
-                        pixelsChanged = 1;
-                    }
-                }
-                else if (spcoldep == 24) {
-                    char *chptr = (char*)&sprit->GetScanLine(rr)[0];
-                    char *chptr2 = (char*)&checkPixelsFrom->GetScanLine((rr * 100) / zoom)[0];
-                    if (memcmp(&chptr2[((ee * 100) / zoom) * 3], &maskcol, 3) != 0) {
-                        memcpy(&chptr[ee * 3], &copyPixelsFrom->GetScanLine(rr + yy)[(ee + xx) * 3], 3);
-                        pixelsChanged = 1;
-                    }
-                }
-                else if (spcoldep <= 32) {
-                    loptr = (int*)&sprit->GetScanLine(rr)[0];
-                    loptr2 = (int*)&checkPixelsFrom->GetScanLine((rr * 100) / zoom)[0];
-                    if (loptr2[(ee * 100) / zoom] != maskcol) {
-                        loptr[ee] = ((int*)(&copyPixelsFrom->GetScanLine(rr + yy)[0]))[ee + xx];
+                // restore the background where the character's sprite is opaque
+                const uint8_t *check_row = checkPixelsFrom->GetScanLine((rr * 100) / zoom);
+                const uint8_t *bg_row = copyPixelsFrom->GetScanLine(rr + yy) + xx * bpp;
+                for (int ee = x1; ee < x2; ee++) {
+                    if (is_sprite_pixel_opaque(check_row, (ee * 100) / zoom, bpp, maskcol)) {
+                        memcpy(&sprite_row[ee * bpp], &bg_row[ee * bpp], bpp);
                         pixelsChanged = 1;
                     }
                 }
             }
             else
             {
+                fill_sprite_span(sprite_row, x1, x2, bpp, maskcol);
                 pixelsChanged = 1;
-                if (spcoldep <= 8)
-                    sprit->GetScanLineForWriting(rr)[ee] = maskcol;
-                else if (spcoldep <= 16) {
-                    shptr = (short*)&sprit->GetScanLine(rr)[0];
-                    shptr[ee] = maskcol;
-                }
-                else if (spcoldep == 24) {
-                    char *chptr = (char*)&sprit->GetScanLine(rr)[0];
-                    memcpy(&chptr[ee * 3], &maskcol, 3);
-                }
-                else if (spcoldep <= 32) {
-                    loptr = (int*)&sprit->GetScanLine(rr)[0];
-                    loptr[ee] = maskcol;
-                }
-                else
-                    quit("!Sprite colour depth >32 ??");
             }
         }
     }
@@ -1208,7 +1201,7 @@ void draw_gui_sprite(Bitmap *ds, int pic, int x, int y, bool use_alpha, BlendMod
             set_additive_alpha_blender();
         else
             set_opaque_alpha_blender();
-        ds->TransBlendBlt(sprite, x, y);
+        GfxUtil::TransBlendBlt(ds, sprite, x, y);
     }
     else
     {
@@ -1426,7 +1419,7 @@ void apply_tint_or_light(int actspsindex, int light_level,
              lit_amnt = abs(light_level) * 2;
          }
 
-         active_spr->LitBlendBlt(oldwas, 0, 0, lit_amnt);
+         GfxUtil::LitBlendBlt(active_spr, oldwas, 0, 0, lit_amnt);
      }
 
      if (oldwas != blitFrom)
@@ -1806,7 +1799,7 @@ void tint_image (Bitmap *ds, Bitmap *srcimg, int red, int grn, int blu, int ligh
     if (light_level >= 100) {
         // fully colourised
         ds->FillTransparent();
-        ds->LitBlendBlt(srcimg, 0, 0, luminance);
+        GfxUtil::LitBlendBlt(ds, srcimg, 0, 0, luminance);
     }
     else {
         // light_level is between -100 and 100 normally; 0-100 in
@@ -1818,11 +1811,11 @@ void tint_image (Bitmap *ds, Bitmap *srcimg, int red, int grn, int blu, int ligh
         // Render the colourised image to a temporary bitmap,
         // then transparently draw it over the original image
         Bitmap *finaltarget = BitmapHelper::CreateTransparentBitmap(srcimg->GetWidth(), srcimg->GetHeight(), srcimg->GetColorDepth());
-        finaltarget->LitBlendBlt(srcimg, 0, 0, luminance);
+        GfxUtil::LitBlendBlt(finaltarget, srcimg, 0, 0, luminance);
 
         // customized trans blender to preserve alpha channel
         set_my_trans_blender (0, 0, 0, light_level);
-        ds->TransBlendBlt (finaltarget, 0, 0);
+        GfxUtil::TransBlendBlt(ds, finaltarget, 0, 0);
         delete finaltarget;
     }
 }
@@ -2220,7 +2213,12 @@ void draw_fps(const Rect &viewport)
     wouttext_outline(fpsDisplay, 1, 1, font, text_color, fps_buffer);
 
     char loop_buffer[60];
-    sprintf(loop_buffer, "Loop %u", loopcounter);
+    const RenderStats stats = gfxDriver->GetRenderStats();
+    if (stats.DrawCalls > 0)
+        snprintf(loop_buffer, sizeof(loop_buffer), "Loop %u, draws %u, binds %u",
+            loopcounter, stats.DrawCalls, stats.TextureBinds);
+    else
+        snprintf(loop_buffer, sizeof(loop_buffer), "Loop %u", loopcounter);
     wouttext_outline(fpsDisplay, viewport.GetWidth() / 2, 1, font, text_color, loop_buffer);
 
     if (ddb)
@@ -2269,43 +2267,46 @@ void draw_gui_and_overlays()
         if (playerchar->activeinv < 1) gui_inv_pic=-1;
         else gui_inv_pic=game.invinfo[playerchar->activeinv].pic;
         our_eip = 37;
+        // The global flag tells that all the GUIs have to be fully redrawn
         if (guis_need_update) {
             guis_need_update = 0;
-            for (aa=0;aa<game.numgui;aa++) {
-                if (!guis[aa].IsDisplayed()) continue;
+            for (aa=0;aa<game.numgui;aa++)
+                guis[aa].MarkChanged();
+        }
+        for (aa=0;aa<game.numgui;aa++) {
+            if (!guis[aa].IsDisplayed()) continue;
+            if (!guis[aa].HasChanged() && !guis[aa].HasControlsChanged()) continue;
 
-                if (guibg[aa] == nullptr)
-                    recreate_guibg_image(&guis[aa]);
+            if (guibg[aa] == nullptr)
+                recreate_guibg_image(&guis[aa]);
 
-                eip_guinum = aa;
+            eip_guinum = aa;
+            const bool isAlpha = guis[aa].HasAlphaChannel();
+            // old-style (pre-3.0.2) GUI alpha rendering has to fix the whole image
+            const bool legacyAlpha = isAlpha &&
+                (game.options[OPT_NEWGUIALPHA] == kGuiAlphaRender_Legacy) && (guis[aa].BgImage > 0);
+            if (guis[aa].HasChanged() || legacyAlpha || (guibgbmp[aa] == nullptr))
+            {
                 our_eip = 370;
                 guibg[aa]->ClearTransparent();
                 our_eip = 372;
                 guis[aa].DrawAt(guibg[aa], 0,0);
                 our_eip = 373;
-
-                bool isAlpha = false;
-                if (guis[aa].HasAlphaChannel()) 
-                {
-                    isAlpha = true;
-
-                    if ((game.options[OPT_NEWGUIALPHA] == kGuiAlphaRender_Legacy) && (guis[aa].BgImage > 0))
-                    {
-                        // old-style (pre-3.0.2) GUI alpha rendering
-                        repair_alpha_channel(guibg[aa], spriteset[guis[aa].BgImage]);
-                    }
-                }
-
-                if (guibgbmp[aa] != nullptr) 
-                {
-                    gfxDriver->UpdateDDBFromBitmap(guibgbmp[aa], guibg[aa], isAlpha);
-                }
-                else
-                {
-                    guibgbmp[aa] = gfxDriver->CreateDDBFromBitmap(guibg[aa], isAlpha);
-                }
-                our_eip = 374;
+                if (legacyAlpha)
+                    repair_alpha_channel(guibg[aa], spriteset[guis[aa].BgImage]);
+                guibgbmp[aa] = recycle_ddb_bitmap(guibgbmp[aa], guibg[aa], isAlpha);
+            }
+            else
+            {
+                // only redraw and upload the area of the changed controls
+                our_eip = 372;
+                Rect dirty = guis[aa].DrawChangedControls(guibg[aa], 0, 0);
+                our_eip = 373;
+                if (!dirty.IsEmpty())
+                    guibgbmp[aa] = recycle_ddb_bitmap(guibgbmp[aa], guibg[aa], isAlpha, dirty);
             }
+            guis[aa].ClearChanged();
+            our_eip = 374;
         }
         our_eip = 38;
         // Draw the GUIs
@@ -2484,6 +2485,7 @@ void construct_game_scene(bool full_redraw)
 
     gfxDriver->UseSmoothScaling(IS_ANTIALIAS_SPRITES);
     gfxDriver->RenderSpritesAtScreenResolution(usetup.RenderAtScreenRes, usetup.Supersampling);
+    gfxDriver->SetRenderThreads(usetup.RenderThreads);
 
     pl_run_plugin_hooks(AGSE_PRERENDER, 0);
 
@@ -42,7 +42,7 @@ int CCDynamicArray::Dispose(const char *address, bool force) {
         }
     }
 
-    delete address;
+    ccFreeManagedData((void*)address);
     return 1;
 }
 
@@ -61,14 +61,14 @@ int CCDynamicArray::Serialize(const char *address, char *buffer, int bufsize) {
 }
 
 void CCDynamicArray::Unserialize(int index, const char *serializedData, int dataSize) {
-    char *newArray = new char[dataSize];
+    char *newArray = (char*)ccAllocManagedData(dataSize);
     memcpy(newArray, serializedData, dataSize);
     ccRegisterUnserializedObject(index, &newArray[8], this);
 }
 
 DynObjectRef CCDynamicArray::Create(int numElements, int elementSize, bool isManagedType)
 {
-    char *newArray = new char[numElements * elementSize + 8];
+    char *newArray = (char*)ccAllocManagedData(numElements * elementSize + 8);
     memset(newArray, 0, numElements * elementSize + 8);
     int *sizePtr = (int*)newArray;
     sizePtr[0] = numElements;
@@ -79,7 +79,7 @@ DynObjectRef CCDynamicArray::Create(int numElements, int elementSize, bool isMan
     int32_t handle = ccRegisterManagedObject(obj_ptr, this);
     if (handle == 0)
     {
-        delete[] newArray;
+        ccFreeManagedData(newArray);
         return DynObjectRef(0, nullptr);
     }
     return DynObjectRef(handle, obj_ptr);
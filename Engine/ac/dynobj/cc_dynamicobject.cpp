@@ -33,11 +33,15 @@
 #include "debug/out.h"
 #include "script/cc_error.h"
 #include "script/script_common.h"
+#include "util/slaballocator.h"
 #include "util/stream.h"
 
 using namespace AGS::Common;
 
 ICCStringClass *stringClassImpl = nullptr;
+// scripts create and dispose lots of small strings and arrays,
+// so their data is allocated from the slabs
+SlabAllocator managedDataAlloc;
 
 // set the class that will be used for dynamic strings
 void ccSetStringClassImpl(ICCStringClass *theClass) {
@@ -149,3 +153,15 @@ int ccReleaseObjectReference(int32_t handle) {
 
     return pool.SubRef(handle);
 }
+
+void *ccAllocManagedData(size_t size) {
+    return managedDataAlloc.Allocate(size);
+}
+
+void ccFreeManagedData(void *data) {
+    managedDataAlloc.Free(data);
+}
+
+const SlabAllocatorStats &ccGetManagedDataStats() {
+    return managedDataAlloc.GetStats();
+}
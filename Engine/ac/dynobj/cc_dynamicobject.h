@@ -22,7 +22,7 @@
 #include "core/types.h"
 
 // Forward declaration
-namespace AGS { namespace Common { class Stream; } }
+namespace AGS { namespace Common { class Stream; struct SlabAllocatorStats; } }
 using namespace AGS; // FIXME later
 
 // A pair of managed handle and abstract object pointer
@@ -111,6 +111,13 @@ extern const char *ccGetObjectAddressFromHandle(int32_t handle);
 extern int ccAddObjectReference(int32_t handle);
 extern int ccReleaseObjectReference(int32_t handle);
 
+// allocate memory for the managed object's data (string text, array contents);
+// it must be freed with ccFreeManagedData when the object is disposed
+extern void *ccAllocManagedData(size_t size);
+extern void  ccFreeManagedData(void *data);
+// get managed data allocator's usage counters
+extern const Common::SlabAllocatorStats &ccGetManagedDataStats();
+
 extern ICCStringClass *stringClassImpl;
 
 #endif // __CC_DYNAMICOBJECT_H
@@ -13,6 +13,7 @@
 //=============================================================================
 #include <vector>
 #include <string.h>
+#include "ac/timer.h"
 #include "ac/dynobj/managedobjectpool.h"
 #include "ac/dynobj/cc_dynamicarray.h" // globalDynamicArray, constants
 #include "debug/out.h"
@@ -26,6 +27,8 @@ using namespace AGS::Common;
 const auto OBJECT_CACHE_MAGIC_NUMBER = 0xa30b;
 const auto SERIALIZE_BUFFER_SIZE = 10240;
 const auto GARBAGE_COLLECTION_INTERVAL = 1024;
+// max number of candidates checked by the collector at once
+const auto GARBAGE_COLLECTION_STEP = 256;
 const auto RESERVED_SIZE = 2048;
 
 int ManagedObjectPool::Remove(ManagedObject &o, bool force) {
@@ -39,12 +42,19 @@ int ManagedObjectPool::Remove(ManagedObject &o, bool force) {
 
     handleByAddress.erase(o.addr);
     o = ManagedObject();
+    stats.objects--;
 
     ManagedObjectLog("Line %d Disposed managed object handle=%d", currentline, handle);
 
     return 1;
 }
 
+void ManagedObjectPool::AddGarbageCandidate(ManagedObject &o) {
+    if (o.gcCandidate) { return; }
+    o.gcCandidate = true;
+    gcCandidates.push_back(o.handle);
+}
+
 int32_t ManagedObjectPool::AddRef(int32_t handle) {
     if (handle < 0 || (size_t)handle >= objects.size()) { return 0; }
     auto & o = objects[handle];
@@ -74,6 +84,10 @@ int32_t ManagedObjectPool::SubRef(int32_t handle) {
     if (canBeDisposed) {
         CheckDispose(handle);
     }
+    // if it's still unreferenced, let the collector try it later
+    if (o.isUsed() && o.refCount < 1) {
+        AddGarbageCandidate(o);
+    }
     // object could be removed at this point, don't use any values.
     ManagedObjectLog("Line %d SubRef: handle=%d new refcount=%d canBeDisposed=%d", currentline, handle, newRefCount, canBeDisposed);
     return newRefCount;
@@ -116,21 +130,50 @@ int ManagedObjectPool::RemoveObject(const char *address) {
 
 void ManagedObjectPool::RunGarbageCollectionIfAppropriate()
 {
-    if (objectCreationCounter <= GARBAGE_COLLECTION_INTERVAL) { return; }
-    RunGarbageCollection();
-    objectCreationCounter = 0;
+    if (!gcInProgress) {
+        if (objectCreationCounter <= GARBAGE_COLLECTION_INTERVAL) { return; }
+        objectCreationCounter = 0;
+        gcInProgress = true;
+        stats.collections++;
+    }
+    // collect incrementally, the rest is done on the next calls
+    if (RunGarbageCollectionStep(GARBAGE_COLLECTION_STEP)) {
+        gcInProgress = false;
+    }
 }
 
 void ManagedObjectPool::RunGarbageCollection()
 {
-    for (int i = 1; i < nextHandle; i++) {
-        auto & o = objects[i];
-        if (!o.isUsed()) { continue; }
-        if (o.refCount < 1) {
-            Remove(o);
+    stats.collections++;
+    RunGarbageCollectionStep(SIZE_MAX);
+    gcInProgress = false;
+    ManagedObjectLog("Ran garbage collection");
+}
+
+bool ManagedObjectPool::RunGarbageCollectionStep(size_t max_checks)
+{
+    const auto start = AGS_Clock::now();
+    size_t checks = 0;
+    for (; checks < max_checks && !gcCandidates.empty(); checks++) {
+        auto handle = gcCandidates.back();
+        gcCandidates.pop_back();
+        auto & o = objects[handle];
+        // the object could have been removed and the handle reused
+        if (!o.gcCandidate) { continue; }
+        o.gcCandidate = false;
+        if (!o.isUsed() || o.refCount >= 1) { continue; }
+        // objects which refuse disposal will be listed again when their
+        // refcount drops to zero next time
+        if (Remove(o)) {
+            stats.collected++;
         }
     }
-    ManagedObjectLog("Ran garbage collection");
+
+    const auto pause = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(AGS_Clock::now() - start).count();
+    stats.pauseTotalUs += pause;
+    if (pause > stats.pauseMaxUs) { stats.pauseMaxUs = pause; }
+    ManagedObjectLog("Garbage collection step: checked %d, %d candidates left", (int)checks, (int)gcCandidates.size());
+    return gcCandidates.empty();
 }
 
 int ManagedObjectPool::AddObject(const char *address, ICCDynamicObject *callback, bool plugin_object) 
@@ -154,6 +197,9 @@ int ManagedObjectPool::AddObject(const char *address, ICCDynamicObject *callback
 
     handleByAddress.insert({address, o.handle});
     objectCreationCounter++;
+    stats.objects++;
+    // new objects are not referenced yet
+    AddGarbageCandidate(o);
     ManagedObjectLog("Allocated managed object handle=%d, type=%s", handle, callback->GetType());
     return o.handle;
 }
@@ -172,6 +218,7 @@ int ManagedObjectPool::AddUnserializedObject(const char *address, ICCDynamicObje
     o = ManagedObject(plugin_object ? kScValPluginObject : kScValDynamicObject, handle, address, callback);
 
     handleByAddress.insert({address, o.handle});
+    stats.objects++;
     ManagedObjectLog("Allocated unserialized managed object handle=%d, type=%s", o.handle, callback->GetType());
     return o.handle;
 }
@@ -298,6 +345,8 @@ int ManagedObjectPool::ReadFromDisk(Stream *in, ICCObjectReader *reader) {
     for (int i = 1; i < nextHandle; i++) {
         if (!objects[i].isUsed()) {
             available_ids.push(i);
+        } else if (objects[i].refCount < 1) {
+            AddGarbageCandidate(objects[i]);
         }
     }
 
@@ -313,6 +362,8 @@ void ManagedObjectPool::reset() {
     }
     while (!available_ids.empty()) { available_ids.pop(); }
     nextHandle = 1;
+    gcCandidates.clear();
+    gcInProgress = false;
 }
 
 ManagedObjectPool::ManagedObjectPool() : objectCreationCounter(0), nextHandle(1), available_ids(), objects(RESERVED_SIZE, ManagedObject()), handleByAddress() {
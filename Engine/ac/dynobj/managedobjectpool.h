@@ -25,6 +25,15 @@
 namespace AGS { namespace Common { class Stream; }}
 using namespace AGS; // FIXME later
 
+// Managed object pool and garbage collection counters
+struct ManagedObjectPoolStats {
+    uint32_t objects = 0;           // objects currently in the pool
+    uint64_t collections = 0;       // garbage collections started
+    uint64_t collected = 0;         // objects disposed by the collector
+    uint64_t pauseTotalUs = 0;      // total time spent collecting, in microseconds
+    uint64_t pauseMaxUs = 0;        // longest single collection step
+};
+
 struct ManagedObjectPool final {
 private:
     // TODO: find out if we can make handle size_t
@@ -36,16 +45,23 @@ private:
         const char *addr;
         ICCDynamicObject *callback;
         int refCount;
+        bool gcCandidate; // is listed in the collector's candidates
 
         bool isUsed() const { return obj_type != kScValUndefined; }
 
         ManagedObject() 
-            : obj_type(kScValUndefined), handle(0), addr(nullptr), callback(nullptr), refCount(0) {}
+            : obj_type(kScValUndefined), handle(0), addr(nullptr), callback(nullptr), refCount(0), gcCandidate(false) {}
         ManagedObject(ScriptValueType obj_type, int32_t handle, const char *addr, ICCDynamicObject * callback) 
-            : obj_type(obj_type), handle(handle), addr(addr), callback(callback), refCount(0) {}
+            : obj_type(obj_type), handle(handle), addr(addr), callback(callback), refCount(0), gcCandidate(false) {}
     };
 
     int objectCreationCounter;  // used to do garbage collection every so often
+    // Handles of the objects which had zero refcount at some point since
+    // they were last checked; the collector only looks at these.
+    // May contain handles of already removed objects.
+    std::vector<int32_t> gcCandidates;
+    bool gcInProgress {false};  // collection is split across several steps
+    ManagedObjectPoolStats stats;
 
     int32_t nextHandle {}; // TODO: manage nextHandle's going over INT32_MAX !
     std::queue<int32_t> available_ids;
@@ -54,8 +70,13 @@ private:
 
     void Init(int32_t theHandle, const char *theAddress, ICCDynamicObject *theCallback, ScriptValueType objType);
     int Remove(ManagedObject &o, bool force = false); 
+    void AddGarbageCandidate(ManagedObject &o);
 
+    // Disposes all the unreferenced objects
     void RunGarbageCollection();
+    // Checks up to the given number of candidates, disposing the unreferenced
+    // objects; returns true if no candidates are left
+    bool RunGarbageCollectionStep(size_t max_checks);
 
 public:
 
@@ -74,6 +95,8 @@ public:
     void reset();
     ManagedObjectPool();
 
+    const ManagedObjectPoolStats &GetStats() const { return stats; }
+
     const char* disableDisposeForObject {nullptr};
 };
 
@@ -14,17 +14,45 @@
 
 #include "ac/dynobj/scriptstring.h"
 #include "ac/string.h"
+#include "util/string_types.h"
 #include <stdlib.h>
 #include <string.h>
+#include <unordered_map>
+
+// Key of the interned strings table, refers to the interned object's text
+struct InternKey {
+    const char *Text;
+    size_t Length;
+    uint32_t Hash;
+
+    bool operator==(const InternKey &other) const {
+        return Hash == other.Hash && Length == other.Length &&
+            memcmp(Text, other.Text, Length) == 0;
+    }
+};
+
+struct InternKeyHash {
+    size_t operator()(const InternKey &key) const { return key.Hash; }
+};
+
+// Live string objects created from the script literals and translations;
+// the object is removed from the table when it is disposed
+static std::unordered_map<InternKey, ScriptString*, InternKeyHash> InternedStrings;
+
 
 DynObjectRef ScriptString::CreateString(const char *fromText) {
-    return CreateNewScriptStringObj(fromText);
+    return CreateInternedScriptStringObj(fromText);
 }
 
 int ScriptString::Dispose(const char *address, bool force) {
     // always dispose
     if (text) {
-        free(text);
+        if (_interned) {
+            auto it = InternedStrings.find(InternKey{ text, GetLength(text), GetHash(text) });
+            if (it != InternedStrings.end() && it->second == this)
+                InternedStrings.erase(it);
+        }
+        FreeText(text);
         text = nullptr;
     }
     delete this;
@@ -40,9 +68,9 @@ int ScriptString::Serialize(const char *address, char *buffer, int bufsize) {
     
     auto toSerialize = text ? text : "";
     
-    auto len = strlen(toSerialize);
+    auto len = text ? GetLength(text) : 0;
     SerializeInt(len);
-    strcpy(&serbuffer[bytesSoFar], toSerialize);
+    memcpy(&serbuffer[bytesSoFar], toSerialize, len + 1);
     bytesSoFar += len + 1;
     
     return EndSerialize();
@@ -51,8 +79,9 @@ int ScriptString::Serialize(const char *address, char *buffer, int bufsize) {
 void ScriptString::Unserialize(int index, const char *serializedData, int dataSize) {
     StartUnserialize(serializedData, dataSize);
     int textsize = UnserializeInt();
-    text = (char*)malloc(textsize + 1);
-    strcpy(text, &serializedData[bytesSoFar]);
+    char *new_text = AllocText(textsize);
+    strcpy(new_text, &serializedData[bytesSoFar]);
+    SetText(new_text, strlen(new_text));
     ccRegisterUnserializedObject(index, text, this);
 }
 
@@ -60,7 +89,57 @@ ScriptString::ScriptString() {
     text = nullptr;
 }
 
-ScriptString::ScriptString(const char *fromText) {
-    text = (char*)malloc(strlen(fromText) + 1);
-    strcpy(text, fromText);
+ScriptString::ScriptString(const char *fromText)
+    : ScriptString(fromText, strlen(fromText)) {
+}
+
+ScriptString::ScriptString(const char *fromText, size_t length) {
+    text = nullptr;
+    char *new_text = AllocText(length);
+    memcpy(new_text, fromText, length);
+    new_text[length] = 0;
+    SetText(new_text, length);
+}
+
+char *ScriptString::AllocText(size_t length) {
+    Header *header = (Header*)ccAllocManagedData(sizeof(Header) + length + 1);
+    header->Length = 0;
+    header->Hash = 0;
+    return (char*)(header + 1);
+}
+
+void ScriptString::FreeText(char *text) {
+    if (text)
+        ccFreeManagedData(GetHeader(text));
+}
+
+void ScriptString::SetText(char *new_text, size_t length) {
+    text = new_text;
+    Header *header = GetHeader(text);
+    header->Length = (uint32_t)length;
+    header->Hash = 0;
+}
+
+uint32_t ScriptString::GetHash(const char *text) {
+    Header *header = GetHeader(text);
+    if (header->Hash == 0)
+        header->Hash = CalcHash(text, header->Length);
+    return header->Hash;
+}
+
+uint32_t ScriptString::CalcHash(const char *text, size_t length) {
+    const uint32_t hash = FNV::Hash1a(text, length);
+    return hash != 0 ? hash : 1; // 0 means "not calculated"
+}
+
+ScriptString *ScriptString::FindInterned(const char *text, size_t length, uint32_t hash) {
+    auto it = InternedStrings.find(InternKey{ text, length, hash });
+    return it != InternedStrings.end() ? it->second : nullptr;
+}
+
+void ScriptString::Intern() {
+    if (_interned || !text)
+        return;
+    InternedStrings[InternKey{ text, GetLength(text), GetHash(text) }] = this;
+    _interned = true;
 }
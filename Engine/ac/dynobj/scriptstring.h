@@ -18,6 +18,13 @@
 #include "ac/dynobj/cc_agsdynamicobject.h"
 
 struct ScriptString final : AGSCCDynamicObject, ICCStringClass {
+    // The text of a managed string is preceded by this header, allocated
+    // in the same buffer; the script only sees the text pointer.
+    struct Header {
+        uint32_t Length;
+        uint32_t Hash; // 0 if not calculated yet
+    };
+
     char *text;
 
     int Dispose(const char *address, bool force) override;
@@ -25,10 +32,37 @@ struct ScriptString final : AGSCCDynamicObject, ICCStringClass {
     int Serialize(const char *address, char *buffer, int bufsize) override;
     void Unserialize(int index, const char *serializedData, int dataSize) override;
 
+    // Creates string from the literal or old-style string; returns existing
+    // string object with the same text if there's one
     DynObjectRef CreateString(const char *fromText) override;
 
     ScriptString();
     ScriptString(const char *fromText);
+    ScriptString(const char *fromText, size_t length);
+
+    // Allocates text buffer for the string of the given length, not counting
+    // null terminator; the length is recorded by the string's constructor
+    static char *AllocText(size_t length);
+    static void FreeText(char *text);
+    // Takes ownership of the text buffer made by AllocText
+    void SetText(char *new_text, size_t length);
+    // Gets length of the managed string's text; the text must belong to
+    // a ScriptString object (e.g. "self" of the String's methods)
+    static size_t GetLength(const char *text) { return GetHeader(text)->Length; }
+    // Gets hash of the managed string's text, calculating it on first request
+    static uint32_t GetHash(const char *text);
+    // Calculates hash of an arbitrary text
+    static uint32_t CalcHash(const char *text, size_t length);
+
+    // Finds live interned string object with the given text
+    static ScriptString *FindInterned(const char *text, size_t length, uint32_t hash);
+    // Registers this string object as the one to return for its text
+    void Intern();
+
+private:
+    static Header *GetHeader(const char *text) { return (Header*)text - 1; }
+
+    bool _interned = false;
 };
 
-#endif // __AC_SCRIPTSTRING_H
\ No newline at end of file
+#endif // __AC_SCRIPTSTRING_H
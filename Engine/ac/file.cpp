@@ -24,6 +24,7 @@
 #include "ac/path_helper.h"
 #include "ac/runtime_defines.h"
 #include "ac/string.h"
+#include "ac/dynobj/scriptstring.h"
 #include "debug/debug_log.h"
 #include "debug/debugger.h"
 #include "util/misc.h"
@@ -153,8 +154,9 @@ const char* File_ReadStringBack(sc_File *fil) {
   if ((lle >= 20000) || (lle < 1))
     quit("!File.ReadStringBack: file was not written by WriteString");
 
-  char *retVal = (char*)malloc(lle);
+  char *retVal = ScriptString::AllocText(lle);
   in->Read(retVal, lle);
+  retVal[lle] = 0;
 
   return CreateNewScriptString(retVal, false);
 }
@@ -604,7 +606,6 @@ WithAssetLibrary::~WithAssetLibrary()
 #include "debug/out.h"
 #include "script/script_api.h"
 #include "script/script_runtime.h"
-#include "ac/dynobj/scriptstring.h"
 
 extern ScriptString myScriptStringImpl;
 
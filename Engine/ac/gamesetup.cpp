@@ -41,6 +41,10 @@ GameSetup::GameSetup()
     mouse_speed_def = kMouseSpeed_CurrentDisplay;
     RenderAtScreenRes = false;
     Supersampling = 1;
+    RenderThreads = 1;
+    BatchPathfinding = false;
+    Unthrottled = false;
+    FrameDumpInterval = 0;
 
     Screen.DisplayMode.ScreenSize.MatchDeviceRatio = true;
     Screen.DisplayMode.ScreenSize.SizeDef = kScreenDef_MaxDisplay;
@@ -72,6 +72,11 @@ struct GameSetup {
     MouseSpeedDef mouse_speed_def;
     bool  RenderAtScreenRes; // render sprites at screen resolution, as opposed to native one
     int   Supersampling;
+    int   RenderThreads; // number of threads the software renderer draws on, 0 for one per core
+    bool  BatchPathfinding; // search routes of the characters' automatic walks together
+    bool  Unthrottled; // run the game loop without waiting for the next frame
+    int   FrameDumpInterval; // save every Nth frame, 0 for none; offscreen renderer only
+    String FrameDumpDir;
 
     ScreenSetup Screen;
 
@@ -26,7 +26,7 @@
 #include "ac/movelist.h"
 #include "ac/properties.h"
 #include "ac/sys_events.h"
-#include "ac/tree_map.h"
+#include "ac/translation_table.h"
 #include "ac/walkablearea.h"
 #include "gfx/gfxfilter.h"
 #include "gui/guidialog.h"
@@ -50,7 +50,7 @@ extern CharacterInfo*playerchar;
 
 extern IGraphicsDriver *gfxDriver;
 extern SpriteCache spriteset;
-extern TreeMap *transtree;
+extern TranslationTable *transtable;
 extern int displayed_room, starting_room;
 extern MoveList *mls;
 extern char transFileName[MAX_PATH];
@@ -75,7 +75,7 @@ String GetRuntimeInfo()
         runtimeInfo.Append("[AUDIO.VOX enabled");
     if (play.want_speech >= 1)
         runtimeInfo.Append("[SPEECH.VOX enabled");
-    if (transtree != nullptr) {
+    if (transtable != nullptr) {
         runtimeInfo.Append("[Using translation ");
         runtimeInfo.Append(transFileName);
     }
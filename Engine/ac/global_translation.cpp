@@ -18,7 +18,7 @@
 #include "ac/gamestate.h"
 #include "ac/global_translation.h"
 #include "ac/string.h"
-#include "ac/tree_map.h"
+#include "ac/translation_table.h"
 #include "platform/base/agsplatformdriver.h"
 #include "plugin/agsplugin.h"
 #include "plugin/plugin_engine.h"
@@ -29,7 +29,7 @@ using namespace AGS::Common::Memory;
 
 extern GameState play;
 extern AGSPlatformDriver *platform;
-extern TreeMap *transtree;
+extern TranslationTable *transtable;
 extern char transFileName[MAX_PATH];
 
 const char *get_translation (const char *text) {
@@ -47,9 +47,9 @@ const char *get_translation (const char *text) {
     }
 #endif
 
-    if (transtree != nullptr) {
+    if (transtable != nullptr) {
         // translate the text using the translation file
-        char * transl = transtree->findValue (text);
+        const char *transl = transtable->Find(text);
         if (transl != nullptr)
             return transl;
     }
@@ -58,7 +58,7 @@ const char *get_translation (const char *text) {
 }
 
 int IsTranslationAvailable () {
-    if (transtree != nullptr)
+    if (transtable != nullptr)
         return 1;
     return 0;
 }
@@ -586,6 +586,7 @@ void recreate_guibg_image(GUIMain *tehgui)
     gfxDriver->DestroyDDB(guibgbmp[ifn]);
     guibgbmp[ifn] = nullptr;
   }
+  tehgui->MarkChanged();
 }
 
 extern int is_complete_overlay;
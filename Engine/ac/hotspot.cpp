@@ -80,7 +80,7 @@ void Hotspot_GetName(ScriptHotspot *hss, char *buffer) {
 }
 
 const char* Hotspot_GetName_New(ScriptHotspot *hss) {
-    return CreateNewScriptString(get_translation(thisroom.Hotspots[hss->id].Name.GetCStr()));
+    return CreateInternedScriptString(get_translation(thisroom.Hotspots[hss->id].Name.GetCStr()));
 }
 
 bool Hotspot_IsInteractionAvailable(ScriptHotspot *hhot, int mood) {
@@ -67,7 +67,7 @@ void InventoryItem_GetName(ScriptInvItem *iitem, char *buff) {
 }
 
 const char* InventoryItem_GetName_New(ScriptInvItem *invitem) {
-  return CreateNewScriptString(get_translation(game.invinfo[invitem->id].name));
+  return CreateInternedScriptString(get_translation(game.invinfo[invitem->id].name));
 }
 
 int InventoryItem_GetGraphic(ScriptInvItem *iitem) {
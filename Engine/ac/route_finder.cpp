@@ -27,11 +27,13 @@ class IRouteFinder
     virtual void init_pathfinder() = 0;
     virtual void shutdown_pathfinder() = 0;
     virtual void set_wallscreen(Bitmap *wallscreen) = 0;
+    virtual void set_walkable_areas(Bitmap *walkareas) = 0;
     virtual int can_see_from(int x1, int y1, int x2, int y2) = 0;
     virtual void get_lastcpos(int &lastcx, int &lastcy) = 0;
     virtual void set_route_move_speed(int speed_x, int speed_y) = 0;
     virtual int find_route(short srcx, short srcy, short xx, short yy, Bitmap *onscreen, int movlst, int nocross = 0, int ignore_walls = 0) = 0;
     virtual void calculate_move_stage(MoveList * mlsp, int aaa) = 0;
+    virtual void find_routes(RouteRequest *reqs, size_t count) = 0;
 };
 
 class AGSRouteFinder : public IRouteFinder 
@@ -49,6 +51,10 @@ class AGSRouteFinder : public IRouteFinder
     { 
         AGS::Engine::RouteFinder::set_wallscreen(wallscreen);
     }
+    void set_walkable_areas(Bitmap *walkareas) override
+    {
+        AGS::Engine::RouteFinder::set_walkable_areas(walkareas);
+    }
     int can_see_from(int x1, int y1, int x2, int y2) override
     { 
         return AGS::Engine::RouteFinder::can_see_from(x1, y1, x2, y2); 
@@ -69,6 +75,10 @@ class AGSRouteFinder : public IRouteFinder
     { 
         AGS::Engine::RouteFinder::calculate_move_stage(mlsp, aaa); 
     }
+    void find_routes(RouteRequest *reqs, size_t count) override
+    {
+        AGS::Engine::RouteFinder::find_routes(reqs, count);
+    }
 };
 
 class AGSLegacyRouteFinder : public IRouteFinder 
@@ -86,6 +96,10 @@ class AGSLegacyRouteFinder : public IRouteFinder
     { 
         AGS::Engine::RouteFinderLegacy::set_wallscreen(wallscreen); 
     }
+    void set_walkable_areas(Bitmap *walkareas) override
+    {
+        // legacy finder does not use the walkable areas
+    }
     int can_see_from(int x1, int y1, int x2, int y2) override
     { 
         return AGS::Engine::RouteFinderLegacy::can_see_from(x1, y1, x2, y2); 
@@ -106,6 +120,17 @@ class AGSLegacyRouteFinder : public IRouteFinder
     { 
         AGS::Engine::RouteFinderLegacy::calculate_move_stage(mlsp, aaa); 
     }
+    void find_routes(RouteRequest *reqs, size_t count) override
+    {
+        // legacy finder keeps its state in globals, so search one by one
+        for (size_t i = 0; i < count; ++i)
+        {
+            RouteRequest &req = reqs[i];
+            AGS::Engine::RouteFinderLegacy::set_route_move_speed(req.MoveSpeedX, req.MoveSpeedY);
+            req.Result = AGS::Engine::RouteFinderLegacy::find_route(req.SrcX, req.SrcY, req.DstX, req.DstY,
+                req.Mask.get(), req.MoveList, req.NoCross, req.IgnoreWalls);
+        }
+    }
 };
 
 static IRouteFinder *route_finder_impl = nullptr;
@@ -136,6 +161,11 @@ void set_wallscreen(Bitmap *wallscreen)
     route_finder_impl->set_wallscreen(wallscreen);
 }
 
+void set_walkable_areas(Bitmap *walkareas)
+{
+    route_finder_impl->set_walkable_areas(walkareas);
+}
+
 int can_see_from(int x1, int y1, int x2, int y2)
 {
     return route_finder_impl->can_see_from(x1, y1, x2, y2);
@@ -160,3 +190,8 @@ void calculate_move_stage(MoveList * mlsp, int aaa)
 {
     route_finder_impl->calculate_move_stage(mlsp, aaa);
 }
+
+void find_routes(RouteRequest *reqs, size_t count)
+{
+    route_finder_impl->find_routes(reqs, count);
+}
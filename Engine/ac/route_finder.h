@@ -15,16 +15,36 @@
 #ifndef __AC_ROUTEFND_H
 #define __AC_ROUTEFND_H
 
+#include <memory>
 #include "ac/game_version.h"
 
 // Forward declaration
 namespace AGS { namespace Common { class Bitmap; }}
 struct MoveList;
 
+// Route search request for the batch search
+struct RouteRequest
+{
+    short SrcX, SrcY;
+    short DstX, DstY;
+    int   MoveSpeedX, MoveSpeedY;
+    int   MoveList;
+    int   NoCross;
+    int   IgnoreWalls;
+    // walkable mask to search on; batch searches may run on several threads
+    // at once, so each request should have its own copy
+    std::shared_ptr<AGS::Common::Bitmap> Mask;
+    int   Result; // move list index, or 0 if there's no route
+};
+
 void init_pathfinder(GameDataVersion game_file_version);
 void shutdown_pathfinder();
 
 void set_wallscreen(AGS::Common::Bitmap *wallscreen);
+// Sets the room's walkable areas without the blocking characters and objects;
+// must be called whenever they change. The masks passed to the route search
+// should have the same walkable pixels, or less of them.
+void set_walkable_areas(AGS::Common::Bitmap *walkareas);
 
 int can_see_from(int x1, int y1, int x2, int y2);
 void get_lastcpos(int &lastcx, int &lastcy);
@@ -33,5 +53,8 @@ void set_route_move_speed(int speed_x, int speed_y);
 
 int find_route(short srcx, short srcy, short xx, short yy, AGS::Common::Bitmap *onscreen, int movlst, int nocross = 0, int ignore_walls = 0);
 void calculate_move_stage(MoveList * mlsp, int aaa);
+// Searches for the requested routes and fills their move lists, using the
+// move speeds of the requests
+void find_routes(RouteRequest *reqs, size_t count);
 
 #endif // __AC_ROUTEFND_H
\ No newline at end of file
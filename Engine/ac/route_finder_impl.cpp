@@ -20,18 +20,22 @@
 
 #include <string.h>
 #include <math.h>
+#include <memory>
 
 #include "ac/common.h"   // quit()
 #include "ac/movelist.h"     // MoveList
+#include "ac/route_finder.h" // RouteRequest
 #include "ac/common_defines.h"
 #include "gfx/bitmap.h"
 #include "debug/out.h"
+#include "util/workerpool.h"
 
 #include "route_finder_jps.inl"
 
 extern MoveList *mls;
 
 using AGS::Common::Bitmap;
+using AGS::Common::WorkerPool;
 
 // #define DEBUG_PATHFINDER
 
@@ -42,12 +46,26 @@ namespace RouteFinder {
 #define MAKE_INTCOORD(x,y) (((unsigned short)x << 16) | ((unsigned short)y))
 
 static const int MAXNAVPOINTS = MAXNEEDSTAGES;
-static int navpoints[MAXNAVPOINTS];
-static int num_navpoints;
+
+// Route search state; the batch searches run on several threads at once,
+// each with its own state
+struct RouteSearch
+{
+  Navigation nav;
+  std::vector<int> path, cpath;
+  int navpoints[MAXNAVPOINTS];
+  int num_navpoints;
+
+  RouteSearch() : num_navpoints(0) {}
+};
+
 static fixed move_speed_x, move_speed_y;
-static Navigation nav;
+static RouteSearch search;
+static std::vector<std::unique_ptr<RouteSearch>> batch_search;
 static Bitmap *wallscreen;
 static int lastcx, lastcy;
+// connected areas of the room's walkable mask, shared by all the searches
+static NavAreas nav_areas;
 
 void init_pathfinder()
 {
@@ -55,6 +73,8 @@ void init_pathfinder()
 
 void shutdown_pathfinder()
 {
+  batch_search.clear();
+  nav_areas = NavAreas();
 }
 
 void set_wallscreen(Bitmap *wallscreen_) 
@@ -62,26 +82,39 @@ void set_wallscreen(Bitmap *wallscreen_)
   wallscreen = wallscreen_;
 }
 
-static void sync_nav_wallscreen()
+void set_walkable_areas(Bitmap *walkareas)
+{
+  nav_areas.Resize(walkareas->GetWidth(), walkareas->GetHeight());
+  for (int y = 0; y < walkareas->GetHeight(); y++)
+    nav_areas.SetMapRow(y, walkareas->GetScanLine(y));
+  nav_areas.Build();
+}
+
+static void sync_nav_wallscreen(Navigation &nav, Bitmap *mask)
 {
   // FIXME: this is dumb, but...
-  nav.Resize(wallscreen->GetWidth(), wallscreen->GetHeight());
+  nav.Resize(mask->GetWidth(), mask->GetHeight());
 
-  for (int y=0; y<wallscreen->GetHeight(); y++)
-    nav.SetMapRow(y, wallscreen->GetScanLine(y));
+  for (int y=0; y<mask->GetHeight(); y++)
+    nav.SetMapRow(y, mask->GetScanLine(y));
 }
 
-int can_see_from(int x1, int y1, int x2, int y2)
+static int can_see_from(RouteSearch &rs, Bitmap *mask, int x1, int y1, int x2, int y2, int &lastx, int &lasty)
 {
-  lastcx = x1;
-  lastcy = y1;
+  lastx = x1;
+  lasty = y1;
 
   if ((x1 == x2) && (y1 == y2))
     return 1;
 
-  sync_nav_wallscreen();
+  sync_nav_wallscreen(rs.nav, mask);
+
+  return !rs.nav.TraceLine(x1, y1, x2, y2, lastx, lasty);
+}
 
-  return !nav.TraceLine(x1, y1, x2, y2, lastcx, lastcy);
+int can_see_from(int x1, int y1, int x2, int y2)
+{
+  return can_see_from(search, wallscreen, x1, y1, x2, y2, lastcx, lastcy);
 }
 
 void get_lastcpos(int &lastcx_, int &lastcy_) 
@@ -91,18 +124,20 @@ void get_lastcpos(int &lastcx_, int &lastcy_)
 }
 
 // new routing using JPS
-static int find_route_jps(int fromx, int fromy, int destx, int desty)
+static int find_route_jps(RouteSearch &rs, Bitmap *mask, int fromx, int fromy, int destx, int desty)
 {
-  sync_nav_wallscreen();
+  sync_nav_wallscreen(rs.nav, mask);
+  rs.nav.SetAreas(&nav_areas);
 
-  static std::vector<int> path, cpath;
+  std::vector<int> &path = rs.path;
+  std::vector<int> &cpath = rs.cpath;
   path.clear();
   cpath.clear();
 
-  if (nav.NavigateRefined(fromx, fromy, destx, desty, path, cpath) == Navigation::NAV_UNREACHABLE)
+  if (rs.nav.NavigateRefined(fromx, fromy, destx, desty, path, cpath) == Navigation::NAV_UNREACHABLE)
     return 0;
 
-  num_navpoints = 0;
+  rs.num_navpoints = 0;
 
   // new behavior: cut path if too complex rather than abort with error message
   int count = std::min<int>((int)cpath.size(), MAXNAVPOINTS);
@@ -110,35 +145,31 @@ static int find_route_jps(int fromx, int fromy, int destx, int desty)
   for (int i = 0; i<count; i++)
   {
     int x, y;
-    nav.UnpackSquare(cpath[i], x, y);
+    rs.nav.UnpackSquare(cpath[i], x, y);
 
-    navpoints[num_navpoints++] = MAKE_INTCOORD(x, y);
+    rs.navpoints[rs.num_navpoints++] = MAKE_INTCOORD(x, y);
   }
 
   return 1;
 }
 
-void set_route_move_speed(int speed_x, int speed_y)
+static fixed get_move_speed(int speed)
 {
   // negative move speeds like -2 get converted to 1/2
-  if (speed_x < 0) {
-    move_speed_x = itofix(1) / (-speed_x);
-  }
-  else {
-    move_speed_x = itofix(speed_x);
-  }
+  if (speed < 0)
+    return itofix(1) / (-speed);
+  return itofix(speed);
+}
 
-  if (speed_y < 0) {
-    move_speed_y = itofix(1) / (-speed_y);
-  }
-  else {
-    move_speed_y = itofix(speed_y);
-  }
+void set_route_move_speed(int speed_x, int speed_y)
+{
+  move_speed_x = get_move_speed(speed_x);
+  move_speed_y = get_move_speed(speed_y);
 }
 
 // Calculates the X and Y per game loop, for this stage of the
 // movelist
-void calculate_move_stage(MoveList * mlsp, int aaa)
+static void calculate_move_stage(MoveList * mlsp, int aaa, fixed speed_x, fixed speed_y)
 {
   // work out the x & y per move. First, opp/adj=tan, so work out the angle
   if (mlsp->pos[aaa] == mlsp->pos[aaa + 1]) {
@@ -155,7 +186,7 @@ void calculate_move_stage(MoveList * mlsp, int aaa)
   // Special case for vertical and horizontal movements
   if (ourx == destx) {
     mlsp->xpermove[aaa] = 0;
-    mlsp->ypermove[aaa] = move_speed_y;
+    mlsp->ypermove[aaa] = speed_y;
     if (desty < oury)
       mlsp->ypermove[aaa] = -mlsp->ypermove[aaa];
 
@@ -163,7 +194,7 @@ void calculate_move_stage(MoveList * mlsp, int aaa)
   }
 
   if (oury == desty) {
-    mlsp->xpermove[aaa] = move_speed_x;
+    mlsp->xpermove[aaa] = speed_x;
     mlsp->ypermove[aaa] = 0;
     if (destx < ourx)
       mlsp->xpermove[aaa] = -mlsp->xpermove[aaa];
@@ -176,21 +207,21 @@ void calculate_move_stage(MoveList * mlsp, int aaa)
 
   fixed useMoveSpeed;
 
-  if (move_speed_x == move_speed_y) {
-    useMoveSpeed = move_speed_x;
+  if (speed_x == speed_y) {
+    useMoveSpeed = speed_x;
   }
   else {
     // different X and Y move speeds
     // the X proportion of the movement is (x / (x + y))
     fixed xproportion = fixdiv(xdist, (xdist + ydist));
 
-    if (move_speed_x > move_speed_y) {
+    if (speed_x > speed_y) {
       // speed = y + ((1 - xproportion) * (x - y))
-      useMoveSpeed = move_speed_y + fixmul(xproportion, move_speed_x - move_speed_y);
+      useMoveSpeed = speed_y + fixmul(xproportion, speed_x - speed_y);
     }
     else {
       // speed = x + (xproportion * (y - x))
-      useMoveSpeed = move_speed_x + fixmul(itofix(1) - xproportion, move_speed_y - move_speed_x);
+      useMoveSpeed = speed_x + fixmul(itofix(1) - xproportion, speed_y - speed_x);
     }
   }
 
@@ -213,25 +244,30 @@ void calculate_move_stage(MoveList * mlsp, int aaa)
   mlsp->ypermove[aaa] = newymove;
 }
 
+void calculate_move_stage(MoveList * mlsp, int aaa)
+{
+  calculate_move_stage(mlsp, aaa, move_speed_x, move_speed_y);
+}
 
-int find_route(short srcx, short srcy, short xx, short yy, Bitmap *onscreen, int movlst, int nocross, int ignore_walls)
+static int find_route(RouteSearch &rs, short srcx, short srcy, short xx, short yy, Bitmap *mask, int movlst, int nocross, int ignore_walls,
+  fixed speed_x, fixed speed_y, int &lastx, int &lasty)
 {
   int i;
-
-  wallscreen = onscreen;
+  int &num_navpoints = rs.num_navpoints;
+  int *navpoints = rs.navpoints;
 
   num_navpoints = 0;
 
-  if (ignore_walls || can_see_from(srcx, srcy, xx, yy))
+  if (ignore_walls || can_see_from(rs, mask, srcx, srcy, xx, yy, lastx, lasty))
   {
     num_navpoints = 2;
     navpoints[0] = MAKE_INTCOORD(srcx, srcy);
     navpoints[1] = MAKE_INTCOORD(xx, yy);
   } else {
-    if ((nocross == 0) && (wallscreen->GetPixel(xx, yy) == 0))
+    if ((nocross == 0) && (mask->GetPixel(xx, yy) == 0))
       return 0; // clicked on a wall
 
-    find_route_jps(srcx, srcy, xx, yy);
+    find_route_jps(rs, mask, srcx, srcy, xx, yy);
   }
 
   if (!num_navpoints)
@@ -255,7 +291,7 @@ int find_route(short srcx, short srcy, short xx, short yy, Bitmap *onscreen, int
 #endif
 
   for (i=0; i<num_navpoints-1; i++)
-    calculate_move_stage(&mls[mlist], i);
+    calculate_move_stage(&mls[mlist], i, speed_x, speed_y);
 
   mls[mlist].fromx = srcx;
   mls[mlist].fromy = srcy;
@@ -267,6 +303,31 @@ int find_route(short srcx, short srcy, short xx, short yy, Bitmap *onscreen, int
   return mlist;
 }
 
+int find_route(short srcx, short srcy, short xx, short yy, Bitmap *onscreen, int movlst, int nocross, int ignore_walls)
+{
+  wallscreen = onscreen;
+  return find_route(search, srcx, srcy, xx, yy, onscreen, movlst, nocross, ignore_walls,
+    move_speed_x, move_speed_y, lastcx, lastcy);
+}
+
+void find_routes(RouteRequest *reqs, size_t count)
+{
+  WorkerPool &pool = WorkerPool::GetShared();
+  while (batch_search.size() < pool.GetThreadCount())
+    batch_search.push_back(std::unique_ptr<RouteSearch>(new RouteSearch()));
+
+  // each request has its own mask and move list, so the result does not
+  // depend on which thread did the search
+  pool.RunBatch(count, [reqs](size_t job, size_t thread)
+  {
+    RouteRequest &req = reqs[job];
+    int lastx, lasty;
+    req.Result = find_route(*batch_search[thread], req.SrcX, req.SrcY, req.DstX, req.DstY, req.Mask.get(),
+      req.MoveList, req.NoCross, req.IgnoreWalls,
+      get_move_speed(req.MoveSpeedX), get_move_speed(req.MoveSpeedY), lastx, lasty);
+  });
+}
+
 
 } // namespace RouteFinder
 } // namespace Engine
@@ -15,11 +15,13 @@
 #ifndef __AC_ROUTE_FINDER_IMPL
 #define __AC_ROUTE_FINDER_IMPL
 
+#include <stddef.h>
 #include "ac/game_version.h"
 
 // Forward declaration
 namespace AGS { namespace Common { class Bitmap; }}
 struct MoveList;
+struct RouteRequest;
 
 namespace AGS {
 namespace Engine {
@@ -29,6 +31,7 @@ void init_pathfinder();
 void shutdown_pathfinder();
 
 void set_wallscreen(AGS::Common::Bitmap *wallscreen);
+void set_walkable_areas(AGS::Common::Bitmap *walkareas);
 
 int can_see_from(int x1, int y1, int x2, int y2);
 void get_lastcpos(int &lastcx, int &lastcy);
@@ -37,6 +40,8 @@ void set_route_move_speed(int speed_x, int speed_y);
 
 int find_route(short srcx, short srcy, short xx, short yy, AGS::Common::Bitmap *onscreen, int movlst, int nocross = 0, int ignore_walls = 0);
 void calculate_move_stage(MoveList * mlsp, int aaa);
+// Searches for the routes in parallel, using the shared worker pool
+void find_routes(RouteRequest *reqs, size_t count);
 
 } // namespace RouteFinder
 } // namespace Engine
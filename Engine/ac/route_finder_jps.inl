@@ -30,6 +30,44 @@
 // further optimizations possible:
 //    - forward refinement should use binary search
 
+// connected walkable areas of the room's base map; blocking characters and
+// objects may only remove nodes from it, so the nodes which are in different
+// areas here are never connected on the map used for the search
+class NavAreas
+{
+public:
+	NavAreas();
+
+	void Resize(int width, int height);
+	inline void SetMapRow(int y, const unsigned char *row) {map[y] = row;}
+	// finds the areas of the map rows which were set
+	void Build();
+
+	inline int GetWidth() const {return mapWidth;}
+	inline int GetHeight() const {return mapHeight;}
+	// area index of the node, -1 for the walls
+	inline int GetArea(int x, int y) const {return areaIds[y*mapWidth+x];}
+	// edge nodes of the area, which are next to a wall or the map border;
+	// the node closest to any point outside of the area is one of them
+	inline const int *EdgeBegin(int area) const {return edges.data() + edgeStart[area];}
+	inline const int *EdgeEnd(int area) const {return edges.data() + edgeStart[area+1];}
+
+private:
+	bool IsEdge(int x, int y) const;
+
+	int mapWidth;
+	int mapHeight;
+	std::vector<const unsigned char *> map;
+
+	// area index of each node, -1 for the walls
+	std::vector<int> areaIds;
+	// packed edge nodes, grouped by area
+	std::vector<int> edges;
+	// index of the first edge node of each area, and the total in the end
+	std::vector<int> edgeStart;
+	std::vector<int> stack;
+};
+
 class Navigation
 {
 public:
@@ -58,6 +96,9 @@ public:
 	bool TraceLine(int srcx, int srcy, int targx, int targy, std::vector<int> *rpath = nullptr) const;
 
 	inline void SetMapRow(int y, const unsigned char *row) {map[y] = row;}
+	// sets the areas of the base map, which the map must be a subset of;
+	// used to reject the unreachable targets without a search
+	inline void SetAreas(const NavAreas *navAreas) {areas = navAreas;}
 
 	inline static int PackSquare(int x, int y);
 	inline static void UnpackSquare(int sq, int &x, int &y);
@@ -118,6 +159,8 @@ private:
 	std::vector<NodeInfo> mapNodes;
 	tFrameId frameId;
 
+	const NavAreas *areas;
+
 	std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > pq;
 
 	// temporary buffers:
@@ -136,6 +179,11 @@ private:
 
 	void IncFrameId();
 
+	// finds the walkable edge node of the area which is closest to the target
+	int FindClosestOnAreaEdge(int area, int ex, int ey) const;
+	// routes to the node closest to the unreachable target, which is in cnode
+	NavResult NavigateCloser(int sx, int sy, int ex, int ey, std::vector<int> &opath);
+
 	// outside map test
 	inline bool Outside(int x, int y) const;
 	// stronger inside test
@@ -174,6 +222,93 @@ private:
 	}
 };
 
+// NavAreas
+
+NavAreas::NavAreas()
+	: mapWidth(0)
+	, mapHeight(0)
+{
+}
+
+void NavAreas::Resize(int width, int height)
+{
+	mapWidth = width;
+	mapHeight = height;
+	map.resize(mapHeight);
+}
+
+bool NavAreas::IsEdge(int x, int y) const
+{
+	return x == 0 || x == mapWidth-1 || y == 0 || y == mapHeight-1 ||
+		!map[y][x-1] || !map[y][x+1] || !map[y-1][x] || !map[y+1][x];
+}
+
+void NavAreas::Build()
+{
+	areaIds.assign(mapWidth*mapHeight, -1);
+	int numAreas = 0;
+
+	// nodiag moves are only allowed around a passable corner,
+	// so orthogonal neighbors are enough to connect the area
+	for (int index = 0; index < (int)areaIds.size(); index++)
+	{
+		if (areaIds[index] >= 0 || !map[index / mapWidth][index % mapWidth])
+			continue;
+
+		const int id = numAreas++;
+		areaIds[index] = id;
+		stack.push_back(index);
+
+		while (!stack.empty())
+		{
+			const int i = stack.back();
+			stack.pop_back();
+
+			const int x = i % mapWidth;
+			const int y = i / mapWidth;
+
+			const int neig[4] = {
+				x > 0 && map[y][x-1] ? i-1 : -1,
+				x < mapWidth-1 && map[y][x+1] ? i+1 : -1,
+				y > 0 && map[y-1][x] ? i-mapWidth : -1,
+				y < mapHeight-1 && map[y+1][x] ? i+mapWidth : -1
+			};
+
+			for (int n = 0; n < 4; n++)
+			{
+				const int ni = neig[n];
+
+				if (ni < 0 || areaIds[ni] >= 0)
+					continue;
+
+				areaIds[ni] = id;
+				stack.push_back(ni);
+			}
+		}
+	}
+
+	// group the edge nodes by area: count them first, then place
+	edgeStart.assign(numAreas+1, 0);
+
+	for (int y = 0; y < mapHeight; y++)
+		for (int x = 0; x < mapWidth; x++)
+			if (areaIds[y*mapWidth+x] >= 0 && IsEdge(x, y))
+				edgeStart[areaIds[y*mapWidth+x]+1]++;
+
+	for (int i = 0; i < numAreas; i++)
+		edgeStart[i+1] += edgeStart[i];
+
+	edges.resize(edgeStart[numAreas]);
+	stack.assign(edgeStart.begin(), edgeStart.end()-1);
+
+	for (int y = 0; y < mapHeight; y++)
+		for (int x = 0; x < mapWidth; x++)
+			if (areaIds[y*mapWidth+x] >= 0 && IsEdge(x, y))
+				edges[stack[areaIds[y*mapWidth+x]]++] = Navigation::PackSquare(x, y);
+
+	stack.clear();
+}
+
 // Navigation
 
 // scale pack of 2 means we can route up to 32767 units (euclidean distance) from starting point
@@ -185,6 +320,7 @@ Navigation::Navigation()
 	: mapWidth(0)
 	, mapHeight(0)
 	, frameId(1)
+	, areas(nullptr)
 	, cnode(0)
 	, closest(0)
 	// no diagonal route - this should correspond to what AGS does
@@ -215,6 +351,32 @@ void Navigation::IncFrameId()
 	}
 }
 
+int Navigation::FindClosestOnAreaEdge(int area, int ex, int ey) const
+{
+	int best = 0x7fffffff;
+	int bestNode = -1;
+
+	for (const int *edge = areas->EdgeBegin(area); edge != areas->EdgeEnd(area); ++edge)
+	{
+		int x, y;
+		UnpackSquare(*edge, x, y);
+
+		// edge may be covered by a blocker
+		if (!Walkable(x, y))
+			continue;
+
+		const int cost = ClosestDist(x-ex, y-ey);
+
+		if (cost < best)
+		{
+			best = cost;
+			bestNode = *edge;
+		}
+	}
+
+	return bestNode;
+}
+
 inline int Navigation::PackSquare(int x, int y)
 {
 	return (y << 16) + x;
@@ -361,6 +523,38 @@ Navigation::NavResult Navigation::Navigate(int sx, int sy, int ex, int ey, std::
 	if (!TraceLine(sx, sy, ex, ey, &opath))
 		return NAV_STRAIGHT;
 
+	// target outside of the starting area is unreachable, and A* would have
+	// to visit every node of the area before giving up, so pick the node
+	// closest to the target right away
+	if (!navLock && areas && areas->GetWidth() == mapWidth && areas->GetHeight() == mapHeight)
+	{
+		const int area = areas->GetArea(sx, sy);
+
+		if (area >= 0 && (Outside(ex, ey) || areas->GetArea(ex, ey) != area))
+		{
+			cnode = FindClosestOnAreaEdge(area, ex, ey);
+
+			if (cnode >= 0)
+			{
+				opath.clear();
+
+				int nex, ney;
+				UnpackSquare(cnode, nex, ney);
+
+				if (nex == sx && ney == sy)
+					return NAV_UNREACHABLE;
+
+				NavResult res = NavigateCloser(sx, sy, ex, ey, opath);
+
+				if (res != NAV_UNREACHABLE)
+					return res;
+
+				// the blockers cut this node off, so do the full search
+				IncFrameId();
+			}
+		}
+	}
+
 	NodeInfo &ni = mapNodes[sy*mapWidth+sx];
 	ni.dist = 0;
 	ni.frameId = frameId;
@@ -573,52 +767,9 @@ Navigation::NavResult Navigation::Navigate(int sx, int sy, int ex, int ey, std::
 	int nex, ney;
 	UnpackSquare(cnode, nex, ney);
 
-	if ((nex != sx || ney != sy) && (nex != ex || ney != ey))
-	{
-		// target not directly reachable => move closer to target
-		TraceLine(nex, ney, ex, ey, &opath);
-		UnpackSquare(opath.back(), nex, ney);
-
-		NavResult res = NAV_PATH;
-
-		// note: navLock => better safe than sorry
-		// infinite recursion should never happen but... better safe than sorry
-		assert(!navLock);
-
-		if (!navLock)
-		{
-			// and re-route
-			opath.clear();
-
-			navLock = true;
-			res = Navigate(sx, sy, nex, ney, opath);
-			navLock = false;
-		}
-
-		// refine this a bit further; find path point closest
-		// to original target and truncate
-
-		int best = 0x7fffffff;
-		int bestSize = (int)opath.size();
-
-		for (int i=0; i<(int)opath.size(); i++)
-		{
-			int x, y;
-			UnpackSquare(opath[i], x, y);
-			int dx = x-ex, dy = y-ey;
-			int cost = ClosestDist(dx, dy);
-
-			if (cost < best)
-			{
-				best = cost;
-				bestSize = i+1;
-			}
-		}
-
-		opath.resize(bestSize);
-
-		return res;
-	}
+	// the closer target has to be reachable when routing towards it
+	if (!navLock && (nex != sx || ney != sy) && (nex != ex || ney != ey))
+		return NavigateCloser(sx, sy, ex, ey, opath);
 
 	if (ex < 0 || ex >= mapWidth || ey < 0 || ey >= mapHeight ||
 		mapNodes[ey*mapWidth+ex].frameId != frameId)
@@ -657,6 +808,56 @@ Navigation::NavResult Navigation::Navigate(int sx, int sy, int ex, int ey, std::
 	return NAV_PATH;
 }
 
+Navigation::NavResult Navigation::NavigateCloser(int sx, int sy, int ex, int ey,
+	std::vector<int> &opath)
+{
+	// target not directly reachable => move closer to target
+	int nex, ney;
+	UnpackSquare(cnode, nex, ney);
+	TraceLine(nex, ney, ex, ey, &opath);
+	UnpackSquare(opath.back(), nex, ney);
+
+	NavResult res = NAV_PATH;
+
+	// note: navLock => better safe than sorry
+	// infinite recursion should never happen but... better safe than sorry
+	assert(!navLock);
+
+	if (!navLock)
+	{
+		// and re-route
+		opath.clear();
+
+		navLock = true;
+		res = Navigate(sx, sy, nex, ney, opath);
+		navLock = false;
+	}
+
+	// refine this a bit further; find path point closest
+	// to original target and truncate
+
+	int best = 0x7fffffff;
+	int bestSize = (int)opath.size();
+
+	for (int i=0; i<(int)opath.size(); i++)
+	{
+		int x, y;
+		UnpackSquare(opath[i], x, y);
+		int dx = x-ex, dy = y-ey;
+		int cost = ClosestDist(dx, dy);
+
+		if (cost < best)
+		{
+			best = cost;
+			bestSize = i+1;
+		}
+	}
+
+	opath.resize(bestSize);
+
+	return res;
+}
+
 Navigation::NavResult Navigation::NavigateRefined(int sx, int sy, int ex, int ey,
 	std::vector<int> &opath, std::vector<int> &ncpath)
 {
@@ -86,7 +86,8 @@ bool Dict_Contains(ScriptDictBase *dic, const char *key)
 
 const char *Dict_Get(ScriptDictBase *dic, const char *key)
 {
-    return CreateNewScriptString(dic->Get(key));
+    // NOTE: values are often requested repeatedly
+    return CreateInternedScriptString(dic->Get(key));
 }
 
 bool Dict_Remove(ScriptDictBase *dic, const char *key)
@@ -12,6 +12,7 @@
 //
 //=============================================================================
 
+#include <algorithm>
 #include "ac/string.h"
 #include "ac/common.h"
 #include "ac/display.h"
@@ -42,57 +43,119 @@ const char* String_Copy(const char *srcString) {
     return CreateNewScriptString(srcString);
 }
 
-const char* String_Append(const char *thisString, const char *extrabit) {
-    char *buffer = (char*)malloc(strlen(thisString) + strlen(extrabit) + 1);
-    strcpy(buffer, thisString);
-    strcat(buffer, extrabit);
-    return CreateNewScriptString(buffer, false);
+// Following helpers take the length of "this" string, which is known
+// for the managed strings, and has to be measured for the others
+
+static const char* StringImpl_Copy(const char *srcString, size_t len) {
+    char *buffer = ScriptString::AllocText(len);
+    memcpy(buffer, srcString, len + 1);
+    return CreateNewScriptStringFromBuffer(buffer, len);
 }
 
-const char* String_AppendChar(const char *thisString, char extraOne) {
-    char *buffer = (char*)malloc(strlen(thisString) + 2);
-    sprintf(buffer, "%s%c", thisString, extraOne);
-    return CreateNewScriptString(buffer, false);
+static const char* StringImpl_Append(const char *thisString, size_t len, const char *extrabit) {
+    const size_t extra_len = strlen(extrabit);
+    char *buffer = ScriptString::AllocText(len + extra_len);
+    memcpy(buffer, thisString, len);
+    memcpy(buffer + len, extrabit, extra_len + 1);
+    return CreateNewScriptStringFromBuffer(buffer, len + extra_len);
 }
 
-const char* String_ReplaceCharAt(const char *thisString, int index, char newChar) {
-    if ((index < 0) || (index >= (int)strlen(thisString)))
+static const char* StringImpl_AppendChar(const char *thisString, size_t len, char extraOne) {
+    char *buffer = ScriptString::AllocText(len + 1);
+    memcpy(buffer, thisString, len);
+    buffer[len] = extraOne;
+    buffer[len + 1] = 0;
+    // NOTE: appending null character leaves the string as it was
+    return CreateNewScriptStringFromBuffer(buffer, extraOne ? len + 1 : len);
+}
+
+static const char* StringImpl_ReplaceCharAt(const char *thisString, size_t len, int index, char newChar) {
+    if ((index < 0) || (index >= (int)len))
         quit("!String.ReplaceCharAt: index outside range of string");
 
-    char *buffer = (char*)malloc(strlen(thisString) + 1);
-    strcpy(buffer, thisString);
+    char *buffer = ScriptString::AllocText(len);
+    memcpy(buffer, thisString, len + 1);
     buffer[index] = newChar;
-    return CreateNewScriptString(buffer, false);
+    // NOTE: replacing by null character cuts the string
+    return CreateNewScriptStringFromBuffer(buffer, newChar ? len : (size_t)index);
 }
 
-const char* String_Truncate(const char *thisString, int length) {
+static const char* StringImpl_Truncate(const char *thisString, size_t len, int length) {
     if (length < 0)
         quit("!String.Truncate: invalid length");
 
-    if (length >= (int)strlen(thisString))
+    if (length >= (int)len)
     {
         return thisString;
     }
 
-    char *buffer = (char*)malloc(length + 1);
-    strncpy(buffer, thisString, length);
+    char *buffer = ScriptString::AllocText(length);
+    memcpy(buffer, thisString, length);
     buffer[length] = 0;
-    return CreateNewScriptString(buffer, false);
+    return CreateNewScriptStringFromBuffer(buffer, length);
 }
 
-const char* String_Substring(const char *thisString, int index, int length) {
+static const char* StringImpl_Substring(const char *thisString, size_t len, int index, int length) {
     if (length < 0)
         quit("!String.Substring: invalid length");
-    if ((index < 0) || (index > (int)strlen(thisString)))
+    if ((index < 0) || (index > (int)len))
         quit("!String.Substring: invalid index");
 
-    char *buffer = (char*)malloc(length + 1);
-    strncpy(buffer, &thisString[index], length);
-    buffer[length] = 0;
-    return CreateNewScriptString(buffer, false);
+    const size_t copy_len = std::min<size_t>(length, len - index);
+    char *buffer = ScriptString::AllocText(copy_len);
+    memcpy(buffer, &thisString[index], copy_len);
+    buffer[copy_len] = 0;
+    return CreateNewScriptStringFromBuffer(buffer, copy_len);
+}
+
+static int StringImpl_EndsWith(const char *thisString, size_t len, const char *checkForString, bool caseSensitive) {
+
+    int checkAtOffset = (int)len - (int)strlen(checkForString);
+
+    if (checkAtOffset < 0)
+    {
+        return 0;
+    }
+
+    if (caseSensitive) 
+    {
+        return (strcmp(&thisString[checkAtOffset], checkForString) == 0) ? 1 : 0;
+    }
+    else 
+    {
+        return (ags_stricmp(&thisString[checkAtOffset], checkForString) == 0) ? 1 : 0;
+    }
+}
+
+static int StringImpl_GetChars(const char *texx, size_t len, int index) {
+    if ((index < 0) || (index >= (int)len))
+        return 0;
+    return texx[index];
+}
+
+const char* String_Append(const char *thisString, const char *extrabit) {
+    return StringImpl_Append(thisString, strlen(thisString), extrabit);
+}
+
+const char* String_AppendChar(const char *thisString, char extraOne) {
+    return StringImpl_AppendChar(thisString, strlen(thisString), extraOne);
+}
+
+const char* String_ReplaceCharAt(const char *thisString, int index, char newChar) {
+    return StringImpl_ReplaceCharAt(thisString, strlen(thisString), index, newChar);
+}
+
+const char* String_Truncate(const char *thisString, int length) {
+    return StringImpl_Truncate(thisString, strlen(thisString), length);
+}
+
+const char* String_Substring(const char *thisString, int index, int length) {
+    return StringImpl_Substring(thisString, strlen(thisString), index, length);
 }
 
 int String_CompareTo(const char *thisString, const char *otherString, bool caseSensitive) {
+    if (thisString == otherString)
+        return 0; // same string object
 
     if (caseSensitive) {
         return strcmp(thisString, otherString);
@@ -113,22 +176,7 @@ int String_StartsWith(const char *thisString, const char *checkForString, bool c
 }
 
 int String_EndsWith(const char *thisString, const char *checkForString, bool caseSensitive) {
-
-    int checkAtOffset = strlen(thisString) - strlen(checkForString);
-
-    if (checkAtOffset < 0)
-    {
-        return 0;
-    }
-
-    if (caseSensitive) 
-    {
-        return (strcmp(&thisString[checkAtOffset], checkForString) == 0) ? 1 : 0;
-    }
-    else 
-    {
-        return (ags_stricmp(&thisString[checkAtOffset], checkForString) == 0) ? 1 : 0;
-    }
+    return StringImpl_EndsWith(thisString, strlen(thisString), checkForString, caseSensitive);
 }
 
 const char* String_Replace(const char *thisString, const char *lookForText, const char *replaceWithText, bool caseSensitive)
@@ -167,23 +215,23 @@ const char* String_Replace(const char *thisString, const char *lookForText, cons
 }
 
 const char* String_LowerCase(const char *thisString) {
-    char *buffer = (char*)malloc(strlen(thisString) + 1);
-    strcpy(buffer, thisString);
+    const size_t len = strlen(thisString);
+    char *buffer = ScriptString::AllocText(len);
+    memcpy(buffer, thisString, len + 1);
     ags_strlwr(buffer);
-    return CreateNewScriptString(buffer, false);
+    return CreateNewScriptStringFromBuffer(buffer, len);
 }
 
 const char* String_UpperCase(const char *thisString) {
-    char *buffer = (char*)malloc(strlen(thisString) + 1);
-    strcpy(buffer, thisString);
+    const size_t len = strlen(thisString);
+    char *buffer = ScriptString::AllocText(len);
+    memcpy(buffer, thisString, len + 1);
     ags_strupr(buffer);
-    return CreateNewScriptString(buffer, false);
+    return CreateNewScriptStringFromBuffer(buffer, len);
 }
 
 int String_GetChars(const char *texx, int index) {
-    if ((index < 0) || (index >= (int)strlen(texx)))
-        return 0;
-    return texx[index];
+    return StringImpl_GetChars(texx, strlen(texx), index);
 }
 
 int StringToInt(const char*stino) {
@@ -216,26 +264,58 @@ const char *CreateNewScriptString(const char *fromText, bool reAllocate) {
     return (const char*)CreateNewScriptStringObj(fromText, reAllocate).second;
 }
 
-DynObjectRef CreateNewScriptStringObj(const char *fromText, bool reAllocate)
+static DynObjectRef RegisterScriptString(ScriptString *str)
 {
-    ScriptString *str;
-    if (reAllocate) {
-        str = new ScriptString(fromText);
-    }
-    else {
-        str = new ScriptString();
-        str->text = (char*)fromText;
-    }
     void *obj_ptr = str->text;
     int32_t handle = ccRegisterManagedObject(obj_ptr, str);
     if (handle == 0)
     {
+        ScriptString::FreeText(str->text);
         delete str;
         return DynObjectRef(0, nullptr);
     }
     return DynObjectRef(handle, obj_ptr);
 }
 
+DynObjectRef CreateNewScriptStringObj(const char *fromText, bool reAllocate)
+{
+    if (!reAllocate)
+        return CreateNewScriptStringObjFromBuffer((char*)fromText, strlen(fromText));
+    return RegisterScriptString(new ScriptString(fromText));
+}
+
+DynObjectRef CreateNewScriptStringObjFromBuffer(char *buffer, size_t length)
+{
+    ScriptString *str = new ScriptString();
+    str->SetText(buffer, length);
+    return RegisterScriptString(str);
+}
+
+const char *CreateNewScriptStringFromBuffer(char *buffer, size_t length) {
+    return (const char*)CreateNewScriptStringObjFromBuffer(buffer, length).second;
+}
+
+DynObjectRef CreateInternedScriptStringObj(const char *fromText)
+{
+    if (!fromText)
+        return DynObjectRef(0, nullptr);
+    const size_t length = strlen(fromText);
+    const uint32_t hash = ScriptString::CalcHash(fromText, length);
+    ScriptString *str = ScriptString::FindInterned(fromText, length, hash);
+    if (str)
+        return DynObjectRef(ccGetObjectHandleFromAddress(str->text), str->text);
+
+    str = new ScriptString(fromText, length);
+    DynObjectRef ref = RegisterScriptString(str);
+    if (ref.second)
+        str->Intern();
+    return ref;
+}
+
+const char *CreateInternedScriptString(const char *fromText) {
+    return (const char*)CreateInternedScriptStringObj(fromText).second;
+}
+
 size_t break_up_text_into_lines(const char *todis, SplitLines &lines, int wii, int fonnt, size_t max_lines) {
     if (fonnt == -1)
         fonnt = play.normal_font;
@@ -313,6 +393,41 @@ void my_strncpy(char *dest, const char *src, int len) {
 #include "script/script_runtime.h"
 #include "ac/math.h"
 
+// The String's methods get "self" which is always a managed string,
+// so they may use its known length instead of measuring the text
+
+static const char* ScString_Append(const char *thisString, const char *extrabit) {
+    return StringImpl_Append(thisString, ScriptString::GetLength(thisString), extrabit);
+}
+
+static const char* ScString_AppendChar(const char *thisString, char extraOne) {
+    return StringImpl_AppendChar(thisString, ScriptString::GetLength(thisString), extraOne);
+}
+
+static const char* ScString_Copy(const char *srcString) {
+    return StringImpl_Copy(srcString, ScriptString::GetLength(srcString));
+}
+
+static int ScString_EndsWith(const char *thisString, const char *checkForString, bool caseSensitive) {
+    return StringImpl_EndsWith(thisString, ScriptString::GetLength(thisString), checkForString, caseSensitive);
+}
+
+static const char* ScString_ReplaceCharAt(const char *thisString, int index, char newChar) {
+    return StringImpl_ReplaceCharAt(thisString, ScriptString::GetLength(thisString), index, newChar);
+}
+
+static const char* ScString_Substring(const char *thisString, int index, int length) {
+    return StringImpl_Substring(thisString, ScriptString::GetLength(thisString), index, length);
+}
+
+static const char* ScString_Truncate(const char *thisString, int length) {
+    return StringImpl_Truncate(thisString, ScriptString::GetLength(thisString), length);
+}
+
+static int ScString_GetChars(const char *texx, int index) {
+    return StringImpl_GetChars(texx, ScriptString::GetLength(texx), index);
+}
+
 // int (const char *thisString)
 RuntimeScriptValue Sc_String_IsNullOrEmpty(const RuntimeScriptValue *params, int32_t param_count)
 {
@@ -322,13 +437,13 @@ RuntimeScriptValue Sc_String_IsNullOrEmpty(const RuntimeScriptValue *params, int
 // const char* (const char *thisString, const char *extrabit)
 RuntimeScriptValue Sc_String_Append(void *self, const RuntimeScriptValue *params, int32_t param_count)
 {
-    API_OBJCALL_OBJ_POBJ(const char, const char, myScriptStringImpl, String_Append, const char);
+    API_OBJCALL_OBJ_POBJ(const char, const char, myScriptStringImpl, ScString_Append, const char);
 }
 
 // const char* (const char *thisString, char extraOne)
 RuntimeScriptValue Sc_String_AppendChar(void *self, const RuntimeScriptValue *params, int32_t param_count)
 {
-    API_OBJCALL_OBJ_PINT(const char, const char, myScriptStringImpl, String_AppendChar);
+    API_OBJCALL_OBJ_PINT(const char, const char, myScriptStringImpl, ScString_AppendChar);
 }
 
 // int (const char *thisString, const char *otherString, bool caseSensitive)
@@ -346,13 +461,13 @@ RuntimeScriptValue Sc_StrContains(void *self, const RuntimeScriptValue *params,
 // const char* (const char *srcString)
 RuntimeScriptValue Sc_String_Copy(void *self, const RuntimeScriptValue *params, int32_t param_count)
 {
-    API_OBJCALL_OBJ(const char, const char, myScriptStringImpl, String_Copy);
+    API_OBJCALL_OBJ(const char, const char, myScriptStringImpl, ScString_Copy);
 }
 
 // int (const char *thisString, const char *checkForString, bool caseSensitive)
 RuntimeScriptValue Sc_String_EndsWith(void *self, const RuntimeScriptValue *params, int32_t param_count)
 {
-    API_OBJCALL_INT_POBJ_PBOOL(const char, String_EndsWith, const char);
+    API_OBJCALL_INT_POBJ_PBOOL(const char, ScString_EndsWith, const char);
 }
 
 // const char* (const char *texx, ...)
@@ -377,7 +492,7 @@ RuntimeScriptValue Sc_String_Replace(void *self, const RuntimeScriptValue *param
 // const char* (const char *thisString, int index, char newChar)
 RuntimeScriptValue Sc_String_ReplaceCharAt(void *self, const RuntimeScriptValue *params, int32_t param_count)
 {
-    API_OBJCALL_OBJ_PINT2(const char, const char, myScriptStringImpl, String_ReplaceCharAt);
+    API_OBJCALL_OBJ_PINT2(const char, const char, myScriptStringImpl, ScString_ReplaceCharAt);
 }
 
 // int (const char *thisString, const char *checkForString, bool caseSensitive)
@@ -389,13 +504,13 @@ RuntimeScriptValue Sc_String_StartsWith(void *self, const RuntimeScriptValue *pa
 // const char* (const char *thisString, int index, int length)
 RuntimeScriptValue Sc_String_Substring(void *self, const RuntimeScriptValue *params, int32_t param_count)
 {
-    API_OBJCALL_OBJ_PINT2(const char, const char, myScriptStringImpl, String_Substring);
+    API_OBJCALL_OBJ_PINT2(const char, const char, myScriptStringImpl, ScString_Substring);
 }
 
 // const char* (const char *thisString, int length)
 RuntimeScriptValue Sc_String_Truncate(void *self, const RuntimeScriptValue *params, int32_t param_count)
 {
-    API_OBJCALL_OBJ_PINT(const char, const char, myScriptStringImpl, String_Truncate);
+    API_OBJCALL_OBJ_PINT(const char, const char, myScriptStringImpl, ScString_Truncate);
 }
 
 // const char* (const char *thisString)
@@ -419,13 +534,13 @@ RuntimeScriptValue Sc_StringToInt(void *self, const RuntimeScriptValue *params,
 // int (const char *texx, int index)
 RuntimeScriptValue Sc_String_GetChars(void *self, const RuntimeScriptValue *params, int32_t param_count)
 {
-    API_OBJCALL_INT_PINT(const char, String_GetChars);
+    API_OBJCALL_INT_PINT(const char, ScString_GetChars);
 }
 
 RuntimeScriptValue Sc_strlen(void *self, const RuntimeScriptValue *params, int32_t param_count)
 {
     ASSERT_SELF(strlen);
-    return RuntimeScriptValue().SetInt32(strlen((const char*)self));
+    return RuntimeScriptValue().SetInt32(ScriptString::GetLength((const char*)self));
 }
 
 //=============================================================================
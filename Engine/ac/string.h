@@ -43,8 +43,19 @@ int StrContains (const char *s1, const char *s2);
 
 //=============================================================================
 
+// Creates new managed string; if reAllocate is false, takes ownership of the text,
+// which must be allocated by ScriptString::AllocText
 const char* CreateNewScriptString(const char *fromText, bool reAllocate = true);
 DynObjectRef CreateNewScriptStringObj(const char *fromText, bool reAllocate = true);
+// Creates new managed string, taking ownership of the text buffer of known length
+// allocated by ScriptString::AllocText
+const char* CreateNewScriptStringFromBuffer(char *buffer, size_t length);
+DynObjectRef CreateNewScriptStringObjFromBuffer(char *buffer, size_t length);
+// Returns the live managed string with the same text, or creates new one;
+// meant for the strings which are likely to be requested repeatedly,
+// such as script literals and translations
+const char* CreateInternedScriptString(const char *fromText);
+DynObjectRef CreateInternedScriptStringObj(const char *fromText);
 class SplitLines;
 // Break up the text into lines restricted by the given width;
 // returns number of lines, or 0 if text cannot be split well to fit in this width.
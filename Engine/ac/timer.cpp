@@ -29,6 +29,7 @@ const auto MAXIMUM_FALL_BEHIND = 3;
 
 auto tick_duration = std::chrono::microseconds(1000000LL/40);
 auto framerate_maxed = false;
+auto unthrottled = false;
 
 auto last_tick_time = AGS_Clock::now();
 auto next_frame_timestamp = AGS_Clock::now();
@@ -37,7 +38,7 @@ auto next_frame_timestamp = AGS_Clock::now();
 
 std::chrono::microseconds GetFrameDuration()
 {
-    if (framerate_maxed) {
+    if (framerate_maxed || unthrottled) {
         return std::chrono::microseconds(0);
     }
     return tick_duration;
@@ -52,6 +53,11 @@ void setTimerFps(int new_fps)
     next_frame_timestamp = AGS_Clock::now();
 }
 
+void setTimerUnthrottled(bool on)
+{
+    unthrottled = on;
+}
+
 void WaitForNextFrame()
 {
     auto now = AGS_Clock::now();
@@ -80,7 +86,7 @@ bool waitingForNextTick()
 {
     auto now = AGS_Clock::now();
 
-    if (framerate_maxed) {
+    if (framerate_maxed || unthrottled) {
         last_tick_time = now;
         return false;
     }
@@ -31,6 +31,9 @@ using AGS_Clock = std::conditional<
 extern void WaitForNextFrame();
 
 extern void setTimerFps(int new_fps);
+// Makes the game loop run as fast as possible regardless of the game speed,
+// for automated runs and benchmarking
+extern void setTimerUnthrottled(bool on);
 extern bool waitingForNextTick();  // store last tick time.
 extern void skipMissedTicks();  // if more than N frames, just skip all, start a fresh.
 
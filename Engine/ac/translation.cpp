@@ -20,7 +20,7 @@
 #include "ac/global_game.h"
 #include "ac/runtime_defines.h"
 #include "ac/translation.h"
-#include "ac/tree_map.h"
+#include "ac/translation_table.h"
 #include "ac/wordsdictionary.h"
 #include "debug/out.h"
 #include "util/misc.h"
@@ -35,14 +35,14 @@ extern GameState play;
 extern char transFileName[MAX_PATH];
 
 
-TreeMap *transtree = nullptr;
+TranslationTable *transtable = nullptr;
 long lang_offs_start = 0;
 char transFileName[MAX_PATH] = "\0";
 
 void close_translation () {
-    if (transtree != nullptr) {
-        delete transtree;
-        transtree = nullptr;
+    if (transtable != nullptr) {
+        delete transtable;
+        transtable = nullptr;
     }
 }
 
@@ -71,11 +71,11 @@ bool init_translation (const String &lang, const String &fallback_lang, bool qui
         return false;
     }
 
-    if (transtree != nullptr)
+    if (transtable != nullptr)
     {
         close_translation();
     }
-    transtree = new TreeMap();
+    transtable = new TranslationTable();
 
     String parse_error;
     bool result = parse_translation(language_file, parse_error);
@@ -111,10 +111,12 @@ bool parse_translation(Stream *language_file, String &parse_error)
         int blockType = language_file->ReadInt32();
         if (blockType == -1)
             break;
-        // MACPORT FIX 9/6/5: remove warning
-        /* int blockSize = */ language_file->ReadInt32();
+        int blockSize = language_file->ReadInt32();
 
         if (blockType == 1) {
+            // decrypted texts take about as much space as the encrypted block
+            if (blockSize > 0)
+                transtable->Reserve(blockSize);
             char original[STD_BUFFER_SIZE], translation[STD_BUFFER_SIZE];
             while (1) {
                 read_string_decrypt (language_file, original, STD_BUFFER_SIZE);
@@ -126,7 +128,7 @@ bool parse_translation(Stream *language_file, String &parse_error)
                     parse_error = "Translation file is corrupt";
                     return false;
                 }
-                transtree->addText (original, translation);
+                transtable->Add(original, translation);
             }
 
         }
@@ -169,7 +171,7 @@ bool parse_translation(Stream *language_file, String &parse_error)
         }
     }
 
-    if (transtree->text == nullptr)
+    if (transtable->GetCount() == 0)
     {
         parse_error = "The translation file was empty.";
         return false;
@@ -0,0 +1,94 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <string.h>
+#include "ac/translation_table.h"
+#include "util/string_types.h"
+
+// Initial number of hash buckets, must be a power of 2
+static const size_t MinBucketCount = 64;
+
+uint32_t TranslationTable::CalcHash(const char *text)
+{
+    return FNV::Hash1a(text);
+}
+
+void TranslationTable::Reserve(size_t text_size)
+{
+    _texts.reserve(text_size);
+}
+
+size_t TranslationTable::FindBucket(const char *text, uint32_t hash) const
+{
+    const size_t mask = _buckets.size() - 1;
+    size_t index = hash & mask;
+    for (; _buckets[index] >= 0; index = (index + 1) & mask)
+    {
+        const Entry &entry = _entries[_buckets[index]];
+        if (entry.Hash == hash && strcmp(&_texts[entry.Text], text) == 0)
+            break;
+    }
+    return index;
+}
+
+void TranslationTable::Add(const char *text, const char *translation)
+{
+    if (text == nullptr || text[0] == 0)
+        return;
+    // keep the load factor below 1/2
+    if (_buckets.size() < (_entries.size() + 1) * 2)
+        Rehash(_buckets.empty() ? MinBucketCount : _buckets.size() * 2);
+
+    const uint32_t hash = CalcHash(text);
+    const size_t bucket = FindBucket(text, hash);
+    if (_buckets[bucket] >= 0)
+        return; // already added
+
+    Entry entry;
+    entry.Hash = hash;
+    entry.Text = _texts.size();
+    _texts.insert(_texts.end(), text, text + strlen(text) + 1);
+    entry.Translation = _texts.size();
+    _texts.insert(_texts.end(), translation, translation + strlen(translation) + 1);
+    _buckets[bucket] = _entries.size();
+    _entries.push_back(entry);
+}
+
+void TranslationTable::Rehash(size_t bucket_count)
+{
+    _buckets.assign(bucket_count, -1);
+    const size_t mask = bucket_count - 1;
+    for (size_t i = 0; i < _entries.size(); ++i)
+    {
+        size_t index = _entries[i].Hash & mask;
+        while (_buckets[index] >= 0)
+            index = (index + 1) & mask;
+        _buckets[index] = i;
+    }
+}
+
+void TranslationTable::Clear()
+{
+    _texts.clear();
+    _entries.clear();
+    _buckets.clear();
+}
+
+const char *TranslationTable::Find(const char *text) const
+{
+    if (_entries.empty())
+        return nullptr;
+    const int32_t entry = _buckets[FindBucket(text, CalcHash(text))];
+    return entry >= 0 ? &_texts[_entries[entry].Translation] : nullptr;
+}
@@ -0,0 +1,62 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Hash table of the translated texts.
+//
+// All the texts are stored one after another in a single memory block,
+// which is filled once when the translation is loaded. Lookup does not
+// depend on the order in which the texts were added.
+//
+//=============================================================================
+#ifndef __AGS_EE_AC__TRANSLATIONTABLE_H
+#define __AGS_EE_AC__TRANSLATIONTABLE_H
+
+#include <vector>
+#include "core/types.h"
+
+class TranslationTable
+{
+public:
+    // Reserves memory for the given total size of texts
+    void        Reserve(size_t text_size);
+    // Adds the text and its translation; empty texts and texts that
+    // were already added are ignored
+    void        Add(const char *text, const char *translation);
+    // Removes all the texts
+    void        Clear();
+    // Finds the translation of the given text; returns nullptr if there's none.
+    // The returned pointer is valid until the table is modified.
+    const char *Find(const char *text) const;
+    // Gets the number of translated texts
+    size_t      GetCount() const { return _entries.size(); }
+
+private:
+    struct Entry
+    {
+        uint32_t Hash;
+        uint32_t Text;        // offset of the original text in the text data
+        uint32_t Translation; // offset of the translation in the text data
+    };
+
+    static uint32_t CalcHash(const char *text);
+    // Finds the bucket either holding the text, or the empty one where it should be put
+    size_t      FindBucket(const char *text, uint32_t hash) const;
+    void        Rehash(size_t bucket_count);
+
+    std::vector<char>    _texts;   // null-terminated texts
+    std::vector<Entry>   _entries;
+    std::vector<int32_t> _buckets; // entry indexes, or -1 for the empty bucket
+};
+
+#endif // __AGS_EE_AC__TRANSLATIONTABLE_H
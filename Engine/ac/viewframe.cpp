@@ -12,6 +12,7 @@
 //
 //=============================================================================
 
+#include <algorithm>
 #include "ac/gamesetupstruct.h"
 #include "ac/viewframe.h"
 #include "debug/debug_log.h"
@@ -31,6 +32,9 @@ extern ViewStruct*views;
 extern SpriteCache spriteset;
 extern CCAudioClip ccDynamicAudioClip;
 
+// Number of frames following the current one, which are loaded in background
+const int ViewPrefetchFrames = 4;
+
 
 int ViewFrame_GetFlipped(ScriptViewFrame *svf) {
   if (views[svf->view].loops[svf->loop].frames[svf->frame].flags & VFLG_FLIPSPRITE)
@@ -115,9 +119,22 @@ void precache_view(int view)
     }
 }
 
+void prefetch_view_loop(int view, int loop, int frame)
+{
+    if (view < 0 || loop < 0 || loop >= views[view].numLoops)
+        return;
+    const ViewLoopNew &vloop = views[view].loops[loop];
+    const int count = std::min(ViewPrefetchFrames, vloop.numFrames - 1);
+    for (int i = 1; i <= count; ++i)
+        spriteset.Prefetch(vloop.frames[(frame + i) % vloop.numFrames].pic);
+}
+
 // the specified frame has just appeared, see if we need
 // to play a sound or whatever
 void CheckViewFrame (int view, int loop, int frame, int sound_volume) {
+    // make sure the next frames are ready by the time they are shown
+    prefetch_view_loop(view, loop, frame);
+
     ScriptAudioChannel *channel = nullptr;
     if (game.IsLegacyAudioSystem())
     {
@@ -40,6 +40,9 @@ int  ViewFrame_GetLoop(ScriptViewFrame *svf);
 int  ViewFrame_GetFrame(ScriptViewFrame *svf);
 
 void precache_view(int view);
+// Requests the sprites of the loop frames following the given one to be loaded
+// in background
+void prefetch_view_loop(int view, int loop, int frame);
 void CheckViewFrame (int view, int loop, int frame, int sound_volume=SCR_NO_VALUE);
 // draws a view frame, flipped if appropriate
 void DrawViewFrame(Common::Bitmap *ds, const ViewFrame *vframe, int x, int y, bool alpha_blend = false);
@@ -21,6 +21,7 @@
 #include "ac/room.h"
 #include "ac/roomobject.h"
 #include "ac/roomstatus.h"
+#include "ac/route_finder.h"
 #include "ac/walkablearea.h"
 #include "game/roomstruct.h"
 #include "gfx/bitmap.h"
@@ -55,6 +56,7 @@ void redo_walkable_areas() {
         }
     }
 
+    set_walkable_areas(thisroom.WalkAreaMask.get());
 }
 
 int get_walkable_area_pixel(int x, int y)
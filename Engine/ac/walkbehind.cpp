@@ -12,6 +12,8 @@
 //
 //=============================================================================
 
+#include <string.h>
+#include <vector>
 #include "ac/walkbehind.h"
 #include "ac/common.h"
 #include "ac/common_defines.h"
@@ -27,8 +29,10 @@ extern GameState play;
 extern IGraphicsDriver *gfxDriver;
 
 
-char *walkBehindExists = nullptr;  // whether a WB area is in this column
-int *walkBehindStartY = nullptr, *walkBehindEndY = nullptr;
+// walk-behind spans of all the mask rows, in the row order
+std::vector<WalkBehindSpan> walkBehindSpans;
+// index of the first span of each row, followed by the total span count
+std::vector<int> walkBehindRowSpans;
 char noWalkBehindsAtAll = 0;
 int walkBehindLeft[MAX_WALK_BEHINDS], walkBehindTop[MAX_WALK_BEHINDS];
 int walkBehindRight[MAX_WALK_BEHINDS], walkBehindBottom[MAX_WALK_BEHINDS];
@@ -53,15 +57,15 @@ void update_walk_behind_images()
                                (walkBehindBottom[ee] - walkBehindTop[ee]) + 1,
 							   thisroom.BgFrames[play.bg_frame].Graphic->GetColorDepth());
       int yy, startX = walkBehindLeft[ee], startY = walkBehindTop[ee];
-      for (rr = startX; rr <= walkBehindRight[ee]; rr++)
+      for (yy = startY; yy <= walkBehindBottom[ee]; yy++)
       {
-        for (yy = startY; yy <= walkBehindBottom[ee]; yy++)
+        const uint8_t *bg_row = thisroom.BgFrames[play.bg_frame].Graphic->GetScanLine(yy);
+        uint8_t *wb_row = wbbmp->GetScanLineForWriting(yy - startY);
+        for (rr = walkBehindRowSpans[yy]; rr < walkBehindRowSpans[yy + 1]; rr++)
         {
-          if (thisroom.WalkBehindMask->GetScanLine(yy)[rr] == ee)
-          {
-            for (int ii = 0; ii < bpp; ii++)
-              wbbmp->GetScanLineForWriting(yy - startY)[(rr - startX) * bpp + ii] = thisroom.BgFrames[play.bg_frame].Graphic->GetScanLine(yy)[rr * bpp + ii];
-          }
+          const WalkBehindSpan &span = walkBehindSpans[rr];
+          if (span.Area == ee)
+            memcpy(&wb_row[(span.X1 - startX) * bpp], &bg_row[span.X1 * bpp], (span.X2 - span.X1) * bpp);
         }
       }
 
@@ -81,15 +85,8 @@ void update_walk_behind_images()
 
 
 void recache_walk_behinds () {
-  if (walkBehindExists) {
-    free (walkBehindExists);
-    free (walkBehindStartY);
-    free (walkBehindEndY);
-  }
-
-  walkBehindExists = (char*)malloc (thisroom.WalkBehindMask->GetWidth());
-  walkBehindStartY = (int*)malloc (thisroom.WalkBehindMask->GetWidth() * sizeof(int));
-  walkBehindEndY = (int*)malloc (thisroom.WalkBehindMask->GetWidth() * sizeof(int));
+  walkBehindSpans.clear();
+  walkBehindRowSpans.clear();
   noWalkBehindsAtAll = 1;
 
   int ee,rr,tmm;
@@ -115,26 +112,36 @@ void recache_walk_behinds () {
   if ((!thisroom.WalkBehindMask->IsLinearBitmap()) || (thisroom.WalkBehindMask->GetColorDepth() != 8))
     quit("Walk behinds bitmap not linear");
 
-  for (ee=0;ee<thisroom.WalkBehindMask->GetWidth();ee++) {
-    walkBehindExists[ee] = 0;
-    for (rr=0;rr<thisroom.WalkBehindMask->GetHeight();rr++) {
-      tmm = thisroom.WalkBehindMask->GetScanLine(rr)[ee];
-      //tmm = _getpixel(thisroom.WalkBehindMask,ee,rr);
+  // split each row into the runs of the same walk-behind area, so that
+  // the sprites could be cut by whole runs instead of checking each pixel
+  const int width = thisroom.WalkBehindMask->GetWidth();
+  const int height = thisroom.WalkBehindMask->GetHeight();
+  walkBehindRowSpans.resize(height + 1);
+  for (rr=0;rr<height;rr++) {
+    walkBehindRowSpans[rr] = (int)walkBehindSpans.size();
+    const uint8_t *scanline = thisroom.WalkBehindMask->GetScanLine(rr);
+    for (ee=0;ee<width;) {
+      tmm = scanline[ee];
+      int spanEnd = ee + 1;
+      while (spanEnd < width && scanline[spanEnd] == tmm)
+        spanEnd++;
       if ((tmm >= 1) && (tmm < MAX_WALK_BEHINDS)) {
-        if (!walkBehindExists[ee]) {
-          walkBehindStartY[ee] = rr;
-          walkBehindExists[ee] = tmm;
-          noWalkBehindsAtAll = 0;
-        }
-        walkBehindEndY[ee] = rr + 1;  // +1 to allow bottom line of screen to work
+        WalkBehindSpan span;
+        span.X1 = ee;
+        span.X2 = spanEnd;
+        span.Area = tmm;
+        walkBehindSpans.push_back(span);
+        noWalkBehindsAtAll = 0;
 
         if (ee < walkBehindLeft[tmm]) walkBehindLeft[tmm] = ee;
         if (rr < walkBehindTop[tmm]) walkBehindTop[tmm] = rr;
-        if (ee > walkBehindRight[tmm]) walkBehindRight[tmm] = ee;
+        if (spanEnd - 1 > walkBehindRight[tmm]) walkBehindRight[tmm] = spanEnd - 1;
         if (rr > walkBehindBottom[tmm]) walkBehindBottom[tmm] = rr;
       }
+      ee = spanEnd;
     }
   }
+  walkBehindRowSpans[height] = (int)walkBehindSpans.size();
 
   if (walkBehindMethod == DrawAsSeparateSprite)
   {
@@ -25,6 +25,14 @@ enum WalkBehindMethodEnum
     DrawAsSeparateCharSprite
 };
 
+// Horizontal run of the walk-behind area's pixels in the mask row
+struct WalkBehindSpan
+{
+    int X1; // first pixel
+    int X2; // pixel past the last one
+    int Area;
+};
+
 void update_walk_behind_images();
 void recache_walk_behinds ();
 
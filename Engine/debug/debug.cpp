@@ -31,6 +31,7 @@
 #include "script/script.h"
 #include "script/script_common.h"
 #include "script/cc_error.h"
+#include "script/script_profiler.h"
 #include "util/textstreamwriter.h"
 #include "platform/base/agsplatformdriver.h"
 #include "debug/agseditordebugger.h"
@@ -163,12 +164,36 @@ void apply_debug_config(const ConfigTree &cfg)
             DbgMgr.UnregisterOutput(WarningFileID);
         }
     }
+
+    if (INIreadint(cfg, "misc", "script_profile", 0) != 0)
+    {
+        ScriptProfiler::SetEnabled(true);
+        platform->WriteStdOut("Script profiling enabled");
+    }
+
     DbgMgr.UnregisterOutput(OutputMsgBufID);
     DebugMsgBuff.reset();
 }
 
+// Writes script profiler results to the files in the app output directory
+static void write_script_profile()
+{
+    String out_dir = platform->GetAppOutputDirectory();
+    ScriptProfiler::WriteCollapsedStacks(String::FromFormat("%s/script_profile.folded", out_dir.GetCStr()),
+        ScriptProfiler::kSample_Instructions);
+    ScriptProfiler::WriteCollapsedStacks(String::FromFormat("%s/script_profile_time.folded", out_dir.GetCStr()),
+        ScriptProfiler::kSample_Microseconds);
+    ScriptProfiler::WriteInstructionStats(String::FromFormat("%s/script_profile_ops.txt", out_dir.GetCStr()));
+}
+
 void shutdown_debug()
 {
+    if (ScriptProfiler::IsEnabled())
+    {
+        write_script_profile();
+        ScriptProfiler::SetEnabled(false);
+    }
+
     // Shutdown output subsystem
     DbgMgr.UnregisterAll();
 
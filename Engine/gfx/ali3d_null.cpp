@@ -0,0 +1,429 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include "gfx/ali3d_null.h"
+#include "debug/out.h"
+#include "main/main_allegro.h"
+#include "util/directory.h"
+#include "util/path.h"
+
+namespace AGS
+{
+namespace Engine
+{
+namespace Null
+{
+
+using namespace Common;
+
+// ----------------------------------------------------------------------------
+// NullGfxFilter
+// ----------------------------------------------------------------------------
+
+const GfxFilterInfo NullGfxFilter::FilterInfo = GfxFilterInfo("None", "None");
+
+const GfxFilterInfo &NullGfxFilter::GetInfo() const
+{
+    return FilterInfo;
+}
+
+// ----------------------------------------------------------------------------
+// NullGraphicsDriver
+// ----------------------------------------------------------------------------
+
+NullGraphicsDriver::NullGraphicsDriver()
+    : _screenBmp(nullptr)
+    , _screenWrapper(nullptr)
+    , _origVirtualScreen(nullptr)
+    , _virtualScreen(nullptr)
+    , _stageVirtualScreen(nullptr)
+    , _tint_red(0)
+    , _tint_green(0)
+    , _tint_blue(0)
+    , _frameDumpInterval(0)
+    , _frameCount(0)
+{
+    // Initialize default sprite batch, it will be used when no other batch was activated
+    NullGraphicsDriver::InitSpriteBatch(0, _spriteBatchDesc[0]);
+}
+
+NullGraphicsDriver::~NullGraphicsDriver()
+{
+    OnUnInit();
+    ReleaseDisplayMode();
+}
+
+bool NullGraphicsDriver::IsModeSupported(const DisplayMode &mode)
+{
+    if (mode.Width <= 0 || mode.Height <= 0)
+    {
+        set_allegro_error("Invalid resolution parameters: %d x %d", mode.Width, mode.Height);
+        return false;
+    }
+    switch (mode.ColorDepth)
+    {
+    case 8:
+    case 16:
+    case 32:
+        return true;
+    default:
+        set_allegro_error("Invalid colour depth: %d", mode.ColorDepth);
+        return false;
+    }
+}
+
+int NullGraphicsDriver::GetDisplayDepthForNativeDepth(int native_color_depth) const
+{
+    if (native_color_depth > 8)
+        return 32;
+    return native_color_depth;
+}
+
+bool NullGraphicsDriver::SetDisplayMode(const DisplayMode &mode, volatile int *loopTimer)
+{
+    if (!IsModeSupported(mode))
+        return false;
+
+    ReleaseDisplayMode();
+
+    if (_initGfxCallback != nullptr)
+        _initGfxCallback(nullptr);
+
+    set_color_depth(mode.ColorDepth);
+    // Use the same pixel format as the software renderer, so that the
+    // frames are rendered exactly as they would be on screen
+    _rgb_r_shift_15 = 10;
+    _rgb_g_shift_15 = 5;
+    _rgb_b_shift_15 = 0;
+    _rgb_r_shift_16 = 11;
+    _rgb_g_shift_16 = 5;
+    _rgb_b_shift_16 = 0;
+    _rgb_r_shift_24 = 16;
+    _rgb_g_shift_24 = 8;
+    _rgb_b_shift_24 = 0;
+    _rgb_a_shift_32 = 24;
+    _rgb_r_shift_32 = 16;
+    _rgb_g_shift_32 = 8;
+    _rgb_b_shift_32 = 0;
+
+    _screenBmp = create_bitmap_ex(mode.ColorDepth, mode.Width, mode.Height);
+    if (!_screenBmp)
+    {
+        set_allegro_error("Unable to create %d x %d (%d-bit) screen bitmap", mode.Width, mode.Height, mode.ColorDepth);
+        return false;
+    }
+    // the engine expects Allegro's screen bitmap to exist
+    screen = _screenBmp;
+    _screenWrapper = BitmapHelper::CreateRawBitmapWrapper(screen);
+    set_palette_range(default_palette, 0, 255, 0);
+
+    OnModeSet(mode);
+    // If we already have a gfx filter, then use it to update virtual screen immediately
+    CreateVirtualScreen();
+    _screenWrapper->Clear();
+    return true;
+}
+
+void NullGraphicsDriver::CreateVirtualScreen()
+{
+    if (!IsModeSet() || !IsRenderFrameValid() || !IsNativeSizeValid())
+        return;
+    DestroyVirtualScreen();
+    // Adjust clipping so nothing gets drawn outside the game frame
+    _screenWrapper->SetClip(_dstRect);
+    _origVirtualScreen = _screenWrapper;
+    _virtualScreen = _screenWrapper;
+    _stageVirtualScreen = _screenWrapper;
+}
+
+void NullGraphicsDriver::DestroyVirtualScreen()
+{
+    _origVirtualScreen = nullptr;
+    _virtualScreen = nullptr;
+    _stageVirtualScreen = nullptr;
+}
+
+void NullGraphicsDriver::ReleaseDisplayMode()
+{
+    OnModeReleased();
+    ClearDrawLists();
+
+    DestroyVirtualScreen();
+
+    delete _screenWrapper;
+    _screenWrapper = nullptr;
+    if (_screenBmp)
+    {
+        if (screen == _screenBmp)
+            screen = nullptr;
+        destroy_bitmap(_screenBmp);
+        _screenBmp = nullptr;
+    }
+}
+
+bool NullGraphicsDriver::SetNativeSize(const Size &src_size)
+{
+    OnSetNativeSize(src_size);
+    CreateVirtualScreen();
+    return !_srcRect.IsEmpty();
+}
+
+bool NullGraphicsDriver::SetRenderFrame(const Rect &dst_rect)
+{
+    OnSetRenderFrame(dst_rect);
+    CreateVirtualScreen();
+    return !_dstRect.IsEmpty();
+}
+
+void NullGraphicsDriver::SetGraphicsFilter(PNullFilter filter)
+{
+    _filter = filter;
+    OnSetFilter();
+    CreateVirtualScreen();
+}
+
+void NullGraphicsDriver::SetFrameDump(int interval, const String &dir)
+{
+    _frameDumpInterval = interval;
+    _frameDumpDir = dir.IsEmpty() ? String(".") : dir;
+    if (_frameDumpInterval > 0 && !Directory::CreateDirectory(_frameDumpDir))
+    {
+        Debug::Printf(kDbgMsg_Error, "Unable to create frame dump directory '%s'", _frameDumpDir.GetCStr());
+        _frameDumpInterval = 0;
+    }
+}
+
+IDriverDependantBitmap* NullGraphicsDriver::CreateDDBFromBitmap(Bitmap *bitmap, bool hasAlpha, bool opaque)
+{
+    return new MemoryDDB(bitmap, opaque, hasAlpha);
+}
+
+void NullGraphicsDriver::UpdateDDBFromBitmap(IDriverDependantBitmap* bitmapToUpdate, Bitmap *bitmap, bool hasAlpha)
+{
+    MemoryDDB *ddb = (MemoryDDB*)bitmapToUpdate;
+    ddb->_bmp = bitmap;
+    ddb->_hasAlpha = hasAlpha;
+}
+
+void NullGraphicsDriver::DestroyDDB(IDriverDependantBitmap* bitmap)
+{
+    delete bitmap;
+}
+
+void NullGraphicsDriver::InitSpriteBatch(size_t index, const SpriteBatchDesc &desc)
+{
+    if (_spriteBatches.size() <= index)
+        _spriteBatches.resize(index + 1);
+    MemoryBatchRenderer::InitSpriteBatch(_spriteBatches[index], desc, _virtualScreen, _virtualScrOff);
+}
+
+void NullGraphicsDriver::ResetAllBatches()
+{
+    for (MemorySpriteBatches::iterator it = _spriteBatches.begin(); it != _spriteBatches.end(); ++it)
+        it->List.clear();
+}
+
+void NullGraphicsDriver::DrawSprite(int x, int y, IDriverDependantBitmap* bitmap)
+{
+    _spriteBatches[_actSpriteBatch].List.push_back(MemoryDrawListEntry((MemoryDDB*)bitmap, x, y));
+}
+
+void NullGraphicsDriver::RenderToBackBuffer()
+{
+    // Sprite batches are rendered the same way the software renderer does
+    for (size_t i = 0; i <= _actSpriteBatch; ++i)
+    {
+        const Rect &viewport = _spriteBatchDesc[i].Viewport;
+        const SpriteTransform &transform = _spriteBatchDesc[i].Transform;
+        const MemorySpriteBatch &batch = _spriteBatches[i];
+
+        _virtualScreen->SetClip(Rect::MoveBy(viewport, -_virtualScrOff.X, -_virtualScrOff.Y));
+        Bitmap *surface = batch.Surface.get();
+        int view_offx = viewport.Left + transform.X - _virtualScrOff.X;
+        int view_offy = viewport.Top + transform.Y - _virtualScrOff.Y;
+        if (surface)
+        {
+            if (!batch.Opaque)
+                surface->ClearTransparent();
+            _stageVirtualScreen = surface;
+            RenderSpriteBatch(batch, surface, 0, 0);
+            _virtualScreen->StretchBlt(surface, RectWH(view_offx, view_offy, viewport.GetWidth(), viewport.GetHeight()),
+                batch.Opaque ? kBitmap_Copy : kBitmap_Transparency);
+        }
+        else
+        {
+            RenderSpriteBatch(batch, _virtualScreen, view_offx, view_offy);
+        }
+        _stageVirtualScreen = _virtualScreen;
+    }
+    ClearDrawLists();
+}
+
+void NullGraphicsDriver::RenderSpriteBatch(const MemorySpriteBatch &batch, Common::Bitmap *surface, int surf_offx, int surf_offy)
+{
+    // the screen tint is not applied to the 8-bit game
+    const bool do_tint = _mode.ColorDepth > 8;
+    _renderer.RenderSpriteBatch(batch, surface, surf_offx, surf_offy, _nullSpriteCallback,
+        do_tint ? _tint_red : 0, do_tint ? _tint_green : 0, do_tint ? _tint_blue : 0);
+}
+
+void NullGraphicsDriver::Render(int xoff, int yoff, GlobalFlipType flip)
+{
+    // NOTE: the flip is only applied when displaying, so it's ignored here
+    _virtualScrOff = Point(xoff, yoff);
+    RenderToBackBuffer();
+    _frameCount++;
+    DumpFrame();
+}
+
+void NullGraphicsDriver::Render()
+{
+    Render(0, 0, kFlip_None);
+}
+
+void NullGraphicsDriver::DumpFrame()
+{
+    if (_frameDumpInterval <= 0 || (_frameCount % _frameDumpInterval) != 0)
+        return;
+    PALETTE pal;
+    get_palette(pal);
+    const String filename = Path::ConcatPaths(_frameDumpDir, String::FromFormat("frame%06u.bmp", _frameCount));
+    if (!_virtualScreen->SaveToFile(filename.GetCStr(), pal))
+    {
+        Debug::Printf(kDbgMsg_Error, "Unable to save frame to '%s', frame dump is disabled", filename.GetCStr());
+        _frameDumpInterval = 0;
+    }
+}
+
+Bitmap *NullGraphicsDriver::GetMemoryBackBuffer()
+{
+    return _virtualScreen;
+}
+
+Bitmap *NullGraphicsDriver::GetStageBackBuffer()
+{
+    return _stageVirtualScreen;
+}
+
+void NullGraphicsDriver::SetMemoryBackBuffer(Bitmap *backBuffer)
+{
+    if (!backBuffer)
+    {
+        _virtualScreen = _origVirtualScreen;
+        _stageVirtualScreen = _origVirtualScreen;
+        _virtualScrOff = Point();
+        return;
+    }
+    _virtualScreen = backBuffer;
+    _stageVirtualScreen = backBuffer;
+}
+
+bool NullGraphicsDriver::GetCopyOfScreenIntoBitmap(Common::Bitmap *destination, bool at_native_res, GraphicResolution *want_fmt)
+{
+    if (destination == nullptr || destination->GetSize() != _screenWrapper->GetSize())
+    {
+        if (want_fmt)
+        {
+            const Size need_size = _screenWrapper->GetSize();
+            *want_fmt = GraphicResolution(need_size.Width, need_size.Height, 32);
+        }
+        return false;
+    }
+    destination->Blit(_screenWrapper, 0, 0, 0, 0, destination->GetWidth(), destination->GetHeight());
+    return true;
+}
+
+// The fades and transitions are not animated, as there's nothing to show;
+// only their final result is drawn
+
+void NullGraphicsDriver::FadeOut(int speed, int targetColourRed, int targetColourGreen, int targetColourBlue)
+{
+    _virtualScreen->Clear();
+    RGB faded_out_palette[256];
+    for (int i = 0; i < 256; i++)
+    {
+        faded_out_palette[i].r = targetColourRed / 4;
+        faded_out_palette[i].g = targetColourGreen / 4;
+        faded_out_palette[i].b = targetColourBlue / 4;
+    }
+    set_palette_range(faded_out_palette, 0, 255, 0);
+}
+
+void NullGraphicsDriver::FadeIn(int speed, PALETTE pal, int targetColourRed, int targetColourGreen, int targetColourBlue)
+{
+    set_palette_range(pal, 0, 255, 0);
+    if (_drawScreenCallback != nullptr)
+        _drawScreenCallback();
+    RenderToBackBuffer();
+}
+
+void NullGraphicsDriver::BoxOutEffect(bool blackingOut, int speed, int delay)
+{
+    if (!blackingOut && _drawScreenCallback != nullptr)
+        _drawScreenCallback();
+    RenderToBackBuffer();
+    if (blackingOut)
+        _virtualScreen->Clear();
+}
+
+// ----------------------------------------------------------------------------
+// NullGraphicsFactory
+// ----------------------------------------------------------------------------
+
+NullGraphicsFactory *NullGraphicsFactory::_factory = nullptr;
+
+NullGraphicsFactory::~NullGraphicsFactory()
+{
+    _factory = nullptr;
+}
+
+size_t NullGraphicsFactory::GetFilterCount() const
+{
+    return 1;
+}
+
+const GfxFilterInfo *NullGraphicsFactory::GetFilterInfo(size_t index) const
+{
+    return index == 0 ? &NullGfxFilter::FilterInfo : nullptr;
+}
+
+String NullGraphicsFactory::GetDefaultFilterID() const
+{
+    return NullGfxFilter::FilterInfo.Id;
+}
+
+/* static */ NullGraphicsFactory *NullGraphicsFactory::GetFactory()
+{
+    if (!_factory)
+        _factory = new NullGraphicsFactory();
+    return _factory;
+}
+
+NullGraphicsDriver *NullGraphicsFactory::EnsureDriverCreated()
+{
+    if (!_driver)
+        _driver = new NullGraphicsDriver();
+    return _driver;
+}
+
+NullGfxFilter *NullGraphicsFactory::CreateFilter(const String &id)
+{
+    // The frames are rendered in the native game size, so any requested
+    // filter is replaced by the one which does no scaling
+    return new NullGfxFilter();
+}
+
+} // namespace Null
+} // namespace Engine
+} // namespace AGS
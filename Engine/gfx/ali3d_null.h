@@ -0,0 +1,168 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Offscreen graphics factory, for the automated runs and benchmarking.
+//
+// The driver renders the sprites on the memory bitmap with the same batch
+// renderer as the software driver, but does not create a window and does not
+// display anything. The frames may be saved to disk at a fixed interval.
+//
+//=============================================================================
+
+#ifndef __AGS_EE_GFX__ALI3D_NULL_H
+#define __AGS_EE_GFX__ALI3D_NULL_H
+
+#include <memory>
+#include <allegro.h>
+#include "gfx/bitmap.h"
+#include "gfx/ddb.h"
+#include "gfx/gfxdriverfactorybase.h"
+#include "gfx/gfxdriverbase.h"
+#include "gfx/gfxfilter_scaling.h"
+#include "gfx/memoryrenderer.h"
+
+namespace AGS
+{
+namespace Engine
+{
+namespace Null
+{
+
+using AGS::Common::Bitmap;
+
+// The frames are never scaled, so the filter only keeps the translation
+class NullGfxFilter : public ScalingGfxFilter
+{
+public:
+    const GfxFilterInfo &GetInfo() const override;
+
+    static const GfxFilterInfo FilterInfo;
+};
+
+
+class NullGraphicsDriver final : public GraphicsDriverBase
+{
+public:
+    NullGraphicsDriver();
+    ~NullGraphicsDriver() override;
+
+    const char*GetDriverName() override { return "Offscreen"; }
+    const char*GetDriverID() override { return "Null"; }
+    void UpdateDeviceScreen(const Size &screenSize) override {}
+    void SetTintMethod(TintMethod method) override {}
+    bool SetDisplayMode(const DisplayMode &mode, volatile int *loopTimer) override;
+    bool SetNativeSize(const Size &src_size) override;
+    bool SetRenderFrame(const Rect &dst_rect) override;
+    bool IsModeSupported(const DisplayMode &mode) override;
+    int  GetDisplayDepthForNativeDepth(int native_color_depth) const override;
+    IGfxModeList *GetSupportedModeList(int color_depth) override { return nullptr; }
+    PGfxFilter GetGraphicsFilter() const override { return _filter; }
+    void ClearRectangle(int x1, int y1, int x2, int y2, RGB *colorToUse) override {}
+    int  GetCompatibleBitmapFormat(int color_depth) override { return color_depth; }
+    IDriverDependantBitmap* CreateDDBFromBitmap(Bitmap *bitmap, bool hasAlpha, bool opaque) override;
+    void UpdateDDBFromBitmap(IDriverDependantBitmap* bitmapToUpdate, Bitmap *bitmap, bool hasAlpha) override;
+    void DestroyDDB(IDriverDependantBitmap* bitmap) override;
+
+    void DrawSprite(int x, int y, IDriverDependantBitmap* bitmap) override;
+    void SetScreenFade(int red, int green, int blue) override {}
+    void SetScreenTint(int red, int green, int blue) override
+        { _tint_red = red; _tint_green = green; _tint_blue = blue; }
+
+    void RenderToBackBuffer() override;
+    void Render() override;
+    void Render(int xoff, int yoff, GlobalFlipType flip) override;
+    bool GetCopyOfScreenIntoBitmap(Common::Bitmap *destination, bool at_native_res, GraphicResolution *want_fmt = nullptr) override;
+    void FadeOut(int speed, int targetColourRed, int targetColourGreen, int targetColourBlue) override;
+    void FadeIn(int speed, PALETTE pal, int targetColourRed, int targetColourGreen, int targetColourBlue) override;
+    void BoxOutEffect(bool blackingOut, int speed, int delay) override;
+    bool SupportsGammaControl() override { return false; }
+    void SetGamma(int newGamma) override {}
+    void UseSmoothScaling(bool enabled) override {}
+    void EnableVsyncBeforeRender(bool enabled) override {}
+    void Vsync() override {}
+    void RenderSpritesAtScreenResolution(bool enabled, int supersampling) override {}
+    void SetRenderThreads(int count) override { _renderer.SetThreadCount(count); }
+    void SetFrameDump(int interval, const String &dir) override;
+    bool RequiresFullRedrawEachFrame() override { return false; }
+    bool HasAcceleratedTransform() override { return false; }
+    bool UsesMemoryBackBuffer() override { return true; }
+    Bitmap *GetMemoryBackBuffer() override;
+    void SetMemoryBackBuffer(Bitmap *backBuffer) override;
+    Bitmap *GetStageBackBuffer() override;
+    void ToggleFullscreen() override {}
+
+    typedef std::shared_ptr<NullGfxFilter> PNullFilter;
+
+    void SetGraphicsFilter(PNullFilter filter);
+
+private:
+    void InitSpriteBatch(size_t index, const SpriteBatchDesc &desc) override;
+    void ResetAllBatches() override;
+
+    // Use gfx filter to create a new virtual screen
+    void CreateVirtualScreen();
+    void DestroyVirtualScreen();
+    // Unset parameters and release resources related to the display mode
+    void ReleaseDisplayMode();
+    // Renders single sprite batch on the precreated surface
+    void RenderSpriteBatch(const MemorySpriteBatch &batch, Common::Bitmap *surface, int surf_offx, int surf_offy);
+    // Saves the frame to disk, if it's time to
+    void DumpFrame();
+
+    PNullFilter _filter;
+
+    // Memory bitmap which serves as the Allegro's screen
+    BITMAP *_screenBmp;
+    Bitmap *_screenWrapper;
+    // Original and current virtual screen; see the software renderer
+    // for the explanation of these
+    Bitmap *_origVirtualScreen;
+    Bitmap *_virtualScreen;
+    Point   _virtualScrOff;
+    Bitmap *_stageVirtualScreen;
+    int _tint_red, _tint_green, _tint_blue;
+
+    MemorySpriteBatches _spriteBatches;
+    MemoryBatchRenderer _renderer;
+
+    // Number of frames between the saved ones, 0 if the frames are not saved
+    int      _frameDumpInterval;
+    String   _frameDumpDir;
+    uint32_t _frameCount;
+};
+
+
+class NullGraphicsFactory final : public GfxDriverFactoryBase<NullGraphicsDriver, NullGfxFilter>
+{
+public:
+    ~NullGraphicsFactory() override;
+
+    size_t               GetFilterCount() const override;
+    const GfxFilterInfo *GetFilterInfo(size_t index) const override;
+    String               GetDefaultFilterID() const override;
+
+    static NullGraphicsFactory *GetFactory();
+
+private:
+    NullGraphicsDriver *EnsureDriverCreated() override;
+    NullGfxFilter      *CreateFilter(const String &id) override;
+
+    static NullGraphicsFactory *_factory;
+};
+
+} // namespace Null
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_GFX__ALI3D_NULL_H
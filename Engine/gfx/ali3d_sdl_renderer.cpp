@@ -19,6 +19,7 @@
 
 #include "gfx/ali3dexception.h"
 #include "gfx/ali3d_sdl_renderer.h"
+#include "gfx/blender.h"
 #include "gfx/gfxfilter_sdl_renderer.h"
 #include "gfx/gfx_util.h"
 #include "main/main_allegro.h"
@@ -434,13 +435,13 @@ int SDLRendererGraphicsDriver::GetCompatibleBitmapFormat(int color_depth)
 
 IDriverDependantBitmap* SDLRendererGraphicsDriver::CreateDDBFromBitmap(Bitmap *bitmap, bool hasAlpha, bool opaque)
 {
-  SDLRendererBitmap* newBitmap = new SDLRendererBitmap(bitmap, opaque, hasAlpha);
+  MemoryDDB* newBitmap = new MemoryDDB(bitmap, opaque, hasAlpha);
   return newBitmap;
 }
 
 void SDLRendererGraphicsDriver::UpdateDDBFromBitmap(IDriverDependantBitmap* bitmapToUpdate, Bitmap *bitmap, bool hasAlpha)
 {
-  SDLRendererBitmap* alSwBmp = (SDLRendererBitmap*)bitmapToUpdate;
+  MemoryDDB* alSwBmp = (MemoryDDB*)bitmapToUpdate;
   alSwBmp->_bmp = bitmap;
   alSwBmp->_hasAlpha = hasAlpha;
 }
@@ -454,43 +455,18 @@ void SDLRendererGraphicsDriver::InitSpriteBatch(size_t index, const SpriteBatchD
 {
     if (_spriteBatches.size() <= index)
         _spriteBatches.resize(index + 1);
-    ALSpriteBatch &batch = _spriteBatches[index];
-    batch.List.clear();
-    // TODO: correct offsets to have pre-scale (source) and post-scale (dest) offsets!
-    int src_w = desc.Viewport.GetWidth() / desc.Transform.ScaleX;
-    int src_h = desc.Viewport.GetHeight() / desc.Transform.ScaleY;
-    if (desc.Surface != NULL)
-    {
-        batch.Surface = std::static_pointer_cast<Bitmap>(desc.Surface);
-        batch.Opaque = true;
-    }
-    else if (desc.Viewport.IsEmpty() || !virtualScreen)
-    {
-        batch.Surface.reset();
-        batch.Opaque = false;
-    }
-    else if (desc.Transform.ScaleX == 1.f && desc.Transform.ScaleY == 1.f)
-    {
-        Rect rc = RectWH(desc.Viewport.Left - _virtualScrOff.X, desc.Viewport.Top - _virtualScrOff.Y, desc.Viewport.GetWidth(), desc.Viewport.GetHeight());
-        batch.Surface.reset(BitmapHelper::CreateSubBitmap(virtualScreen, rc));
-        batch.Opaque = true;
-    }
-    else if (!batch.Surface || batch.Surface->GetWidth() != src_w || batch.Surface->GetHeight() != src_h)
-    {
-        batch.Surface.reset(new Bitmap(src_w, src_h));
-        batch.Opaque = false;
-    }
+    MemoryBatchRenderer::InitSpriteBatch(_spriteBatches[index], desc, virtualScreen, _virtualScrOff);
 }
 
 void SDLRendererGraphicsDriver::ResetAllBatches()
 {
-    for (ALSpriteBatches::iterator it = _spriteBatches.begin(); it != _spriteBatches.end(); ++it)
+    for (MemorySpriteBatches::iterator it = _spriteBatches.begin(); it != _spriteBatches.end(); ++it)
         it->List.clear();
 }
 
 void SDLRendererGraphicsDriver::DrawSprite(int x, int y, IDriverDependantBitmap* bitmap)
 {
-    _spriteBatches[_actSpriteBatch].List.push_back(ALDrawListEntry((SDLRendererBitmap*)bitmap, x, y));
+    _spriteBatches[_actSpriteBatch].List.push_back(MemoryDrawListEntry((MemoryDDB*)bitmap, x, y));
 }
 
 void SDLRendererGraphicsDriver::RenderToBackBuffer()
@@ -510,7 +486,7 @@ void SDLRendererGraphicsDriver::RenderToBackBuffer()
     {
         const Rect &viewport = _spriteBatchDesc[i].Viewport;
         const SpriteTransform &transform = _spriteBatchDesc[i].Transform;
-        const ALSpriteBatch &batch = _spriteBatches[i];
+        const MemorySpriteBatch &batch = _spriteBatches[i];
 
         virtualScreen->SetClip(Rect::MoveBy(viewport, -_virtualScrOff.X, -_virtualScrOff.Y));
         Bitmap *surface = batch.Surface.get();
@@ -537,94 +513,12 @@ void SDLRendererGraphicsDriver::RenderToBackBuffer()
 }
 
 
-// add the alpha values together, used for compositing alpha images
-static unsigned long _trans_alpha_blender32(unsigned long x, unsigned long y, unsigned long n)
+void SDLRendererGraphicsDriver::RenderSpriteBatch(const MemorySpriteBatch &batch, Common::Bitmap *surface, int surf_offx, int surf_offy)
 {
-   unsigned long res, g;
-
-   n = (n * geta32(x)) / 256;
-
-   if (n)
-      n++;
-
-   res = ((x & 0xFF00FF) - (y & 0xFF00FF)) * n / 256 + y;
-   y &= 0xFF00;
-   x &= 0xFF00;
-   g = (x - y) * n / 256 + y;
-
-   res &= 0xFF00FF;
-   g &= 0xFF00;
-
-   return res | g;
-}
-
-void SDLRendererGraphicsDriver::RenderSpriteBatch(const ALSpriteBatch &batch, Common::Bitmap *surface, int surf_offx, int surf_offy)
-{
-  const std::vector<ALDrawListEntry> &drawlist = batch.List;
-  for (size_t i = 0; i < drawlist.size(); i++)
-  {
-    if (drawlist[i].bitmap == NULL)
-    {
-      if (_nullSpriteCallback)
-        _nullSpriteCallback(drawlist[i].x, drawlist[i].y);
-      else
-        throw Ali3DException("Unhandled attempt to draw null sprite");
-
-      continue;
-    }
-
-    SDLRendererBitmap* bitmap = drawlist[i].bitmap;
-    int drawAtX = drawlist[i].x + surf_offx;
-    int drawAtY = drawlist[i].y + surf_offy;
-
-    if ((bitmap->_opaque) && (bitmap->_bmp == surface))
-    { }
-    else if (bitmap->_opaque)
-    {
-        surface->Blit(bitmap->_bmp, 0, 0, drawAtX, drawAtY, bitmap->_bmp->GetWidth(), bitmap->_bmp->GetHeight());
-    }
-    else if (bitmap->_transparency >= 255)
-    {
-      // fully transparent... invisible, do nothing
-    }
-    else if (bitmap->_hasAlpha)
-    {
-      if (bitmap->_transparency == 0) // this means opaque
-        set_alpha_blender();
-      else
-        // here _transparency is used as alpha (between 1 and 254)
-        set_blender_mode(NULL, NULL, _trans_alpha_blender32, 0, 0, 0, bitmap->_transparency);
-
-      surface->TransBlendBlt(bitmap->_bmp, drawAtX, drawAtY);
-    }
-    else
-    {
-      // here _transparency is used as alpha (between 1 and 254), but 0 means opaque!
-      GfxUtil::DrawSpriteWithTransparency(surface, bitmap->_bmp, drawAtX, drawAtY,
-          bitmap->_transparency ? bitmap->_transparency : 255);
-    }
-  }
-
-  if (((_tint_red > 0) || (_tint_green > 0) || (_tint_blue > 0))
-      && (_mode.ColorDepth > 8)) {
-    // Common::gl_ScreenBmp tint
-    // This slows down the game no end, only experimental ATM
-    set_trans_blender(_tint_red, _tint_green, _tint_blue, 0);
-    surface->LitBlendBlt(surface, 0, 0, 128);
-/*  This alternate method gives the correct (D3D-style) result, but is just too slow!
-    if ((_spareTintingScreen != NULL) &&
-        ((_spareTintingScreen->GetWidth() != surface->GetWidth()) || (_spareTintingScreen->GetHeight() != surface->GetHeight())))
-    {
-      destroy_bitmap(_spareTintingScreen);
-      _spareTintingScreen = NULL;
-    }
-    if (_spareTintingScreen == NULL)
-    {
-      _spareTintingScreen = BitmapHelper::CreateBitmap_(GetColorDepth(surface), surface->GetWidth(), surface->GetHeight());
-    }
-    tint_image(surface, _spareTintingScreen, _tint_red, _tint_green, _tint_blue, 100, 255);
-    Blit(_spareTintingScreen, surface, 0, 0, 0, 0, _spareTintingScreen->GetWidth(), _spareTintingScreen->GetHeight());*/
-  }
+  // the screen tint is not applied to the 8-bit game
+  const bool do_tint = _mode.ColorDepth > 8;
+  _renderer.RenderSpriteBatch(batch, surface, surf_offx, surf_offy, _nullSpriteCallback,
+      do_tint ? _tint_red : 0, do_tint ? _tint_green : 0, do_tint ? _tint_blue : 0);
 }
 
 void SDLRendererGraphicsDriver::BlitToTexture()
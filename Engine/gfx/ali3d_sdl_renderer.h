@@ -29,6 +29,7 @@
 #include "gfx/gfxdriverfactorybase.h"
 #include "gfx/gfxdriverbase.h"
 #include "gfx/gfxfilter_sdl_renderer.h"
+#include "gfx/memoryrenderer.h"
 
 namespace AGS
 {
@@ -40,64 +41,6 @@ namespace SDLRenderer
 class SDLRendererGfxFilter;
 using AGS::Common::Bitmap;
 
-class SDLRendererBitmap final : public IDriverDependantBitmap
-{
-public:
-    // NOTE by CJ:
-    // Transparency is a bit counter-intuitive
-    // 0=not transparent, 255=invisible, 1..254 barely visible .. mostly visible
-    virtual void SetTransparency(int transparency) override { _transparency = transparency; }
-    virtual void SetFlippedLeftRight(bool isFlipped) override { _flipped = isFlipped; }
-    virtual void SetStretch(int width, int height, bool useResampler = true) override
-    {
-        _stretchToWidth = width;
-        _stretchToHeight = height;
-    }
-    virtual int GetWidth() override { return _width; }
-    virtual int GetHeight() override { return _height; }
-    virtual int GetColorDepth() override { return _colDepth; }
-    virtual void SetLightLevel(int lightLevel) override { }
-    virtual void SetTint(int red, int green, int blue, int tintSaturation) override { }
-
-    SDLRendererBitmap(Bitmap *bmp, bool opaque, bool hasAlpha)
-    {
-        _bmp = bmp;
-        _width = bmp->GetWidth();
-        _height = bmp->GetHeight();
-        _colDepth = bmp->GetColorDepth();
-        _flipped = false;
-        _stretchToWidth = 0;
-        _stretchToHeight = 0;
-        _transparency = 0;
-        _opaque = opaque;
-        _hasAlpha = hasAlpha;
-    }
-
-    int GetWidthToRender() { return (_stretchToWidth > 0) ? _stretchToWidth : _width; }
-    int GetHeightToRender() { return (_stretchToHeight > 0) ? _stretchToHeight : _height; }
-
-    void Dispose()
-    {
-        // do we want to free the bitmap?
-    }
-
-    ~SDLRendererBitmap()
-    {
-        Dispose();
-    }
-
-public:     
-    Bitmap *_bmp;
-    int _width, _height;
-    int _colDepth;
-    bool _flipped;
-    int _stretchToWidth, _stretchToHeight;
-    bool _opaque;
-    bool _hasAlpha;
-    int _transparency;
-};
-
-
 class SDLRendererGfxModeList final : public IGfxModeList
 {
 public:
@@ -118,20 +61,6 @@ private:
 };
 
 
-typedef SpriteDrawListEntry<SDLRendererBitmap> ALDrawListEntry;
-// Software renderer's sprite batch
-struct ALSpriteBatch final
-{
-    // List of sprites to render
-    std::vector<ALDrawListEntry> List;
-    // Intermediate surface which will be drawn upon and transformed if necessary
-    std::shared_ptr<Bitmap>      Surface;
-    // Tells whether the surface is treated as opaque or transparent
-    bool                         Opaque;
-};
-typedef std::vector<ALSpriteBatch> ALSpriteBatches;
-
-
 class SDLRendererGraphicsDriver final : public GraphicsDriverBase
 {
 public:
@@ -171,6 +100,7 @@ public:
     virtual void EnableVsyncBeforeRender(bool enabled) override { }
     virtual void Vsync() override;
     virtual void RenderSpritesAtScreenResolution(bool enabled, int supersampling) override { }
+    virtual void SetRenderThreads(int count) override { _renderer.SetThreadCount(count); }
     virtual bool RequiresFullRedrawEachFrame() override { return false; }
     virtual bool HasAcceleratedTransform() override { return false; }
     virtual bool UsesMemoryBackBuffer() override { return true; }
@@ -230,7 +160,8 @@ private:
     Bitmap *_stageVirtualScreen;
     int _tint_red, _tint_green, _tint_blue;
 
-    ALSpriteBatches _spriteBatches;
+    MemorySpriteBatches _spriteBatches;
+    MemoryBatchRenderer _renderer;
     GFX_MODE_LIST *_gfxModeList;
 
     void UnInit();
@@ -246,7 +177,7 @@ private:
     // Unset parameters and release resources related to the display mode
     void ReleaseDisplayMode();
     // Renders single sprite batch on the precreated surface
-    void RenderSpriteBatch(const ALSpriteBatch &batch, Common::Bitmap *surface, int surf_offx, int surf_offy);
+    void RenderSpriteBatch(const MemorySpriteBatch &batch, Common::Bitmap *surface, int surf_offx, int surf_offy);
 
     int  GetAllegroGfxDriverID(bool windowed);
 };
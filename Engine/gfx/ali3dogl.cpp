@@ -130,6 +130,13 @@ void ogl_dummy_vsync() { }
 
 #define GFX_OPENGL  AL_ID('O','G','L',' ')
 
+// Size of the atlas page texture, unless the card's limit is lower
+static const int AtlasPageSize = 1024;
+// Max number of the atlas pages; the rest of the images get textures of their own
+static const size_t AtlasMaxPages = 8;
+// Largest image which is put into the atlas
+static const int AtlasMaxImageSize = 128;
+
 static int ogl_show_mouse(struct BITMAP *bmp, int x, int y) {
     SDL_ShowCursor(SDL_ENABLE);
     return -1; // show cursor, but "fail" because we're not supporting hardware cursors
@@ -181,8 +188,12 @@ void OGLBitmap::Dispose()
 {
     if (_tiles != nullptr)
     {
-        for (int i = 0; i < _numTiles; i++)
-            glDeleteTextures(1, &(_tiles[i].texture));
+        // the atlas page texture is shared, and is deleted by the driver
+        if (!_atlasRegion.IsValid())
+        {
+            for (int i = 0; i < _numTiles; i++)
+                glDeleteTextures(1, &(_tiles[i].texture));
+        }
 
         free(_tiles);
         _tiles = nullptr;
@@ -339,6 +350,12 @@ void OGLGraphicsDriver::FirstTimeInit()
   
   TestRenderToTexture();
   CreateShaders();
+
+  int max_texture_size = 0;
+  glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_texture_size);
+  const int atlas_page_size = std::min(AtlasPageSize, max_texture_size);
+  if (atlas_page_size > AtlasMaxImageSize + 2)
+    _atlas.Init(atlas_page_size, atlas_page_size, AtlasMaxPages);
   _firstTimeInit = true;
 }
 
@@ -887,6 +904,7 @@ void OGLGraphicsDriver::UnInit()
   OnUnInit();
   ReleaseDisplayMode();
 
+  DeleteAtlasTextures();
   DeleteGlContext();
 
   DeleteShaderProgram(_tintShader);
@@ -1017,14 +1035,15 @@ void OGLGraphicsDriver::_renderSprite(const OGLDrawListEntry *drawListEntry, con
   if (bmpToDraw->_transparency >= 255)
     return;
 
+  QuadBatchState state;
   const bool do_tint = bmpToDraw->_tintSaturation > 0 && _tintShader.Program > 0;
   const bool do_light = bmpToDraw->_tintSaturation == 0 && bmpToDraw->_lightLevel > 0 && _lightShader.Program > 0;
   if (do_tint)
   {
     // Use tinting shader
-    glUseProgram(_tintShader.Program);
-    float rgb[3];
-    float sat_trs_lum[3]; // saturation / transparency / luminance
+    state.Program = _tintShader.Program;
+    float *rgb = state.Color;
+    float *sat_trs_lum = state.Aux; // saturation / transparency / luminance
     if (_legacyPixelShader)
     {
       rgb_to_hsv(bmpToDraw->_red, bmpToDraw->_green, bmpToDraw->_blue, &rgb[0], &rgb[1], &rgb[2]);
@@ -1048,15 +1067,11 @@ void OGLGraphicsDriver::_renderSprite(const OGLDrawListEntry *drawListEntry, con
       sat_trs_lum[2] = (float)bmpToDraw->_lightLevel / 255.0;
     else
       sat_trs_lum[2] = 1.0f;
-
-    glUniform1i(_tintShader.SamplerVar, 0);
-    glUniform3f(_tintShader.ColorVar, rgb[0], rgb[1], rgb[2]);
-    glUniform3f(_tintShader.AuxVar, sat_trs_lum[0], sat_trs_lum[1], sat_trs_lum[2]);
   }
   else if (do_light)
   {
     // Use light shader
-    glUseProgram(_lightShader.Program);
+    state.Program = _lightShader.Program;
     float light_lev = 1.0f;
     float alpha = 1.0f;
 
@@ -1079,18 +1094,40 @@ void OGLGraphicsDriver::_renderSprite(const OGLDrawListEntry *drawListEntry, con
     if (bmpToDraw->_transparency > 0)
       alpha = bmpToDraw->_transparency / 255.f;
 
-    glUniform1i(_lightShader.SamplerVar, 0);
-    glUniform1f(_lightShader.ColorVar, light_lev);
-    glUniform1f(_lightShader.AuxVar, alpha);
+    state.Color[0] = light_lev;
+    state.Aux[0] = alpha;
   }
   else
   {
     // Use default processing
     if (bmpToDraw->_transparency == 0)
-      glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+      state.Aux[0] = 1.0f;
     else
-      glColor4f(1.0f, 1.0f, 1.0f, bmpToDraw->_transparency / 255.0f);
+      state.Aux[0] = bmpToDraw->_transparency / 255.0f;
+  }
+
+  if ((_smoothScaling) && bmpToDraw->_useResampler && (bmpToDraw->_stretchToHeight > 0) &&
+      ((bmpToDraw->_stretchToHeight != bmpToDraw->_height) ||
+       (bmpToDraw->_stretchToWidth != bmpToDraw->_width)))
+    state.Filter = kQuadFilter_Linear;
+  else if (_do_render_to_texture)
+    state.Filter = kQuadFilter_Nearest;
+  else
+    state.Filter = kQuadFilter_Standard;
+
+  // Origin is at the middle of the surface
+  float centerX, centerY;
+  if (_do_render_to_texture)
+  {
+    centerX = _backRenderSize.Width / 2.0f;
+    centerY = _backRenderSize.Height / 2.0f;
+  }
+  else
+  {
+    centerX = _srcRect.GetWidth() / 2.0f;
+    centerY = _srcRect.GetHeight() / 2.0f;
   }
+  const GLfloat *m = matGlobal.m;
 
   float width = bmpToDraw->GetWidthToRender();
   float height = bmpToDraw->GetHeightToRender();
@@ -1114,7 +1151,7 @@ void OGLGraphicsDriver::_renderSprite(const OGLDrawListEntry *drawListEntry, con
     thisX = (-(_srcRect.GetWidth() / 2)) + thisX;
     thisY = (_srcRect.GetHeight() / 2) - thisY;
 
-    //Setup translation and scaling matrices
+    //Setup translation and scaling
     float widthToScale = (float)width;
     float heightToScale = (float)height;
     if (bmpToDraw->_flipped)
@@ -1126,60 +1163,101 @@ void OGLGraphicsDriver::_renderSprite(const OGLDrawListEntry *drawListEntry, con
       thisX += width;
     }
 
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-
-    //
-    // IMPORTANT: in OpenGL order of transformation is REVERSE to the order of commands!
-    //
-    // Origin is at the middle of the surface
-    if (_do_render_to_texture)
-      glTranslatef(_backRenderSize.Width / 2.0f, _backRenderSize.Height / 2.0f, 0.0f);
-    else
-      glTranslatef(_srcRect.GetWidth() / 2.0f, _srcRect.GetHeight() / 2.0f, 0.0f);
-
-    // Global batch transform
-    glMultMatrixf(matGlobal.m);
-    // Self sprite transform (first scale, then rotate and then translate, reversed)
-    glTranslatef((float)thisX, (float)thisY, 0.0f);
-    glRotatef(0.f, 0.f, 0.f, 1.f);
-    glScalef(widthToScale, heightToScale, 1.0f);
+    state.Texture = bmpToDraw->_tiles[ti].texture;
+    if (!_quadVertices.empty() && !(state == _quadState))
+      FlushQuads();
+    _quadState = state;
+
+    // Transform the tile's vertices on CPU, so that the batch could be drawn
+    // at once: first scale and translate the sprite, then apply the global
+    // batch transform, and finally move the origin to the surface's middle.
+    const OGLCUSTOMVERTEX *src = (bmpToDraw->_vertex != nullptr) ? &bmpToDraw->_vertex[ti * 4] : defaultVertices;
+    OGLCUSTOMVERTEX quad[4];
+    for (int v = 0; v < 4; ++v)
+    {
+      const float x = thisX + src[v].position.x * widthToScale;
+      const float y = thisY + src[v].position.y * heightToScale;
+      quad[v].position.x = m[0] * x + m[4] * y + m[12] + centerX;
+      quad[v].position.y = m[1] * x + m[5] * y + m[13] + centerY;
+      quad[v].tu = src[v].tu;
+      quad[v].tv = src[v].tv;
+    }
+    // Triangle strip's quad is made of two triangles: 0-1-2 and 2-1-3
+    _quadVertices.push_back(quad[0]);
+    _quadVertices.push_back(quad[1]);
+    _quadVertices.push_back(quad[2]);
+    _quadVertices.push_back(quad[2]);
+    _quadVertices.push_back(quad[1]);
+    _quadVertices.push_back(quad[3]);
+    _renderStats.Sprites++;
+  }
+}
 
-    glBindTexture(GL_TEXTURE_2D, bmpToDraw->_tiles[ti].texture);
+void OGLGraphicsDriver::FlushQuads()
+{
+  if (_quadVertices.empty())
+    return;
 
-    if ((_smoothScaling) && bmpToDraw->_useResampler && (bmpToDraw->_stretchToHeight > 0) &&
-        ((bmpToDraw->_stretchToHeight != bmpToDraw->_height) ||
-         (bmpToDraw->_stretchToWidth != bmpToDraw->_width)))
+  const QuadBatchState &state = _quadState;
+  const bool shader_changed = !_hasAppliedState || state.Program != _appliedState.Program ||
+    memcmp(state.Color, _appliedState.Color, sizeof(state.Color)) != 0 ||
+    memcmp(state.Aux, _appliedState.Aux, sizeof(state.Aux)) != 0;
+  if (shader_changed)
+  {
+    glUseProgram(state.Program);
+    if (state.Program == 0)
     {
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+      glColor4f(1.0f, 1.0f, 1.0f, state.Aux[0]);
     }
-    else if (_do_render_to_texture)
+    else if (state.Program == _tintShader.Program)
     {
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+      glUniform1i(_tintShader.SamplerVar, 0);
+      glUniform3f(_tintShader.ColorVar, state.Color[0], state.Color[1], state.Color[2]);
+      glUniform3f(_tintShader.AuxVar, state.Aux[0], state.Aux[1], state.Aux[2]);
     }
     else
     {
-      _filter->SetFilteringForStandardSprite();
+      glUniform1i(_lightShader.SamplerVar, 0);
+      glUniform1f(_lightShader.ColorVar, state.Color[0]);
+      glUniform1f(_lightShader.AuxVar, state.Aux[0]);
     }
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+  }
 
-    if (bmpToDraw->_vertex != nullptr)
-    {
-      glTexCoordPointer(2, GL_FLOAT, sizeof(OGLCUSTOMVERTEX), &(bmpToDraw->_vertex[ti * 4].tu));
-      glVertexPointer(2, GL_FLOAT, sizeof(OGLCUSTOMVERTEX), &(bmpToDraw->_vertex[ti * 4].position));
-    }
-    else
+  // Filtering and wrapping are the parameters of the texture object,
+  // so they have to be set again whenever another texture is bound
+  const bool texture_changed = !_hasAppliedState || state.Texture != _appliedState.Texture;
+  if (texture_changed)
+  {
+    glBindTexture(GL_TEXTURE_2D, state.Texture);
+    _renderStats.TextureBinds++;
+  }
+  if (texture_changed || state.Filter != _appliedState.Filter)
+  {
+    switch (state.Filter)
     {
-      glTexCoordPointer(2, GL_FLOAT, sizeof(OGLCUSTOMVERTEX), &defaultVertices[0].tu);
-      glVertexPointer(2, GL_FLOAT, sizeof(OGLCUSTOMVERTEX), &defaultVertices[0].position);
+    case kQuadFilter_Linear:
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+      break;
+    case kQuadFilter_Nearest:
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+      break;
+    default:
+      _filter->SetFilteringForStandardSprite();
+      break;
     }
-
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
   }
-  glUseProgram(0);
+  _appliedState = state;
+  _hasAppliedState = true;
+
+  glTexCoordPointer(2, GL_FLOAT, sizeof(OGLCUSTOMVERTEX), &_quadVertices[0].tu);
+  glVertexPointer(2, GL_FLOAT, sizeof(OGLCUSTOMVERTEX), &_quadVertices[0].position);
+  glDrawArrays(GL_TRIANGLES, 0, _quadVertices.size());
+  _renderStats.DrawCalls++;
+  _quadVertices.clear();
 }
 
 void OGLGraphicsDriver::_render(bool clearDrawListAfterwards)
@@ -1236,6 +1314,7 @@ void OGLGraphicsDriver::_render(bool clearDrawListAfterwards)
     glLoadIdentity();
   }
 
+  _renderStats = RenderStats();
   RenderSpriteBatches();
 
   if (_do_render_to_texture)
@@ -1266,6 +1345,7 @@ void OGLGraphicsDriver::_render(bool clearDrawListAfterwards)
     glVertexPointer(2, GL_FLOAT, 0, _backbuffer_vertices);
     glClear(GL_COLOR_BUFFER_BIT);
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    _renderStats.DrawCalls++;
 
     glEnable(GL_BLEND);
   }
@@ -1295,6 +1375,10 @@ void OGLGraphicsDriver::RenderSpriteBatches()
     // TODO: also maybe sync scissor code logic with D3D renderer
     if (_do_render_to_texture)
         glEnable(GL_SCISSOR_TEST);
+    // Sprite vertices are transformed on CPU, see _renderSprite()
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+    _hasAppliedState = false;
 
     for (size_t i = 0; i <= _actSpriteBatch; ++i)
     {
@@ -1314,6 +1398,7 @@ void OGLGraphicsDriver::RenderSpriteBatches()
         RenderSpriteBatch(batch);
     }
 
+    glUseProgram(0);
     _stageVirtualScreen = GetStageScreen(0);
     glScissor(main_viewport.Left, main_viewport.Top, main_viewport.GetWidth(), main_viewport.GetHeight());
     if (_do_render_to_texture)
@@ -1333,7 +1418,12 @@ void OGLGraphicsDriver::RenderSpriteBatch(const OGLSpriteBatch &batch)
     const OGLDrawListEntry *sprite = &listToDraw[i];
     if (listToDraw[i].bitmap == nullptr)
     {
-      if (DoNullSpriteCallback(listToDraw[i].x, listToDraw[i].y))
+      // plugin may draw on its own, and the stage texture gets updated
+      FlushQuads();
+      const bool has_stage = DoNullSpriteCallback(listToDraw[i].x, listToDraw[i].y);
+      // either may have bound another texture or program
+      _hasAppliedState = false;
+      if (has_stage)
         stageEntry = OGLDrawListEntry((OGLBitmap*)_stageVirtualScreenDDB);
       else
         continue;
@@ -1342,6 +1432,8 @@ void OGLGraphicsDriver::RenderSpriteBatch(const OGLSpriteBatch &batch)
 
     this->_renderSprite(sprite, batch.Matrix);
   }
+  // the next batch will have another scissor rect
+  FlushQuads();
 }
 
 void OGLGraphicsDriver::InitSpriteBatch(size_t index, const SpriteBatchDesc &desc)
@@ -1446,12 +1538,28 @@ void OGLGraphicsDriver::DestroyDDB(IDriverDependantBitmap* bitmap)
                 drawlist[i].skip = true;
         }
     }
+    ReleaseAtlasRegion((OGLBitmap*)bitmap);
     delete bitmap;
 }
 
 
-void OGLGraphicsDriver::UpdateTextureRegion(OGLTextureTile *tile, Bitmap *bitmap, OGLBitmap *target, bool hasAlpha)
+void OGLGraphicsDriver::UpdateTextureRegion(OGLTextureTile *tile, Bitmap *bitmap, OGLBitmap *target, bool hasAlpha,
+    const Rect &region)
 {
+  int tilex = 0, tiley = 0, tileWidth = tile->width, tileHeight = tile->height;
+  int texX = 0, texY = 0; // position of the uploaded area on the texture
+  const bool inAtlas = target->_atlasRegion.IsValid();
+  if (inAtlas)
+  {
+    // Atlas region has a one pixel border around the image
+    texX = target->_atlasRegion.X;
+    texY = target->_atlasRegion.Y;
+    tilex = tiley = 1;
+    tileWidth += 2;
+    tileHeight += 2;
+  }
+  else
+  {
   int textureHeight = tile->height;
   int textureWidth = tile->width;
 
@@ -1459,7 +1567,6 @@ void OGLGraphicsDriver::UpdateTextureRegion(OGLTextureTile *tile, Bitmap *bitmap
   // when texture is just created. Check later if this operation here may be removed.
   AdjustSizeToNearestSupportedByCard(&textureWidth, &textureHeight);
 
-  int tilex = 0, tiley = 0, tileWidth = tile->width, tileHeight = tile->height;
   if (textureWidth > tile->width)
   {
       int texxoff = Math::Min(textureWidth - tile->width - 1, 1);
@@ -1472,17 +1579,39 @@ void OGLGraphicsDriver::UpdateTextureRegion(OGLTextureTile *tile, Bitmap *bitmap
       tiley = texyoff;
       tileHeight += 1 + texyoff;
   }
+  } // inAtlas
 
   const bool usingLinearFiltering = _filter->UseLinearFiltering();
-  char *origPtr = (char*)malloc(sizeof(int) * tileWidth * tileHeight);
-  const int pitch = tileWidth * sizeof(int);
-  char *memPtr = origPtr + pitch * tiley + tilex * sizeof(int);
+  const bool clampEdges = usingLinearFiltering || inAtlas;
+  // Find out which part of the tile has to be converted and uploaded;
+  // upload rect is in the coordinates of the area with the texture borders
+  Rect update, convert;
+  GetTileUpdateRects(*tile, region, target->_opaque, update, convert);
+  Rect upload = Rect::MoveBy(update, tilex, tiley);
+  if (clampEdges)
+  {
+    if (update.Left == 0 && tilex > 0)
+      upload.Left--;
+    if (update.Right == tile->width - 1 && tile->width < tileWidth)
+      upload.Right++;
+    if (update.Top == 0 && tiley > 0)
+      upload.Top--;
+    if (update.Bottom == tile->height - 1 && tile->height < tileHeight)
+      upload.Bottom++;
+  }
+  // The buffer covers both the uploaded and the converted parts
+  const Rect bufRect = UnionRects(upload, Rect::MoveBy(convert, tilex, tiley));
+  const int bufWidth = bufRect.GetWidth();
+  char *origPtr = (char*)malloc(sizeof(int) * bufWidth * bufRect.GetHeight());
+  const int pitch = bufWidth * sizeof(int);
+  const int bufx = tilex - bufRect.Left, bufy = tiley - bufRect.Top; // tile's origin in the buffer
+  char *memPtr = origPtr + pitch * (bufy + convert.Top) + (bufx + convert.Left) * sizeof(int);
 
   TextureTile fixedTile;
-  fixedTile.x = tile->x;
-  fixedTile.y = tile->y;
-  fixedTile.width = Math::Min(tile->width, tileWidth);
-  fixedTile.height = Math::Min(tile->height, tileHeight);
+  fixedTile.x = tile->x + convert.Left;
+  fixedTile.y = tile->y + convert.Top;
+  fixedTile.width = convert.GetWidth();
+  fixedTile.height = convert.GetHeight();
   if (target->_opaque)
     BitmapToVideoMemOpaque(bitmap, hasAlpha, &fixedTile, target, memPtr, pitch);
   else
@@ -1490,53 +1619,76 @@ void OGLGraphicsDriver::UpdateTextureRegion(OGLTextureTile *tile, Bitmap *bitmap
 
   // Mimic the behaviour of GL_CLAMP_EDGE for the tile edges
   // NOTE: on some platforms GL_CLAMP_EDGE does not work with the version of OpenGL we're using.
-  if (usingLinearFiltering)
+  // The atlas border is always set, as the neighbour images must not show through it
+  // when the sprite is drawn with smooth scaling.
+  if (clampEdges)
   {
-  if (tile->width < tileWidth)
+  const int rowFrom = Math::Max(upload.Top, tiley) - bufRect.Top;
+  const int rowTo = Math::Min(upload.Bottom, tiley + tile->height - 1) - bufRect.Top;
+  if (upload.Left < tilex)
   {
-    if (tilex > 0)
+    for (int y = rowFrom; y <= rowTo; y++)
     {
-      for (int y = 0; y < tileHeight; y++)
-      {
-        unsigned int* edge_left_col = (unsigned int*)(origPtr + y * pitch + (tilex - 1) * sizeof(int));
-        unsigned int* bm_left_col = (unsigned int*)(origPtr + y * pitch + (tilex) * sizeof(int));
-        *edge_left_col = *bm_left_col & 0x00FFFFFF;
-      }
+      unsigned int* edge_left_col = (unsigned int*)(origPtr + y * pitch + (bufx - 1) * sizeof(int));
+      unsigned int* bm_left_col = edge_left_col + 1;
+      *edge_left_col = *bm_left_col & 0x00FFFFFF;
     }
-    for (int y = 0; y < tileHeight; y++)
+  }
+  if (upload.Right >= tilex + tile->width)
+  {
+    for (int y = rowFrom; y <= rowTo; y++)
     {
-      unsigned int* edge_right_col = (unsigned int*)(origPtr + y * pitch + (tilex + tile->width) * sizeof(int));
+      unsigned int* edge_right_col = (unsigned int*)(origPtr + y * pitch + (bufx + tile->width) * sizeof(int));
       unsigned int* bm_right_col = edge_right_col - 1;
       *edge_right_col = *bm_right_col & 0x00FFFFFF;
     }
   }
-  if (tile->height < tileHeight)
+  const int colFrom = upload.Left - bufRect.Left;
+  const int colTo = upload.Right - bufRect.Left;
+  if (upload.Top < tiley)
   {
-    if (tiley > 0)
+    unsigned int* edge_top_row = (unsigned int*)(origPtr + pitch * (bufy - 1));
+    unsigned int* bm_top_row = (unsigned int*)(origPtr + pitch * (bufy));
+    for (int x = colFrom; x <= colTo; x++)
     {
-      unsigned int* edge_top_row = (unsigned int*)(origPtr + pitch * (tiley - 1));
-      unsigned int* bm_top_row = (unsigned int*)(origPtr + pitch * (tiley));
-      for (int x = 0; x < tileWidth; x++)
-      {
-        edge_top_row[x] = bm_top_row[x] & 0x00FFFFFF;
-      }
+      edge_top_row[x] = bm_top_row[x] & 0x00FFFFFF;
     }
-    unsigned int* edge_bottom_row = (unsigned int*)(origPtr + pitch * (tiley + tile->height));
-    unsigned int* bm_bottom_row = (unsigned int*)(origPtr + pitch * (tiley + tile->height - 1));
-    for (int x = 0; x < tileWidth; x++)
+  }
+  if (upload.Bottom >= tiley + tile->height)
+  {
+    unsigned int* edge_bottom_row = (unsigned int*)(origPtr + pitch * (bufy + tile->height));
+    unsigned int* bm_bottom_row = (unsigned int*)(origPtr + pitch * (bufy + tile->height - 1));
+    for (int x = colFrom; x <= colTo; x++)
     {
       edge_bottom_row[x] = bm_bottom_row[x] & 0x00FFFFFF;
     }
   }
-  } // usingLinearFiltering
+  } // clampEdges
+
+  // Move the uploaded rows to the start of the buffer, so that they may be
+  // passed to GL without the converted margins
+  const int uploadWidth = upload.GetWidth(), uploadHeight = upload.GetHeight();
+  const int uploadPitch = uploadWidth * sizeof(int);
+  const char *uploadPtr = origPtr + pitch * (upload.Top - bufRect.Top) + (upload.Left - bufRect.Left) * sizeof(int);
+  if (uploadPtr != origPtr || uploadPitch != pitch)
+  {
+    for (int y = 0; y < uploadHeight; y++)
+      memmove(origPtr + y * uploadPitch, uploadPtr + y * pitch, uploadPitch);
+  }
 
   glBindTexture(GL_TEXTURE_2D, tile->texture);
-  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, tileWidth, tileHeight, GL_RGBA, GL_UNSIGNED_BYTE, origPtr);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, texX + upload.Left, texY + upload.Top, uploadWidth, uploadHeight,
+    GL_RGBA, GL_UNSIGNED_BYTE, origPtr);
 
   free(origPtr);
 }
 
 void OGLGraphicsDriver::UpdateDDBFromBitmap(IDriverDependantBitmap* bitmapToUpdate, Bitmap *bitmap, bool hasAlpha)
+{
+  UpdateDDBRegionFromBitmap(bitmapToUpdate, bitmap, hasAlpha, RectWH(0, 0, bitmap->GetWidth(), bitmap->GetHeight()));
+}
+
+void OGLGraphicsDriver::UpdateDDBRegionFromBitmap(IDriverDependantBitmap* bitmapToUpdate, Bitmap *bitmap, bool hasAlpha, const Rect &region)
 {
   OGLBitmap *target = (OGLBitmap*)bitmapToUpdate;
   if (target->_width != bitmap->GetWidth() || target->_height != bitmap->GetHeight())
@@ -1551,7 +1703,11 @@ void OGLGraphicsDriver::UpdateDDBFromBitmap(IDriverDependantBitmap* bitmapToUpda
 
   for (int i = 0; i < target->_numTiles; i++)
   {
-    UpdateTextureRegion(&target->_tiles[i], bitmap, target, hasAlpha);
+    // only upload the tiles which intersect the changed region
+    const TextureTile &tile = target->_tiles[i];
+    if (!AreRectsIntersecting(RectWH(tile.x, tile.y, tile.width, tile.height), region))
+      continue;
+    UpdateTextureRegion(&target->_tiles[i], bitmap, target, hasAlpha, region);
   }
 
   if (color_depth == 8)
@@ -1606,6 +1762,13 @@ IDriverDependantBitmap* OGLGraphicsDriver::CreateDDBFromBitmap(Bitmap *bitmap, b
   int colourDepth = bitmap->GetColorDepth();
 
   OGLBitmap *ddb = new OGLBitmap(bitmap->GetWidth(), bitmap->GetHeight(), colourDepth, opaque);
+  // Small images share the atlas textures; opaque ones are skipped, as they
+  // are usually large, or are solid color quads stretched across the screen
+  if (!opaque && CreateAtlasTile(ddb))
+  {
+    UpdateDDBFromBitmap(ddb, bitmap, hasAlpha);
+    return ddb;
+  }
 
   AdjustSizeToNearestSupportedByCard(&allocatedWidth, &allocatedHeight);
   int tilesAcross = 1, tilesDown = 1;
@@ -1701,15 +1864,7 @@ IDriverDependantBitmap* OGLGraphicsDriver::CreateDDBFromBitmap(Bitmap *bitmap, b
         }
       }
 
-      glGenTextures(1, &thisTile->texture);
-      glBindTexture(GL_TEXTURE_2D, thisTile->texture);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
-      // NOTE: pay attention that the texture format depends on the **display mode**'s format,
-      // rather than source bitmap's color depth!
-      glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, thisAllocatedWidth, thisAllocatedHeight, 0, GL_BGRA, GL_UNSIGNED_BYTE, nullptr);
+      thisTile->texture = CreateTexture(thisAllocatedWidth, thisAllocatedHeight);
     }
   }
 
@@ -1721,6 +1876,83 @@ IDriverDependantBitmap* OGLGraphicsDriver::CreateDDBFromBitmap(Bitmap *bitmap, b
   return ddb;
 }
 
+GLuint OGLGraphicsDriver::CreateTexture(int width, int height)
+{
+  GLuint texture;
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+  // NOTE: pay attention that the texture format depends on the **display mode**'s format,
+  // rather than source bitmap's color depth!
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_BGRA, GL_UNSIGNED_BYTE, nullptr);
+  return texture;
+}
+
+bool OGLGraphicsDriver::CreateAtlasTile(OGLBitmap *ddb)
+{
+  if (ddb->_width > AtlasMaxImageSize || ddb->_height > AtlasMaxImageSize)
+    return false;
+  AtlasRegion region;
+  if (!_atlas.Allocate(ddb->_width + 2, ddb->_height + 2, region))
+    return false;
+  if ((size_t)region.Page >= _atlasTextures.size())
+    _atlasTextures.resize(region.Page + 1);
+  if (_atlasTextures[region.Page] == 0)
+    _atlasTextures[region.Page] = CreateTexture(_atlas.GetPageWidth(), _atlas.GetPageHeight());
+
+  OGLTextureTile *tile = (OGLTextureTile*)malloc(sizeof(OGLTextureTile));
+  memset(tile, 0, sizeof(OGLTextureTile));
+  tile->width = ddb->_width;
+  tile->height = ddb->_height;
+  tile->texture = _atlasTextures[region.Page];
+
+  // Map the vertices onto the image inside the region's border
+  const float page_w = (float)_atlas.GetPageWidth();
+  const float page_h = (float)_atlas.GetPageHeight();
+  OGLCUSTOMVERTEX *vertices = (OGLCUSTOMVERTEX*)malloc(4 * sizeof(OGLCUSTOMVERTEX));
+  for (int vidx = 0; vidx < 4; vidx++)
+  {
+    vertices[vidx] = defaultVertices[vidx];
+    vertices[vidx].tu = (region.X + 1 + (vertices[vidx].tu > 0.0 ? ddb->_width : 0)) / page_w;
+    vertices[vidx].tv = (region.Y + 1 + (vertices[vidx].tv > 0.0 ? ddb->_height : 0)) / page_h;
+  }
+
+  ddb->_atlasRegion = region;
+  ddb->_numTiles = 1;
+  ddb->_tiles = tile;
+  ddb->_vertex = vertices;
+  return true;
+}
+
+void OGLGraphicsDriver::ReleaseAtlasRegion(OGLBitmap *ddb)
+{
+  if (!ddb->_atlasRegion.IsValid())
+    return;
+  const size_t page = ddb->_atlasRegion.Page;
+  if (_atlas.Free(ddb->_atlasRegion) && page < _atlasTextures.size())
+  {
+    // No more images on this page, give its memory back
+    glDeleteTextures(1, &_atlasTextures[page]);
+    _atlasTextures[page] = 0;
+  }
+  ddb->_atlasRegion = AtlasRegion();
+  ddb->_tiles[0].texture = 0;
+}
+
+void OGLGraphicsDriver::DeleteAtlasTextures()
+{
+  for (size_t i = 0; i < _atlasTextures.size(); ++i)
+  {
+    if (_atlasTextures[i] != 0)
+      glDeleteTextures(1, &_atlasTextures[i]);
+  }
+  _atlasTextures.clear();
+  _atlas.Reset();
+}
+
 void OGLGraphicsDriver::do_fade(bool fadingOut, int speed, int targetColourRed, int targetColourGreen, int targetColourBlue)
 {
   // Construct scene in order: game screen, fade fx, post game overlay
@@ -20,6 +20,8 @@
 #define __AGS_EE_GFX__ALI3DOGL_H
 
 #include <memory>
+#include <string.h>
+#include <vector>
 #include "gfx/bitmap.h"
 #include "gfx/ddb.h"
 #include "gfx/gfxdriverfactorybase.h"
@@ -92,6 +94,9 @@ public:
     OGLCUSTOMVERTEX* _vertex;
     OGLTextureTile *_tiles;
     int _numTiles;
+    // Location in the atlas, if the image is stored there; in such case
+    // the only tile refers to the shared page texture
+    AtlasRegion _atlasRegion;
 
     OGLBitmap(int width, int height, int colDepth, bool opaque)
     {
@@ -187,6 +192,7 @@ public:
     int  GetCompatibleBitmapFormat(int color_depth) override;
     IDriverDependantBitmap* CreateDDBFromBitmap(Bitmap *bitmap, bool hasAlpha, bool opaque) override;
     void UpdateDDBFromBitmap(IDriverDependantBitmap* bitmapToUpdate, Bitmap *bitmap, bool hasAlpha) override;
+    void UpdateDDBRegionFromBitmap(IDriverDependantBitmap* bitmapToUpdate, Bitmap *bitmap, bool hasAlpha, const Rect &region) override;
     void DestroyDDB(IDriverDependantBitmap* bitmap) override;
     void DrawSprite(int x, int y, IDriverDependantBitmap* bitmap) override;
     void RenderToBackBuffer() override;
@@ -253,6 +259,37 @@ private:
     ShaderProgram _tintShader;
     ShaderProgram _lightShader;
 
+    // Texture filtering mode of the sprite
+    enum QuadFilter
+    {
+        kQuadFilter_Standard, // set by the graphics filter
+        kQuadFilter_Linear,
+        kQuadFilter_Nearest
+    };
+    // Render state of the sprite tile; consecutive tiles which share
+    // the same state are drawn with a single draw call
+    struct QuadBatchState
+    {
+        GLuint Texture;
+        int    Filter;   // QuadFilter
+        GLuint Program;  // shader program, or 0 for the default processing
+        float  Color[3]; // shader's primary variable
+        float  Aux[3];   // shader's auxiliary variable, or vertex alpha
+
+        QuadBatchState()
+            : Texture(0), Filter(kQuadFilter_Standard), Program(0), Color(), Aux() {}
+        bool operator ==(const QuadBatchState &other) const
+        {
+            return Texture == other.Texture && Filter == other.Filter && Program == other.Program &&
+                memcmp(Color, other.Color, sizeof(Color)) == 0 && memcmp(Aux, other.Aux, sizeof(Aux)) == 0;
+        }
+    };
+    // Transformed vertices of the queued tiles, two triangles per tile
+    std::vector<OGLCUSTOMVERTEX> _quadVertices;
+    QuadBatchState _quadState;    // state of the queued tiles
+    QuadBatchState _appliedState; // state last set to the GL context
+    bool _hasAppliedState {};     // tells if the context state is known
+
     int device_screen_physical_width;
     int device_screen_physical_height;
 
@@ -274,6 +311,8 @@ private:
     Size _backRenderSize {};
     // Actual size of the backbuffer texture, created by OpenGL
     Size _backTextureSize {};
+    // Textures of the atlas pages, 0 for the released ones
+    std::vector<GLuint> _atlasTextures;
 
     OGLSpriteBatches _spriteBatches;
     // TODO: these draw list backups are needed only for the fade-in/out effects
@@ -318,10 +357,21 @@ private:
     // Unset parameters and release resources related to the display mode
     void ReleaseDisplayMode();
     void AdjustSizeToNearestSupportedByCard(int *width, int *height);
-    void UpdateTextureRegion(OGLTextureTile *tile, Bitmap *bitmap, OGLBitmap *target, bool hasAlpha);
+    void UpdateTextureRegion(OGLTextureTile *tile, Bitmap *bitmap, OGLBitmap *target, bool hasAlpha, const Rect &region);
+    // Creates a texture of the given size, which contents are not initialized
+    GLuint CreateTexture(int width, int height);
+    // Allocates a small DDB's image in the atlas; returns false if the DDB
+    // does not fit there and should have textures of its own
+    bool CreateAtlasTile(OGLBitmap *ddb);
+    // Frees DDB's atlas region, and deletes the page texture if it's no longer used
+    void ReleaseAtlasRegion(OGLBitmap *ddb);
+    void DeleteAtlasTextures();
     void CreateVirtualScreen();
     void do_fade(bool fadingOut, int speed, int targetColourRed, int targetColourGreen, int targetColourBlue);
+    // Queues sprite's tiles for drawing, flushing the queue if their state differs
     void _renderSprite(const OGLDrawListEntry *entry, const GLMATRIX &matGlobal);
+    // Draws queued tiles and clears the queue
+    void FlushQuads();
     void SetupViewport();
     // Converts rectangle in top->down coordinates into OpenGL's native bottom->up coordinates
     Rect ConvertTopDownRect(const Rect &top_down_rect, int surface_height);
@@ -20,6 +20,7 @@
 
 #include "core/platform.h"
 #include "gfx/ali3dexception.h"
+#include "gfx/blender.h"
 #include "gfx/gfxfilter_allegro.h"
 #include "gfx/gfxfilter_hqx.h"
 #include "gfx/gfx_util.h"
@@ -58,7 +59,6 @@ bool ALSoftwareGfxModeList::GetMode(int index, DisplayMode &mode) const
     return false;
 }
 
-unsigned long _trans_alpha_blender32(unsigned long x, unsigned long y, unsigned long n);
 RGB faded_out_palette[256];
 
 
@@ -425,7 +425,7 @@ void ALSoftwareGraphicsDriver::RenderSpriteBatch(const ALSpriteBatch &batch, Com
     {
       // draw screen tint fx
       set_trans_blender(_tint_red, _tint_green, _tint_blue, 0);
-      surface->LitBlendBlt(surface, 0, 0, 128);
+      GfxUtil::LitBlendBlt(surface, surface, 0, 0, 128);
       continue;
     }
 
@@ -450,7 +450,7 @@ void ALSoftwareGraphicsDriver::RenderSpriteBatch(const ALSpriteBatch &batch, Com
         // here _transparency is used as alpha (between 1 and 254)
         set_blender_mode(nullptr, nullptr, _trans_alpha_blender32, 0, 0, 0, bitmap->_transparency);
 
-      surface->TransBlendBlt(bitmap->_bmp, drawAtX, drawAtY);
+      GfxUtil::TransBlendBlt(surface, bitmap->_bmp, drawAtX, drawAtY);
     }
     else
     {
@@ -564,7 +564,7 @@ void ALSoftwareGraphicsDriver::highcolor_fade_in(Bitmap *vs, void(*draw_callback
    {
        bmp_buff->Fill(clearColor);
        set_trans_blender(0,0,0,a);
-       bmp_buff->TransBlendBlt(bmp_orig, 0, 0);
+       GfxUtil::TransBlendBlt(bmp_buff, bmp_orig, 0, 0);
        if (draw_callback)
        {
            draw_callback();
@@ -602,7 +602,7 @@ void ALSoftwareGraphicsDriver::highcolor_fade_out(Bitmap *vs, void(*draw_callbac
     {
         bmp_buff->Fill(clearColor);
         set_trans_blender(0, 0, 0, a);
-        bmp_buff->TransBlendBlt(bmp_orig, 0, 0);
+        GfxUtil::TransBlendBlt(bmp_buff, bmp_orig, 0, 0);
         if (draw_callback)
         {
             draw_callback();
@@ -751,28 +751,6 @@ void ALSoftwareGraphicsDriver::ToggleFullscreen() {
   sdl2_toggle_fullscreen();
 }
 
-// add the alpha values together, used for compositing alpha images
-unsigned long _trans_alpha_blender32(unsigned long x, unsigned long y, unsigned long n)
-{
-   unsigned long res, g;
-
-   n = (n * geta32(x)) / 256;
-
-   if (n)
-      n++;
-
-   res = ((x & 0xFF00FF) - (y & 0xFF00FF)) * n / 256 + y;
-   y &= 0xFF00;
-   x &= 0xFF00;
-   g = (x - y) * n / 256 + y;
-
-   res &= 0xFF00FF;
-   g &= 0xFF00;
-
-   return res | g;
-}
-
-
 ALSWGraphicsFactory *ALSWGraphicsFactory::_factory = nullptr;
 
 ALSWGraphicsFactory::~ALSWGraphicsFactory()
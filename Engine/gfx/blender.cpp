@@ -16,9 +16,21 @@
 #include "gfx/blender.h"
 #include "util/wgt2allg.h"
 
+// Row blenders are vectorized with SSE2 on x86 and NEON on ARM; these are
+// always available on the 64-bit targets, so no runtime check is needed.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define AGS_BLEND_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define AGS_BLEND_NEON 1
+#endif
+
 extern "C" {
     unsigned long _blender_trans16(unsigned long x, unsigned long y, unsigned long n);
     unsigned long _blender_trans15(unsigned long x, unsigned long y, unsigned long n);
+    unsigned long _blender_trans24(unsigned long x, unsigned long y, unsigned long n);
+    unsigned long _blender_alpha32(unsigned long x, unsigned long y, unsigned long n);
 }
 
 // the allegro "inline" ones are not actually inline, so #define
@@ -268,3 +280,424 @@ void set_opaque_alpha_blender()
 {
     set_blender_mode(nullptr, nullptr, _opaque_alpha_blender, 0, 0, 0, 0);
 }
+
+// add the alpha values together, used for compositing alpha images
+unsigned long _trans_alpha_blender32(unsigned long x, unsigned long y, unsigned long n)
+{
+   unsigned long res, g;
+
+   n = (n * geta32(x)) / 256;
+
+   if (n)
+      n++;
+
+   res = ((x & 0xFF00FF) - (y & 0xFF00FF)) * n / 256 + y;
+   y &= 0xFF00;
+   x &= 0xFF00;
+   g = (x - y) * n / 256 + y;
+
+   res &= 0xFF00FF;
+   g &= 0xFF00;
+
+   return res | g;
+}
+
+
+//-----------------------------------------------------------------------------
+// Row blenders
+//-----------------------------------------------------------------------------
+// Vectorized blenders repeat the operations of the scalar blenders on 32-bit
+// lanes. Scalar blenders keep only up to 24 lower bits of any intermediate
+// value, which are not affected by the width of unsigned long, so the
+// results are identical.
+
+#if AGS_BLEND_SSE2 || AGS_BLEND_NEON
+#define AGS_BLEND_SIMD 1
+const size_t VecSize = 4;
+
+#if AGS_BLEND_SSE2
+typedef __m128i vu32;
+static FORCEINLINE vu32 v_load(const uint32_t *p) { return _mm_loadu_si128((const __m128i*)p); }
+static FORCEINLINE void v_store(uint32_t *p, vu32 v) { _mm_storeu_si128((__m128i*)p, v); }
+static FORCEINLINE vu32 v_set1(uint32_t x) { return _mm_set1_epi32((int)x); }
+static FORCEINLINE vu32 v_and(vu32 a, vu32 b) { return _mm_and_si128(a, b); }
+static FORCEINLINE vu32 v_or(vu32 a, vu32 b) { return _mm_or_si128(a, b); }
+static FORCEINLINE vu32 v_add(vu32 a, vu32 b) { return _mm_add_epi32(a, b); }
+static FORCEINLINE vu32 v_sub(vu32 a, vu32 b) { return _mm_sub_epi32(a, b); }
+static FORCEINLINE vu32 v_mul(vu32 a, vu32 b)
+{
+    // SSE2 only multiplies even lanes into 64-bit results
+    const __m128i even = _mm_mul_epu32(a, b);
+    const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+        _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+// values are compared as signed, which is fine for the color components
+static FORCEINLINE vu32 v_min(vu32 a, vu32 b) { const vu32 gt = _mm_cmpgt_epi32(a, b); return _mm_or_si128(_mm_and_si128(gt, b), _mm_andnot_si128(gt, a)); }
+static FORCEINLINE vu32 v_eq(vu32 a, vu32 b) { return _mm_cmpeq_epi32(a, b); }
+// Selects lanes from a where mask is set, and from b elsewhere
+static FORCEINLINE vu32 v_select(vu32 mask, vu32 a, vu32 b) { return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b)); }
+#define v_shr(v, n) _mm_srli_epi32(v, n)
+#define v_shl(v, n) _mm_slli_epi32(v, n)
+#else // AGS_BLEND_NEON
+typedef uint32x4_t vu32;
+static FORCEINLINE vu32 v_load(const uint32_t *p) { return vld1q_u32(p); }
+static FORCEINLINE void v_store(uint32_t *p, vu32 v) { vst1q_u32(p, v); }
+static FORCEINLINE vu32 v_set1(uint32_t x) { return vdupq_n_u32(x); }
+static FORCEINLINE vu32 v_and(vu32 a, vu32 b) { return vandq_u32(a, b); }
+static FORCEINLINE vu32 v_or(vu32 a, vu32 b) { return vorrq_u32(a, b); }
+static FORCEINLINE vu32 v_add(vu32 a, vu32 b) { return vaddq_u32(a, b); }
+static FORCEINLINE vu32 v_sub(vu32 a, vu32 b) { return vsubq_u32(a, b); }
+static FORCEINLINE vu32 v_mul(vu32 a, vu32 b) { return vmulq_u32(a, b); }
+static FORCEINLINE vu32 v_min(vu32 a, vu32 b) { return vminq_u32(a, b); }
+static FORCEINLINE vu32 v_eq(vu32 a, vu32 b) { return vceqq_u32(a, b); }
+// Selects lanes from a where mask is set, and from b elsewhere
+static FORCEINLINE vu32 v_select(vu32 mask, vu32 a, vu32 b) { return vbslq_u32(mask, a, b); }
+#define v_shr(v, n) vshrq_n_u32(v, n)
+#define v_shl(v, n) vshlq_n_u32(v, n)
+#endif
+
+// Table of 0x10000 / n, for the final alpha in argb2argb blender
+struct AlphaDivTable
+{
+    uint32_t Value[257];
+    AlphaDivTable()
+    {
+        Value[0] = 0;
+        for (uint32_t n = 1; n <= 256; ++n)
+            Value[n] = 0x10000 / n;
+    }
+};
+static const AlphaDivTable AlphaDiv;
+
+static FORCEINLINE vu32 v_div_alpha(vu32 a)
+{
+    uint32_t n[VecSize];
+    v_store(n, a);
+    const uint32_t res[VecSize] = { AlphaDiv.Value[n[0]], AlphaDiv.Value[n[1]], AlphaDiv.Value[n[2]], AlphaDiv.Value[n[3]] };
+    return v_load(res);
+}
+
+// Increments non-zero values, as in "if (n) n++"
+static FORCEINLINE vu32 v_inc_nonzero(vu32 n)
+{
+    // equality mask is all ones, that is -1
+    return v_add(v_add(n, v_set1(1)), v_eq(n, v_set1(0)));
+}
+
+// Mask of the source pixels which have to be skipped
+static FORCEINLINE vu32 v_is_mask(vu32 c)
+{
+    return v_eq(c, v_set1(MASK_COLOR_32));
+}
+
+// Interpolates RGB proportionally to n (0 - 256), same as in _blender_trans24;
+// the resulting alpha is zero
+static FORCEINLINE vu32 v_blend_rgb(vu32 x, vu32 y, vu32 n)
+{
+    const vu32 rb_mask = v_set1(0xFF00FF);
+    const vu32 g_mask = v_set1(0xFF00);
+    const vu32 res = v_add(v_shr(v_mul(v_sub(v_and(x, rb_mask), v_and(y, rb_mask)), n), 8), y);
+    const vu32 yg = v_and(y, g_mask);
+    const vu32 g = v_add(v_shr(v_mul(v_sub(v_and(x, g_mask), yg), n), 8), yg);
+    return v_or(v_and(res, rb_mask), v_and(g, g_mask));
+}
+
+// Vectorized argb2argb_blend_core
+static FORCEINLINE vu32 v_argb2argb_blend_core(vu32 src_col, vu32 dst_col, vu32 src_alpha)
+{
+    const vu32 rb_mask = v_set1(0xFF00FF);
+    const vu32 g_mask = v_set1(0xFF00);
+    const vu32 v256 = v_set1(256);
+    src_alpha = v_add(src_alpha, v_set1(1));
+    vu32 dst_alpha = v_inc_nonzero(v_shr(dst_col, 24));
+
+    vu32 dst_g = v_shr(v_mul(v_and(dst_col, g_mask), dst_alpha), 8);
+    vu32 dst_rb = v_shr(v_mul(v_and(dst_col, rb_mask), dst_alpha), 8);
+
+    dst_g = v_and(v_add(v_shr(v_mul(v_sub(v_and(src_col, g_mask), v_and(dst_g, g_mask)), src_alpha), 8), dst_g), g_mask);
+    dst_rb = v_and(v_add(v_shr(v_mul(v_sub(v_and(src_col, rb_mask), v_and(dst_rb, rb_mask)), src_alpha), 8), dst_rb), rb_mask);
+
+    dst_alpha = v_sub(v256, v_shr(v_mul(v_sub(v256, src_alpha), v_sub(v256, dst_alpha)), 8));
+    const vu32 factor = v_div_alpha(dst_alpha);
+
+    dst_g = v_and(v_shr(v_mul(dst_g, factor), 8), g_mask);
+    dst_rb = v_and(v_shr(v_mul(dst_rb, factor), 8), rb_mask);
+    return v_or(v_or(dst_rb, dst_g), v_shl(v_sub(dst_alpha, v_set1(1)), 24));
+}
+#endif // AGS_BLEND_SSE2 || AGS_BLEND_NEON
+
+// Finishes the row with the per-pixel blender
+#define TRANS_ROW_TAIL(blender) \
+    for (; i < count; ++i) \
+    { \
+        if (src[i] != MASK_COLOR_32) \
+            dst[i] = blender(src[i], dst[i], alpha); \
+    }
+
+static void argb2argb_row(uint32_t *dst, const uint32_t *src, size_t count, unsigned long alpha)
+{
+    size_t i = 0;
+#if AGS_BLEND_SIMD
+    const vu32 k = v_set1(alpha > 0 ? (alpha & 0xFF) + 1 : 256);
+    for (; i + VecSize <= count; i += VecSize)
+    {
+        const vu32 s = v_load(src + i), d = v_load(dst + i);
+        const vu32 sa = v_shr(v_mul(v_shr(s, 24), k), 8);
+        const vu32 skip = v_or(v_is_mask(s), v_eq(sa, v_set1(0)));
+        v_store(dst + i, v_select(skip, d, v_argb2argb_blend_core(s, d, sa)));
+    }
+#endif
+    TRANS_ROW_TAIL(_argb2argb_blender)
+}
+
+static void rgb2argb_row(uint32_t *dst, const uint32_t *src, size_t count, unsigned long alpha)
+{
+    size_t i = 0;
+#if AGS_BLEND_SIMD
+    const vu32 opaque = v_set1(0xFF000000);
+    if (alpha == 0 || alpha == 0xFF)
+    {
+        for (; i + VecSize <= count; i += VecSize)
+        {
+            const vu32 s = v_load(src + i);
+            v_store(dst + i, v_select(v_is_mask(s), v_load(dst + i), v_or(s, opaque)));
+        }
+    }
+    else if (alpha < 0xFF)
+    {
+        const vu32 sa = v_set1(alpha);
+        for (; i + VecSize <= count; i += VecSize)
+        {
+            const vu32 s = v_load(src + i), d = v_load(dst + i);
+            v_store(dst + i, v_select(v_is_mask(s), d, v_argb2argb_blend_core(v_or(s, opaque), d, sa)));
+        }
+    }
+#endif
+    TRANS_ROW_TAIL(_rgb2argb_blender)
+}
+
+static void argb2rgb_row(uint32_t *dst, const uint32_t *src, size_t count, unsigned long alpha)
+{
+    size_t i = 0;
+#if AGS_BLEND_SIMD
+    const vu32 k = v_set1(alpha > 0 ? (alpha & 0xFF) + 1 : 256);
+    for (; i + VecSize <= count; i += VecSize)
+    {
+        const vu32 s = v_load(src + i), d = v_load(dst + i);
+        const vu32 n = v_inc_nonzero(v_shr(v_mul(v_shr(s, 24), k), 8));
+        v_store(dst + i, v_select(v_is_mask(s), d, v_blend_rgb(s, d, n)));
+    }
+#endif
+    TRANS_ROW_TAIL(_argb2rgb_blender)
+}
+
+static void alpha32_row(uint32_t *dst, const uint32_t *src, size_t count, unsigned long alpha)
+{
+    size_t i = 0;
+#if AGS_BLEND_SIMD
+    for (; i + VecSize <= count; i += VecSize)
+    {
+        const vu32 s = v_load(src + i), d = v_load(dst + i);
+        const vu32 n = v_inc_nonzero(v_shr(s, 24));
+        v_store(dst + i, v_select(v_is_mask(s), d, v_blend_rgb(s, d, n)));
+    }
+#endif
+    TRANS_ROW_TAIL(_blender_alpha32)
+}
+
+static void trans_alpha32_row(uint32_t *dst, const uint32_t *src, size_t count, unsigned long alpha)
+{
+    size_t i = 0;
+#if AGS_BLEND_SIMD
+    // larger alpha would overflow 32-bit lanes, but is never used
+    if (alpha <= 0xFFFF)
+    {
+        const vu32 k = v_set1(alpha);
+        for (; i + VecSize <= count; i += VecSize)
+        {
+            const vu32 s = v_load(src + i), d = v_load(dst + i);
+            const vu32 n = v_inc_nonzero(v_shr(v_mul(v_shr(s, 24), k), 8));
+            v_store(dst + i, v_select(v_is_mask(s), d, v_blend_rgb(s, d, n)));
+        }
+    }
+#endif
+    TRANS_ROW_TAIL(_trans_alpha_blender32)
+}
+
+static void trans24_row(uint32_t *dst, const uint32_t *src, size_t count, unsigned long alpha)
+{
+    size_t i = 0;
+#if AGS_BLEND_SIMD
+    const vu32 n = v_set1(alpha ? alpha + 1 : 0);
+    for (; i + VecSize <= count; i += VecSize)
+    {
+        const vu32 s = v_load(src + i), d = v_load(dst + i);
+        v_store(dst + i, v_select(v_is_mask(s), d, v_blend_rgb(s, d, n)));
+    }
+#endif
+    TRANS_ROW_TAIL(_blender_trans24)
+}
+
+static void alpha_trans24_row(uint32_t *dst, const uint32_t *src, size_t count, unsigned long alpha)
+{
+    size_t i = 0;
+#if AGS_BLEND_SIMD
+    const vu32 n = v_set1(alpha ? alpha + 1 : 0);
+    const vu32 alpha_mask = v_set1(0xFF000000);
+    for (; i + VecSize <= count; i += VecSize)
+    {
+        const vu32 s = v_load(src + i), d = v_load(dst + i);
+        v_store(dst + i, v_select(v_is_mask(s), d, v_or(v_blend_rgb(s, d, n), v_and(d, alpha_mask))));
+    }
+#endif
+    TRANS_ROW_TAIL(_myblender_alpha_trans24)
+}
+
+static void additive_alpha_row(uint32_t *dst, const uint32_t *src, size_t count, unsigned long alpha)
+{
+    size_t i = 0;
+#if AGS_BLEND_SIMD
+    for (; i + VecSize <= count; i += VecSize)
+    {
+        const vu32 s = v_load(src + i), d = v_load(dst + i);
+        const vu32 a = v_min(v_add(v_shr(s, 24), v_shr(d, 24)), v_set1(0xFF));
+        v_store(dst + i, v_select(v_is_mask(s), d, v_or(v_shl(a, 24), v_and(s, v_set1(0x00FFFFFF)))));
+    }
+#endif
+    TRANS_ROW_TAIL(_additive_alpha_copysrc_blender)
+}
+
+static void opaque_alpha_row(uint32_t *dst, const uint32_t *src, size_t count, unsigned long alpha)
+{
+    size_t i = 0;
+#if AGS_BLEND_SIMD
+    const vu32 opaque = v_set1(0xFF000000);
+    for (; i + VecSize <= count; i += VecSize)
+    {
+        const vu32 s = v_load(src + i);
+        v_store(dst + i, v_select(v_is_mask(s), v_load(dst + i), v_or(s, opaque)));
+    }
+#endif
+    TRANS_ROW_TAIL(_opaque_alpha_blender)
+}
+
+// Finishes the row with the per-pixel blender
+#define LIT_ROW_TAIL(blender) \
+    for (; i < count; ++i) \
+    { \
+        if (src[i] != MASK_COLOR_32) \
+            dst[i] = blender(blend_color, src[i], light); \
+    }
+
+static void lit_trans24_row(uint32_t *dst, const uint32_t *src, size_t count, unsigned long blend_color, unsigned long light)
+{
+    size_t i = 0;
+#if AGS_BLEND_SIMD
+    const vu32 n = v_set1(light ? light + 1 : 0);
+    const vu32 c = v_set1(blend_color);
+    for (; i + VecSize <= count; i += VecSize)
+    {
+        const vu32 s = v_load(src + i);
+        v_store(dst + i, v_select(v_is_mask(s), v_load(dst + i), v_blend_rgb(c, s, n)));
+    }
+#endif
+    LIT_ROW_TAIL(_blender_trans24)
+}
+
+static void lit_alpha_trans24_row(uint32_t *dst, const uint32_t *src, size_t count, unsigned long blend_color, unsigned long light)
+{
+    size_t i = 0;
+#if AGS_BLEND_SIMD
+    const vu32 n = v_set1(light ? light + 1 : 0);
+    const vu32 c = v_set1(blend_color);
+    const vu32 alpha_mask = v_set1(0xFF000000);
+    for (; i + VecSize <= count; i += VecSize)
+    {
+        const vu32 s = v_load(src + i);
+        v_store(dst + i, v_select(v_is_mask(s), v_load(dst + i), v_or(v_blend_rgb(c, s, n), v_and(s, alpha_mask))));
+    }
+#endif
+    LIT_ROW_TAIL(_myblender_alpha_trans24)
+}
+
+// Colorizing blenders work in HSV and are not vectorized, but the blend
+// color is only converted once per row
+static void lit_color32_row(uint32_t *dst, const uint32_t *src, size_t count, unsigned long blend_color, unsigned long light)
+{
+    float xh, xs, xv;
+    float yh, ys, yv;
+    int r, g, b;
+    rgb_to_hsv(getr32(blend_color), getg32(blend_color), getb32(blend_color), &xh, &xs, &xv);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const unsigned long y = src[i];
+        if (y == MASK_COLOR_32)
+            continue;
+        rgb_to_hsv(getr32(y), getg32(y), getb32(y), &yh, &ys, &yv);
+        hsv_to_rgb(xh, xs, yv, &r, &g, &b);
+        dst[i] = makeacol32(r, g, b, geta32(y));
+    }
+}
+
+static void lit_color32_light_row(uint32_t *dst, const uint32_t *src, size_t count, unsigned long blend_color, unsigned long light)
+{
+    float xh, xs, xv;
+    float yh, ys, yv;
+    int r, g, b;
+    rgb_to_hsv(getr32(blend_color), getg32(blend_color), getb32(blend_color), &xh, &xs, &xv);
+    const double lum_sub = (1.0 - ((float)light / 250.0));
+    for (size_t i = 0; i < count; ++i)
+    {
+        const unsigned long y = src[i];
+        if (y == MASK_COLOR_32)
+            continue;
+        rgb_to_hsv(getr32(y), getg32(y), getb32(y), &yh, &ys, &yv);
+        // adjust luminance
+        yv -= lum_sub;
+        if (yv < 0.0) yv = 0.0;
+        hsv_to_rgb(xh, xs, yv, &r, &g, &b);
+        dst[i] = makeacol32(r, g, b, geta32(y));
+    }
+}
+
+PfnTransRowBlender get_trans_row_blender32(PfnPixelBlender blender)
+{
+    // row blenders expect alpha in the highest byte
+    if (_rgb_a_shift_32 != 24)
+        return nullptr;
+    if (blender == _argb2argb_blender)
+        return argb2argb_row;
+    if (blender == _rgb2argb_blender)
+        return rgb2argb_row;
+    if (blender == _argb2rgb_blender)
+        return argb2rgb_row;
+    if (blender == _blender_alpha32)
+        return alpha32_row;
+    if (blender == _trans_alpha_blender32)
+        return trans_alpha32_row;
+    if (blender == _blender_trans24)
+        return trans24_row;
+    if (blender == _myblender_alpha_trans24)
+        return alpha_trans24_row;
+    if (blender == _additive_alpha_copysrc_blender)
+        return additive_alpha_row;
+    if (blender == _opaque_alpha_blender)
+        return opaque_alpha_row;
+    return nullptr;
+}
+
+PfnLitRowBlender get_lit_row_blender32(PfnPixelBlender blender)
+{
+    if (_rgb_a_shift_32 != 24)
+        return nullptr;
+    if (blender == _blender_trans24)
+        return lit_trans24_row;
+    if (blender == _myblender_alpha_trans24)
+        return lit_alpha_trans24_row;
+    if (blender == _myblender_color32)
+        return lit_color32_row;
+    if (blender == _myblender_color32_light)
+        return lit_color32_light_row;
+    return nullptr;
+}
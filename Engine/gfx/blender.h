@@ -19,6 +19,8 @@
 #ifndef __AC_BLENDER_H
 #define __AC_BLENDER_H
 
+#include "core/types.h"
+
 //
 // Allegro's standard alpha blenders result in:
 // - src and dst RGB are combined proportionally to src alpha
@@ -53,6 +55,9 @@ unsigned long _argb2rgb_blender(unsigned long src_col, unsigned long dst_col, un
 unsigned long _rgb2argb_blender(unsigned long src_col, unsigned long dst_col, unsigned long src_alpha);
 // Sets the alpha channel to opaque. Used when drawing a non-alpha sprite onto an alpha-sprite.
 unsigned long _opaque_alpha_blender(unsigned long src_col, unsigned long dst_col, unsigned long src_alpha);
+// Argb2rgb blender which uses custom alpha parameter as a fraction of source alpha;
+// used for compositing alpha images.
+unsigned long _trans_alpha_blender32(unsigned long src_col, unsigned long dst_col, unsigned long src_alpha);
 
 // Additive alpha blender plain copies src over, applying a summ of src and
 // dst alpha values.
@@ -60,4 +65,22 @@ void set_additive_alpha_blender();
 // Opaque alpha blender plain copies src over, applying opaque alpha value.
 void set_opaque_alpha_blender();
 
+//
+// Row blenders process a whole row of 32-bit pixels in one call, giving
+// exactly the same result as the matching per-pixel blender called by
+// draw_trans_sprite or draw_lit_sprite, including skipping the source pixels
+// of the mask color. Row blenders use SIMD instructions where available.
+//
+typedef unsigned long (*PfnPixelBlender)(unsigned long x, unsigned long y, unsigned long n);
+// Blends source pixels onto the destination, as draw_trans_sprite does
+typedef void (*PfnTransRowBlender)(uint32_t *dst, const uint32_t *src, size_t count, unsigned long alpha);
+// Writes source pixels blended with the given color, as draw_lit_sprite does
+typedef void (*PfnLitRowBlender)(uint32_t *dst, const uint32_t *src, size_t count, unsigned long blend_color, unsigned long light);
+// Gets row blender matching the 32-bit pixel blender for draw_trans_sprite,
+// returns null if there's none
+PfnTransRowBlender get_trans_row_blender32(PfnPixelBlender blender);
+// Gets row blender matching the 32-bit pixel blender for draw_lit_sprite,
+// returns null if there's none
+PfnLitRowBlender get_lit_row_blender32(PfnPixelBlender blender);
+
 #endif // __AC_BLENDER_H
@@ -12,10 +12,17 @@
 //
 //=============================================================================
 
+#include <algorithm>
 #include "core/platform.h"
 #include "gfx/gfx_util.h"
 #include "gfx/blender.h"
 
+extern "C" {
+    extern BLENDER_FUNC _blender_func32;
+    extern int _blender_col_32;
+    extern int _blender_alpha;
+}
+
 // CHECKME: is this hack still relevant?
 #if AGS_PLATFORM_OS_IOS || AGS_PLATFORM_OS_ANDROID
 extern int psp_gfx_renderer;
@@ -100,7 +107,7 @@ void DrawSpriteBlend(Bitmap *ds, const Point &ds_at, Bitmap *sprite,
         // set blenders if applicable and tell if succeeded
         SetBlender(blend_mode, dst_has_alpha, src_has_alpha, blend_alpha))
     {
-        ds->TransBlendBlt(sprite, ds_at.X, ds_at.Y);
+        TransBlendBlt(ds, sprite, ds_at.X, ds_at.Y);
     }
     else
     {
@@ -163,7 +170,7 @@ void DrawSpriteWithTransparency(Bitmap *ds, Bitmap *sprite, int x, int y, int al
         if (alpha < 0xFF) 
         {
             set_trans_blender(0, 0, 0, alpha);
-            ds->TransBlendBlt(&hctemp, x, y);
+            TransBlendBlt(ds, &hctemp, x, y);
         }
         else
         {
@@ -175,7 +182,7 @@ void DrawSpriteWithTransparency(Bitmap *ds, Bitmap *sprite, int x, int y, int al
         if (alpha < 0xFF && surface_depth > 8 && sprite_depth > 8) 
         {
             set_trans_blender(0, 0, 0, alpha);
-            ds->TransBlendBlt(sprite, x, y);
+            TransBlendBlt(ds, sprite, x, y);
         }
         else
         {
@@ -184,6 +191,82 @@ void DrawSpriteWithTransparency(Bitmap *ds, Bitmap *sprite, int x, int y, int al
     }
 }
 
+// Tells if the sprite may be drawn by the 32-bit row blenders
+static bool CanBlendRows(Bitmap *ds, Bitmap *sprite)
+{
+    return ds->GetColorDepth() == 32 && sprite->GetColorDepth() == 32 &&
+        ds->IsMemoryBitmap() && ds->GetAllegroBitmap()->clip;
+}
+
+// Draws the sprite row by row, clipping it same way as Allegro does
+template <typename TRowFn>
+static void DrawSpriteRows(Bitmap *ds, Bitmap *sprite, int x, int y, TRowFn row_fn)
+{
+    const BITMAP *al_ds = ds->GetAllegroBitmap();
+    const int src_x = std::max(0, al_ds->cl - x);
+    const int src_y = std::max(0, al_ds->ct - y);
+    const int w = std::min(sprite->GetWidth(), al_ds->cr - x) - src_x;
+    const int h = std::min(sprite->GetHeight(), al_ds->cb - y) - src_y;
+    if (w <= 0 || h <= 0)
+        return;
+    for (int row = 0; row < h; ++row)
+    {
+        row_fn(reinterpret_cast<uint32_t*>(ds->GetScanLineForWriting(y + src_y + row)) + x + src_x,
+            reinterpret_cast<const uint32_t*>(sprite->GetScanLine(src_y + row)) + src_x, (size_t)w);
+    }
+}
+
+void TransBlendRows(Bitmap *ds, Bitmap *sprite, int x, int y, PfnTransRowBlender blender, unsigned long alpha)
+{
+    DrawSpriteRows(ds, sprite, x, y,
+        [blender, alpha](uint32_t *dst, const uint32_t *src, size_t count)
+        { blender(dst, src, count, alpha); });
+}
+
+void LitBlendRows(Bitmap *ds, Bitmap *sprite, int x, int y, PfnLitRowBlender blender,
+    unsigned long color, unsigned long light)
+{
+    DrawSpriteRows(ds, sprite, x, y,
+        [blender, color, light](uint32_t *dst, const uint32_t *src, size_t count)
+        { blender(dst, src, count, color, light); });
+}
+
+PfnTransRowBlender GetTransRowBlender(Bitmap *ds, Bitmap *sprite, unsigned long &alpha)
+{
+    alpha = _blender_alpha;
+    return CanBlendRows(ds, sprite) ? get_trans_row_blender32(_blender_func32) : nullptr;
+}
+
+PfnLitRowBlender GetLitRowBlender(Bitmap *ds, Bitmap *sprite, unsigned long &color)
+{
+    color = _blender_col_32;
+    return CanBlendRows(ds, sprite) ? get_lit_row_blender32(_blender_func32) : nullptr;
+}
+
+void TransBlendBlt(Bitmap *ds, Bitmap *sprite, int x, int y)
+{
+    unsigned long alpha;
+    const PfnTransRowBlender blender = GetTransRowBlender(ds, sprite, alpha);
+    if (!blender)
+    {
+        ds->TransBlendBlt(sprite, x, y);
+        return;
+    }
+    TransBlendRows(ds, sprite, x, y, blender, alpha);
+}
+
+void LitBlendBlt(Bitmap *ds, Bitmap *sprite, int x, int y, int light_amount)
+{
+    unsigned long color;
+    const PfnLitRowBlender blender = GetLitRowBlender(ds, sprite, color);
+    if (!blender)
+    {
+        ds->LitBlendBlt(sprite, x, y, light_amount);
+        return;
+    }
+    LitBlendRows(ds, sprite, x, y, blender, color, light_amount);
+}
+
 } // namespace GfxUtil
 
 } // namespace Engine
@@ -25,6 +25,7 @@
 #define __AGS_EE_GFX__GFXUTIL_H
 
 #include "gfx/bitmap.h"
+#include "gfx/blender.h"
 #include "gfx/gfx_def.h"
 
 namespace AGS
@@ -51,6 +52,27 @@ namespace GfxUtil
     // ignores image's alpha channel, even if there's one;
     // does proper conversion depending on respected color depths.
     void DrawSpriteWithTransparency(Bitmap *ds, Bitmap *sprite, int x, int y, int alpha = 0xFF);
+
+    // Draws a bitmap over another one using the blender set by set_blender_mode;
+    // does the same as Bitmap::TransBlendBlt, but uses row blenders for the
+    // 32-bit bitmaps when available.
+    void TransBlendBlt(Bitmap *ds, Bitmap *sprite, int x, int y);
+    // Draws a bitmap tinted with the blender set by set_blender_mode;
+    // does the same as Bitmap::LitBlendBlt, but uses row blenders for the
+    // 32-bit bitmaps when available.
+    void LitBlendBlt(Bitmap *ds, Bitmap *sprite, int x, int y, int light_amount);
+
+    // Get the row blender and its parameter matching the current blender mode,
+    // or null if the sprite can't be drawn on the surface by the row blenders
+    PfnTransRowBlender GetTransRowBlender(Bitmap *ds, Bitmap *sprite, unsigned long &alpha);
+    PfnLitRowBlender GetLitRowBlender(Bitmap *ds, Bitmap *sprite, unsigned long &color);
+    // Draw the sprite with the given row blender and its parameters, clipped
+    // by the destination's clip rect. Unlike the above functions these do not
+    // read the current blender mode, and may run on several threads at once,
+    // provided they write to the separate parts of the destination.
+    void TransBlendRows(Bitmap *ds, Bitmap *sprite, int x, int y, PfnTransRowBlender blender, unsigned long alpha);
+    void LitBlendRows(Bitmap *ds, Bitmap *sprite, int x, int y, PfnLitRowBlender blender,
+        unsigned long color, unsigned long light);
 } // namespace GfxUtil
 
 } // namespace Engine
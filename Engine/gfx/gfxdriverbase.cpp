@@ -459,6 +459,21 @@ void VideoMemoryGraphicsDriver::BitmapToVideoMem(const Bitmap *bitmap, const boo
   }
 }
 
+void VideoMemoryGraphicsDriver::GetTileUpdateRects(const TextureTile &tile, const Rect &region, const bool opaque,
+    Rect &upload, Rect &convert)
+{
+  // BitmapToVideoMem makes each transparent pixel from its direct neighbours,
+  // so the pixels next to the changed ones are uploaded too, and are converted
+  // along with their own neighbours
+  const int margin = opaque ? 0 : 1;
+  const Rect tile_rc = RectWH(0, 0, tile.width, tile.height);
+  const Rect changed = Rect::MoveBy(region, -tile.x, -tile.y);
+  upload = ClampToRect(tile_rc,
+    Rect(changed.Left - margin, changed.Top - margin, changed.Right + margin, changed.Bottom + margin));
+  convert = ClampToRect(tile_rc,
+    Rect(upload.Left - margin, upload.Top - margin, upload.Right + margin, upload.Bottom + margin));
+}
+
 void VideoMemoryGraphicsDriver::BitmapToVideoMemOpaque(const Bitmap *bitmap, const bool has_alpha, const TextureTile *tile, const VideoMemDDB *target,
     char *dst_ptr, const int dst_pitch)
 {
@@ -22,6 +22,7 @@
 #include <vector>
 #include "gfx/ddb.h"
 #include "gfx/graphicsdriver.h"
+#include "gfx/textureatlas.h"
 #include "util/scaling.h"
 
 namespace AGS
@@ -105,6 +106,7 @@ public:
     DisplayMode GetDisplayMode() const override;
     Size        GetNativeSize() const override;
     Rect        GetRenderDestination() const override;
+    RenderStats GetRenderStats() const override { return _renderStats; }
 
     void        BeginSpriteBatch(const Rect &viewport, const SpriteTransform &transform,
                     const Point offset = Point(), GlobalFlipType flip = kFlip_None, PBitmap surface = nullptr) override;
@@ -117,6 +119,10 @@ public:
     void        SetCallbackOnSurfaceUpdate(GFXDRV_CLIENTCALLBACKSURFACEUPDATE callback) override { _initSurfaceUpdateCallback = callback; }
     void        SetCallbackForNullSprite(GFXDRV_CLIENTCALLBACKXY callback) override { _nullSpriteCallback = callback; }
 
+    // By default updates the whole DDB
+    void        UpdateDDBRegionFromBitmap(IDriverDependantBitmap* bitmapToUpdate, Common::Bitmap *bitmap, bool hasAlpha, const Rect &region) override
+                { UpdateDDBFromBitmap(bitmapToUpdate, bitmap, hasAlpha); }
+
     virtual void        UpdateDeviceScreen(const Size &screenSize) { throw NotImplemented(); }
 
 protected:
@@ -147,6 +153,7 @@ protected:
     Rect                _dstRect;       // rendering destination rect
     Rect                _filterRect;    // filter scaling destination rect (before final scaling)
     PlaneScaling        _scaling;       // native -> render dest coordinate transformation
+    RenderStats         _renderStats;   // statistics of the last rendered frame
 
     // Callbacks
     GFXDRV_CLIENTCALLBACK _pollingCallback;
@@ -222,12 +229,23 @@ protected:
     // Same but optimized for opaque source bitmaps which ignore transparent "mask color"
     void BitmapToVideoMemOpaque(const Bitmap *bitmap, const bool has_alpha, const TextureTile *tile, const VideoMemDDB *target,
         char *dst_ptr, const int dst_pitch);
+    // Gets the part of the tile which has to be uploaded when the given region
+    // of the bitmap has changed, and the part which has to be converted for
+    // that; both are in the tile's coordinates. Transparent pixels take the
+    // colour of their neighbours, so for them the parts are larger than the
+    // changed region.
+    static void GetTileUpdateRects(const TextureTile &tile, const Rect &region, const bool opaque,
+        Rect &upload, Rect &convert);
 
     // Stage virtual screen is used to let plugins draw custom graphics
     // in between render stages (between room and GUI, after GUI, and so on)
     PBitmap _stageVirtualScreen;
     IDriverDependantBitmap *_stageVirtualScreenDDB;
 
+    // Packs small DDBs into the shared textures; the implementations
+    // initialize it and own the page textures
+    TextureAtlas _atlas;
+
     // Color component shifts in video bitmap format (set by implementations)
     int _vmem_a_shift_32;
     int _vmem_r_shift_32;
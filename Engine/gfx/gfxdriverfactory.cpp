@@ -13,6 +13,7 @@
 //=============================================================================
 
 #include "gfx/gfxdriverfactory.h"
+#include "gfx/ali3d_null.h"
 #include "gfx/ali3d_sdl_renderer.h"
 #include "gfx/gfxfilter_allegro.h"
 #include "gfx/ogl_support.h"
@@ -35,6 +36,7 @@ void GetGfxDriverFactoryNames(StringV &ids)
     ids.push_back("OGL");
 #endif
     ids.push_back("Software");
+    ids.push_back("Null");
 }
 
 IGfxDriverFactory *GetGfxDriverFactory(const String id)
@@ -47,6 +49,9 @@ IGfxDriverFactory *GetGfxDriverFactory(const String id)
     if ((id.CompareNoCase("Software") == 0) || (id.CompareNoCase("DX5") == 0)) {
         return SDLRenderer::SDLRendererGraphicsFactory::GetFactory();
     }
+    if ((id.CompareNoCase("Null") == 0) || (id.CompareNoCase("Offscreen") == 0)) {
+        return Null::NullGraphicsFactory::GetFactory();
+    }
     set_allegro_error("No graphics factory with such id: %s", id.GetCStr());
     return nullptr;
 }
@@ -12,9 +12,11 @@
 //
 //=============================================================================
 
+#include <algorithm>
 #include "gfx/bitmap.h"
 #include "gfx/gfxfilter_hqx.h"
 #include "gfx/hq2x3x.h"
+#include "util/workerpool.h"
 
 namespace AGS
 {
@@ -25,6 +27,9 @@ namespace ALSW
 
 using namespace Common;
 
+// Minimal number of the source rows scaled by one job
+static const int MinBandHeight = 8;
+
 const GfxFilterInfo HqxGfxFilter::FilterInfo = GfxFilterInfo("Hqx", "Hqx (High Quality)", 2, 3);
 
 HqxGfxFilter::HqxGfxFilter()
@@ -61,9 +66,9 @@ Bitmap* HqxGfxFilter::InitVirtualScreen(Bitmap *screen, const Size src_size, con
     int min_scaling = Math::Min(dst_rect.GetWidth() / src_size.Width, dst_rect.GetHeight() / src_size.Height);
     min_scaling = Math::Clamp(min_scaling, 2, 3);
     if (min_scaling == 2)
-        _pfnHqx = hq2x_32;
+        _pfnHqx = hq2x_32_rows;
     else
-        _pfnHqx = hq3x_32;
+        _pfnHqx = hq3x_32_rows;
     _hqxScalingBuffer = BitmapHelper::CreateBitmap(src_size.Width * min_scaling, src_size.Height * min_scaling);
 
     InitLUTs();
@@ -80,9 +85,23 @@ Bitmap *HqxGfxFilter::ShutdownAndReturnRealScreen()
 
 Bitmap *HqxGfxFilter::PreRenderPass(Bitmap *toRender)
 {
+    // Scale the horizontal bands of the image in parallel; each band writes
+    // its own output rows, so the result is the same as scaling it at once
+    unsigned char *src = toRender->GetDataForWriting();
+    const int src_w = toRender->GetWidth();
+    const int src_h = toRender->GetHeight();
+    WorkerPool &pool = WorkerPool::GetShared();
+    const size_t band_count = std::max<size_t>(1,
+        std::min<size_t>(pool.GetThreadCount() * 2, src_h / MinBandHeight));
     _hqxScalingBuffer->Acquire();
-    _pfnHqx(toRender->GetDataForWriting(), _hqxScalingBuffer->GetDataForWriting(),
-        toRender->GetWidth(), toRender->GetHeight(), _hqxScalingBuffer->GetLineLength());
+    unsigned char *dst = _hqxScalingBuffer->GetDataForWriting();
+    const int dst_bpl = _hqxScalingBuffer->GetLineLength();
+    PfnHqx pfn_hqx = _pfnHqx;
+    pool.RunBatch(band_count, [=](size_t band, size_t /*thread*/)
+    {
+        pfn_hqx(src, dst, src_w, src_h, dst_bpl,
+            (int)(src_h * band / band_count), (int)(src_h * (band + 1) / band_count));
+    });
     _hqxScalingBuffer->Release();
     return _hqxScalingBuffer;
 }
@@ -45,7 +45,8 @@ public:
 protected:
     Bitmap *PreRenderPass(Bitmap *toRender) override;
 
-    typedef void (*PfnHqx)(unsigned char *in, unsigned char *out, int src_w, int src_h, int bpl);
+    typedef void (*PfnHqx)(unsigned char *in, unsigned char *out, int src_w, int src_h, int bpl,
+        int y_from, int y_to);
 
     PfnHqx  _pfnHqx;
     Bitmap *_hqxScalingBuffer;
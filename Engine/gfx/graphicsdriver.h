@@ -23,6 +23,7 @@
 #include "gfx/gfxdefines.h"
 #include "gfx/gfxmodelist.h"
 #include "util/geometry.h"
+#include "util/string.h"
 
 namespace AGS
 {
@@ -72,6 +73,18 @@ struct SpriteTransform
         : X(x), Y(y), ScaleX(scalex), ScaleY(scaley), Rotate(rotate) {}
 };
 
+// Statistics of the last rendered frame, for the performance measurements;
+// only the hardware accelerated renderers count them
+struct RenderStats
+{
+    uint32_t DrawCalls;    // number of draw calls sent to the device
+    uint32_t TextureBinds; // number of texture switches
+    uint32_t Sprites;      // number of sprite tiles drawn
+
+    RenderStats()
+        : DrawCalls(0), TextureBinds(0), Sprites(0) {}
+};
+
 typedef void (*GFXDRV_CLIENTCALLBACK)();
 typedef bool (*GFXDRV_CLIENTCALLBACKXY)(int x, int y);
 typedef void (*GFXDRV_CLIENTCALLBACKINITGFX)(void *data);
@@ -120,6 +133,9 @@ public:
   virtual int  GetCompatibleBitmapFormat(int color_depth) = 0;
   virtual IDriverDependantBitmap* CreateDDBFromBitmap(Common::Bitmap *bitmap, bool hasAlpha, bool opaque = false) = 0;
   virtual void UpdateDDBFromBitmap(IDriverDependantBitmap* bitmapToUpdate, Common::Bitmap *bitmap, bool hasAlpha) = 0;
+  // Updates the part of the DDB from the bitmap of the same size; the region is
+  // in bitmap coordinates. Drivers may update more than the requested region.
+  virtual void UpdateDDBRegionFromBitmap(IDriverDependantBitmap* bitmapToUpdate, Common::Bitmap *bitmap, bool hasAlpha, const Rect &region) = 0;
   virtual void DestroyDDB(IDriverDependantBitmap* bitmap) = 0;
 
   // Prepares next sprite batch, a list of sprites with defined viewport and optional
@@ -148,6 +164,8 @@ public:
   virtual bool GetCopyOfScreenIntoBitmap(Common::Bitmap *destination, bool at_native_res, GraphicResolution *want_fmt = nullptr) = 0;
   virtual void EnableVsyncBeforeRender(bool enabled) = 0;
   virtual void Vsync() = 0;
+  // Gets the statistics of the last rendered frame
+  virtual RenderStats GetRenderStats() const = 0;
   // Enables or disables rendering mode that draws sprite list directly into
   // the final resolution, as opposed to drawing to native-resolution buffer
   // and scaling to final frame. The effect may be that sprites that are
@@ -155,6 +173,12 @@ public:
   // the rest of the game. The effect is stronger for the low-res games being
   // rendered in the high-res mode.
   virtual void RenderSpritesAtScreenResolution(bool enabled, int supersampling = 1) = 0;
+  // Sets the number of threads the sprites may be drawn on, 0 for one thread
+  // per CPU core. Only software and offscreen renderers support this.
+  virtual void SetRenderThreads(int count) {}
+  // Makes the driver save every Nth rendered frame as an image in the given
+  // directory, 0 disables this. Only the offscreen renderer supports this.
+  virtual void SetFrameDump(int interval, const Common::String &dir) {}
   // TODO: move fade-in/out/boxout functions out of the graphics driver!! make everything render through
   // main drawing procedure. Since currently it does not - we need to init our own sprite batch
   // internally to let it set up correct viewport settings instead of relying on a chance.
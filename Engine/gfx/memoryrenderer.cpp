@@ -0,0 +1,306 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <algorithm>
+#include <thread>
+#include "gfx/memoryrenderer.h"
+#include "gfx/ali3dexception.h"
+#include "gfx/gfx_util.h"
+
+namespace AGS
+{
+namespace Engine
+{
+
+using namespace Common;
+
+// Minimal height of the surface band drawn by one job
+static const int MinBandHeight = 16;
+
+MemoryBatchRenderer::MemoryBatchRenderer()
+    : _threadCount(1)
+{
+}
+
+MemoryBatchRenderer::~MemoryBatchRenderer() = default;
+
+void MemoryBatchRenderer::SetThreadCount(int count)
+{
+    if (count == _threadCount)
+        return;
+    _threadCount = count;
+    if (count <= 0)
+        count = std::max<unsigned>(std::thread::hardware_concurrency(), 1);
+    if (count > 1)
+        _pool.reset(new WorkerPool(count - 1));
+    else
+        _pool.reset();
+}
+
+void MemoryBatchRenderer::InitSpriteBatch(MemorySpriteBatch &batch, const SpriteBatchDesc &desc,
+    Bitmap *virtual_screen, const Point &virtual_scr_off)
+{
+    batch.List.clear();
+    // TODO: correct offsets to have pre-scale (source) and post-scale (dest) offsets!
+    int src_w = desc.Viewport.GetWidth() / desc.Transform.ScaleX;
+    int src_h = desc.Viewport.GetHeight() / desc.Transform.ScaleY;
+    if (desc.Surface != nullptr)
+    {
+        batch.Surface = std::static_pointer_cast<Bitmap>(desc.Surface);
+        batch.Opaque = true;
+    }
+    else if (desc.Viewport.IsEmpty() || !virtual_screen)
+    {
+        batch.Surface.reset();
+        batch.Opaque = false;
+    }
+    else if (desc.Transform.ScaleX == 1.f && desc.Transform.ScaleY == 1.f)
+    {
+        Rect rc = RectWH(desc.Viewport.Left - virtual_scr_off.X, desc.Viewport.Top - virtual_scr_off.Y, desc.Viewport.GetWidth(), desc.Viewport.GetHeight());
+        batch.Surface.reset(BitmapHelper::CreateSubBitmap(virtual_screen, rc));
+        batch.Opaque = true;
+    }
+    else if (!batch.Surface || batch.Surface->GetWidth() != src_w || batch.Surface->GetHeight() != src_h)
+    {
+        batch.Surface.reset(new Bitmap(src_w, src_h));
+        batch.Opaque = false;
+    }
+}
+
+void MemoryBatchRenderer::RenderSpriteBatch(const MemorySpriteBatch &batch, Bitmap *surface, int surf_offx, int surf_offy,
+    GFXDRV_CLIENTCALLBACKXY null_sprite_callback, int tint_red, int tint_green, int tint_blue)
+{
+    const std::vector<MemoryDrawListEntry> &drawlist = batch.List;
+    // Bands are only drawn with the operations which do not depend on the
+    // global blender state, which is the case for the 32-bit surfaces
+    const bool in_bands = _pool && _pool->GetThreadCount() > 1 &&
+        surface->GetColorDepth() == 32 && surface->IsMemoryBitmap() &&
+        surface->GetHeight() >= MinBandHeight * 2;
+    for (size_t i = 0; i < drawlist.size(); i++)
+    {
+        if (in_bands && QueueSprite(drawlist[i], surface, surf_offx, surf_offy))
+            continue;
+        // keep the draw order: finish the queued operations first
+        RenderBandOps(surface);
+        RenderSprite(drawlist[i], surface, surf_offx, surf_offy, null_sprite_callback);
+    }
+
+    if ((tint_red > 0) || (tint_green > 0) || (tint_blue > 0))
+    {
+        if (!in_bands || !QueueTint(surface, tint_red, tint_green, tint_blue))
+        {
+            RenderBandOps(surface);
+            // Common::gl_ScreenBmp tint
+            // This slows down the game no end, only experimental ATM
+            set_trans_blender(tint_red, tint_green, tint_blue, 0);
+            GfxUtil::LitBlendBlt(surface, surface, 0, 0, 128);
+        }
+    }
+    RenderBandOps(surface);
+    // NOTE: following is experimental tint code (currently unused)
+/*  This alternate method gives the correct (D3D-style) result, but is just too slow!
+    if ((_spareTintingScreen != NULL) &&
+        ((_spareTintingScreen->GetWidth() != surface->GetWidth()) || (_spareTintingScreen->GetHeight() != surface->GetHeight())))
+    {
+      destroy_bitmap(_spareTintingScreen);
+      _spareTintingScreen = NULL;
+    }
+    if (_spareTintingScreen == NULL)
+    {
+      _spareTintingScreen = BitmapHelper::CreateBitmap_(GetColorDepth(surface), surface->GetWidth(), surface->GetHeight());
+    }
+    tint_image(surface, _spareTintingScreen, _tint_red, _tint_green, _tint_blue, 100, 255);
+    Blit(_spareTintingScreen, surface, 0, 0, 0, 0, _spareTintingScreen->GetWidth(), _spareTintingScreen->GetHeight());*/
+}
+
+void MemoryBatchRenderer::RenderSprite(const MemoryDrawListEntry &entry, Bitmap *surface, int surf_offx, int surf_offy,
+    GFXDRV_CLIENTCALLBACKXY null_sprite_callback)
+{
+    if (entry.bitmap == nullptr)
+    {
+        if (null_sprite_callback)
+            null_sprite_callback(entry.x, entry.y);
+        else
+            throw Ali3DException("Unhandled attempt to draw null sprite");
+        return;
+    }
+
+    MemoryDDB *bitmap = entry.bitmap;
+    int drawAtX = entry.x + surf_offx;
+    int drawAtY = entry.y + surf_offy;
+
+    if ((bitmap->_opaque) && (bitmap->_bmp == surface))
+    { }
+    else if (bitmap->_opaque)
+    {
+        surface->Blit(bitmap->_bmp, 0, 0, drawAtX, drawAtY, bitmap->_bmp->GetWidth(), bitmap->_bmp->GetHeight());
+    }
+    else if (bitmap->_transparency >= 255)
+    {
+        // fully transparent... invisible, do nothing
+    }
+    else if (bitmap->_hasAlpha)
+    {
+        if (bitmap->_transparency == 0) // this means opaque
+            set_alpha_blender();
+        else
+            // here _transparency is used as alpha (between 1 and 254)
+            set_blender_mode(nullptr, nullptr, _trans_alpha_blender32, 0, 0, 0, bitmap->_transparency);
+        GfxUtil::TransBlendBlt(surface, bitmap->_bmp, drawAtX, drawAtY);
+    }
+    else
+    {
+        // here _transparency is used as alpha (between 1 and 254), but 0 means opaque!
+        GfxUtil::DrawSpriteWithTransparency(surface, bitmap->_bmp, drawAtX, drawAtY,
+            bitmap->_transparency ? bitmap->_transparency : 255);
+    }
+}
+
+bool MemoryBatchRenderer::QueueSprite(const MemoryDrawListEntry &entry, Bitmap *surface, int surf_offx, int surf_offy)
+{
+    // NOTE: the operations must match the ones done by RenderSprite
+    if (entry.bitmap == nullptr)
+        return false; // plugin draws on its own
+
+    MemoryDDB *bitmap = entry.bitmap;
+    if ((bitmap->_opaque) && (bitmap->_bmp == surface))
+        return true;
+    if (!bitmap->_opaque && bitmap->_transparency >= 255)
+        return true;
+    // other color depths are converted by Allegro, which uses global state;
+    // and the bands must not read the pixels which other bands write
+    if (bitmap->_bmp->GetColorDepth() != 32 || bitmap->_bmp == surface)
+        return false;
+
+    BandOp op = {};
+    op.Sprite = bitmap->_bmp;
+    op.X = entry.x + surf_offx;
+    op.Y = entry.y + surf_offy;
+    if (bitmap->_opaque)
+    {
+        op.Kind = BandOp::kBandOp_Blit;
+    }
+    else if (bitmap->_hasAlpha)
+    {
+        if (bitmap->_transparency == 0)
+            set_alpha_blender();
+        else
+            set_blender_mode(nullptr, nullptr, _trans_alpha_blender32, 0, 0, 0, bitmap->_transparency);
+        op.Kind = BandOp::kBandOp_TransRows;
+        op.TransBlender = GfxUtil::GetTransRowBlender(surface, op.Sprite, op.Param);
+        if (!op.TransBlender)
+            return false;
+    }
+    else if (bitmap->_transparency > 0)
+    {
+        // same as DrawSpriteWithTransparency for the 32-bit bitmaps
+        set_trans_blender(0, 0, 0, bitmap->_transparency);
+        op.Kind = BandOp::kBandOp_TransRows;
+        op.TransBlender = GfxUtil::GetTransRowBlender(surface, op.Sprite, op.Param);
+        if (!op.TransBlender)
+            return false;
+    }
+    else
+    {
+        op.Kind = BandOp::kBandOp_MaskedBlit;
+    }
+    _bandOps.push_back(op);
+    return true;
+}
+
+bool MemoryBatchRenderer::QueueTint(Bitmap *surface, int tint_red, int tint_green, int tint_blue)
+{
+    // each band only reads back the pixels it writes, so the surface
+    // may be blended onto itself
+    BandOp op = {};
+    set_trans_blender(tint_red, tint_green, tint_blue, 0);
+    op.Kind = BandOp::kBandOp_LitRows;
+    op.Sprite = surface;
+    op.LitBlender = GfxUtil::GetLitRowBlender(surface, surface, op.Param);
+    op.Light = 128;
+    if (!op.LitBlender)
+        return false;
+    _bandOps.push_back(op);
+    return true;
+}
+
+void MemoryBatchRenderer::RenderBandOps(Bitmap *surface)
+{
+    if (_bandOps.empty())
+        return;
+
+    // Split the surface into horizontal bands, clipped by the surface's clip rect;
+    // there are more bands than threads, as the sprites are rarely spread evenly
+    const int surf_w = surface->GetWidth();
+    const int surf_h = surface->GetHeight();
+    const size_t band_count = std::min<size_t>(_pool->GetThreadCount() * 2, surf_h / MinBandHeight);
+    if (_bands.size() < band_count)
+        _bands.resize(band_count);
+    _bandTop.resize(band_count);
+    _activeBands.clear();
+    const Rect clip = surface->GetClip();
+    for (size_t i = 0; i < band_count; ++i)
+    {
+        const int top = (int)(surf_h * i / band_count);
+        const int bottom = (int)(surf_h * (i + 1) / band_count) - 1;
+        const int clip_top = std::max(top, clip.Top);
+        const int clip_bottom = std::min(bottom, clip.Bottom);
+        if (clip_top > clip_bottom || clip.Left > clip.Right)
+            continue;
+        if (!_bands[i])
+            _bands[i].reset(new Bitmap());
+        _bands[i]->CreateSubBitmap(surface, Rect(0, top, surf_w - 1, bottom));
+        _bands[i]->SetClip(Rect(clip.Left, clip_top - top, clip.Right, clip_bottom - top));
+        _bandTop[i] = top;
+        _activeBands.push_back(i);
+    }
+
+    _pool->RunBatch(_activeBands.size(),
+        [this](size_t job, size_t /*thread*/) { RenderBand(_activeBands[job]); });
+    _bandOps.clear();
+}
+
+void MemoryBatchRenderer::RenderBand(size_t band_index)
+{
+    Bitmap *ds = _bands[band_index].get();
+    const int top = _bandTop[band_index];
+    const int bottom = top + ds->GetHeight();
+    for (const BandOp &op : _bandOps)
+    {
+        // skip the sprites which do not touch this band
+        Bitmap *sprite = op.Sprite;
+        if (op.Y >= bottom || op.Y + sprite->GetHeight() <= top)
+            continue;
+        const int x = op.X;
+        const int y = op.Y - top;
+        switch (op.Kind)
+        {
+        case BandOp::kBandOp_Blit:
+            ds->Blit(sprite, 0, 0, x, y, sprite->GetWidth(), sprite->GetHeight());
+            break;
+        case BandOp::kBandOp_MaskedBlit:
+            ds->Blit(sprite, x, y, kBitmap_Transparency);
+            break;
+        case BandOp::kBandOp_TransRows:
+            GfxUtil::TransBlendRows(ds, sprite, x, y, op.TransBlender, op.Param);
+            break;
+        case BandOp::kBandOp_LitRows:
+            GfxUtil::LitBlendRows(ds, sprite, x, y, op.LitBlender, op.Param, op.Light);
+            break;
+        }
+    }
+}
+
+} // namespace Engine
+} // namespace AGS
@@ -0,0 +1,175 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Sprite batch rendering on the memory bitmaps, shared by the graphics
+// drivers which draw everything in software.
+//
+// MemoryBatchRenderer may split the 32-bit surface into horizontal bands and
+// draw the sprites on them from several threads. Each band runs through the
+// queued operations in the draw list order and skips the sprites which do not
+// touch it, so the result is the same as when drawing sequentially.
+//
+//=============================================================================
+#ifndef __AGS_EE_GFX__MEMORYRENDERER_H
+#define __AGS_EE_GFX__MEMORYRENDERER_H
+
+#include <memory>
+#include <vector>
+#include "gfx/bitmap.h"
+#include "gfx/blender.h"
+#include "gfx/ddb.h"
+#include "gfx/gfxdriverbase.h"
+#include "util/workerpool.h"
+
+namespace AGS
+{
+namespace Engine
+{
+
+using AGS::Common::Bitmap;
+using AGS::Common::WorkerPool;
+
+// Driver-dependent bitmap which refers to the memory bitmap it was made of
+class MemoryDDB final : public IDriverDependantBitmap
+{
+public:
+    // NOTE by CJ:
+    // Transparency is a bit counter-intuitive
+    // 0=not transparent, 255=invisible, 1..254 barely visible .. mostly visible
+    void SetTransparency(int transparency) override { _transparency = transparency; }
+    void SetFlippedLeftRight(bool isFlipped) override { _flipped = isFlipped; }
+    void SetStretch(int width, int height, bool useResampler = true) override
+    {
+        _stretchToWidth = width;
+        _stretchToHeight = height;
+    }
+    int GetWidth() override { return _width; }
+    int GetHeight() override { return _height; }
+    int GetColorDepth() override { return _colDepth; }
+    void SetLightLevel(int lightLevel) override { }
+    void SetTint(int red, int green, int blue, int tintSaturation) override { }
+
+    MemoryDDB(Bitmap *bmp, bool opaque, bool hasAlpha)
+    {
+        _bmp = bmp;
+        _width = bmp->GetWidth();
+        _height = bmp->GetHeight();
+        _colDepth = bmp->GetColorDepth();
+        _flipped = false;
+        _stretchToWidth = 0;
+        _stretchToHeight = 0;
+        _transparency = 0;
+        _opaque = opaque;
+        _hasAlpha = hasAlpha;
+    }
+
+    int GetWidthToRender() { return (_stretchToWidth > 0) ? _stretchToWidth : _width; }
+    int GetHeightToRender() { return (_stretchToHeight > 0) ? _stretchToHeight : _height; }
+
+    Bitmap *_bmp;
+    int _width, _height;
+    int _colDepth;
+    bool _flipped;
+    int _stretchToWidth, _stretchToHeight;
+    bool _opaque;
+    bool _hasAlpha;
+    int _transparency;
+};
+
+
+typedef SpriteDrawListEntry<MemoryDDB> MemoryDrawListEntry;
+// Software renderer's sprite batch
+struct MemorySpriteBatch final
+{
+    // List of sprites to render
+    std::vector<MemoryDrawListEntry> List;
+    // Intermediate surface which will be drawn upon and transformed if necessary
+    std::shared_ptr<Bitmap>          Surface;
+    // Tells whether the surface is treated as opaque or transparent
+    bool                             Opaque = false;
+};
+typedef std::vector<MemorySpriteBatch> MemorySpriteBatches;
+
+
+class MemoryBatchRenderer
+{
+public:
+    MemoryBatchRenderer();
+    ~MemoryBatchRenderer();
+
+    // Sets the number of threads the sprites are drawn on, 0 for one thread
+    // per CPU core
+    void SetThreadCount(int count);
+
+    // Prepares the batch's surface for the given description; the batch is
+    // either drawn on its own surface, or directly on the virtual screen
+    static void InitSpriteBatch(MemorySpriteBatch &batch, const SpriteBatchDesc &desc,
+        Bitmap *virtual_screen, const Point &virtual_scr_off);
+    // Renders single sprite batch on the surface, then tints the surface
+    // if any of the tint components is set. Null sprites are passed to the
+    // callback, and cause exception if there's none.
+    void RenderSpriteBatch(const MemorySpriteBatch &batch, Bitmap *surface, int surf_offx, int surf_offy,
+        GFXDRV_CLIENTCALLBACKXY null_sprite_callback, int tint_red, int tint_green, int tint_blue);
+
+private:
+    // Drawing operation which may be done on the surface bands in parallel
+    struct BandOp
+    {
+        enum OpKind
+        {
+            kBandOp_Blit,       // plain copy
+            kBandOp_MaskedBlit, // copy skipping the mask color
+            kBandOp_TransRows,  // blend with the trans row blender
+            kBandOp_LitRows     // blend with the lit row blender
+        };
+
+        OpKind  Kind;
+        Bitmap *Sprite;
+        int     X, Y;       // position on the surface
+        PfnTransRowBlender TransBlender;
+        PfnLitRowBlender   LitBlender;
+        unsigned long Param; // blender's alpha or color
+        unsigned long Light;
+    };
+
+    // Renders single draw list entry on the calling thread
+    void RenderSprite(const MemoryDrawListEntry &entry, Bitmap *surface, int surf_offx, int surf_offy,
+        GFXDRV_CLIENTCALLBACKXY null_sprite_callback);
+    // Queues the entry for drawing in bands; returns false if it has to be
+    // drawn by the calling thread, because it depends on the global state
+    bool QueueSprite(const MemoryDrawListEntry &entry, Bitmap *surface, int surf_offx, int surf_offy);
+    // Queues the surface tint; returns false if it has to be done by the
+    // calling thread
+    bool QueueTint(Bitmap *surface, int tint_red, int tint_green, int tint_blue);
+    // Draws queued operations on all the surface bands in parallel
+    void RenderBandOps(Bitmap *surface);
+    void RenderBand(size_t band_index);
+
+    // Number of threads requested for rendering
+    int _threadCount;
+    // Threads which draw the surface bands; null if rendering is done on
+    // the calling thread only
+    std::unique_ptr<WorkerPool> _pool;
+    // Operations queued for drawing in bands, in the draw list order
+    std::vector<BandOp> _bandOps;
+    // Sub-bitmaps of the surface, each drawn by one job
+    std::vector<std::unique_ptr<Bitmap>> _bands;
+    std::vector<int> _bandTop; // band's position on the surface
+    std::vector<size_t> _activeBands; // bands not excluded by the clip rect
+};
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_GFX__MEMORYRENDERER_H
@@ -0,0 +1,240 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <algorithm>
+#include "gfx/textureatlas.h"
+
+namespace AGS
+{
+namespace Engine
+{
+
+// Shelf heights are rounded up to this, so that the images of a close
+// height could share the shelf
+static const int ShelfHeightStep = 4;
+
+TextureAtlas::TextureAtlas()
+    : _pageWidth(0)
+    , _pageHeight(0)
+    , _maxPages(0)
+{
+}
+
+void TextureAtlas::Init(int page_width, int page_height, size_t max_pages)
+{
+    _pageWidth = page_width;
+    _pageHeight = page_height;
+    _maxPages = max_pages;
+    Reset();
+}
+
+void TextureAtlas::Reset()
+{
+    _pages.clear();
+}
+
+bool TextureAtlas::IsPageInUse(size_t page) const
+{
+    return page < _pages.size() && _pages[page].Allocs > 0;
+}
+
+TextureAtlas::Shelf TextureAtlas::MakeShelf(int y, int height) const
+{
+    Shelf shelf;
+    shelf.Y = y;
+    shelf.Height = height;
+    shelf.Allocs = 0;
+    Span span = { 0, _pageWidth };
+    shelf.Free.push_back(span);
+    return shelf;
+}
+
+bool TextureAtlas::TakeSpan(Shelf &shelf, int width, int &x)
+{
+    for (size_t i = 0; i < shelf.Free.size(); ++i)
+    {
+        Span &span = shelf.Free[i];
+        if (span.Width < width)
+            continue;
+        x = span.X;
+        span.X += width;
+        span.Width -= width;
+        if (span.Width == 0)
+            shelf.Free.erase(shelf.Free.begin() + i);
+        return true;
+    }
+    return false;
+}
+
+void TextureAtlas::Commit(size_t page_index, size_t shelf_index, int x, int width, int height, AtlasRegion &region)
+{
+    Page &page = _pages[page_index];
+    Shelf &shelf = page.Shelves[shelf_index];
+    shelf.Allocs++;
+    page.Allocs++;
+    region.Page = (int)page_index;
+    region.X = x;
+    region.Y = shelf.Y;
+    region.Width = width;
+    region.Height = height;
+}
+
+bool TextureAtlas::Allocate(int width, int height, AtlasRegion &region)
+{
+    if (width <= 0 || height <= 0 || width > _pageWidth || height > _pageHeight)
+        return false;
+    const int shelf_height = std::min(_pageHeight,
+        (height + ShelfHeightStep - 1) / ShelfHeightStep * ShelfHeightStep);
+    int x;
+
+    // Try the shelves of the same height first
+    for (size_t p = 0; p < _pages.size(); ++p)
+    {
+        std::vector<Shelf> &shelves = _pages[p].Shelves;
+        for (size_t s = 0; s < shelves.size(); ++s)
+        {
+            if (shelves[s].Height == shelf_height && TakeSpan(shelves[s], width, x))
+            {
+                Commit(p, s, x, width, height, region);
+                return true;
+            }
+        }
+    }
+    // Start a new shelf in the unused space of the page
+    for (size_t p = 0; p < _pages.size(); ++p)
+    {
+        Page &page = _pages[p];
+        if (page.Allocs == 0 || page.Top + shelf_height > _pageHeight)
+            continue;
+        page.Shelves.push_back(MakeShelf(page.Top, shelf_height));
+        page.Top += shelf_height;
+        TakeSpan(page.Shelves.back(), width, x);
+        Commit(p, page.Shelves.size() - 1, x, width, height, region);
+        return true;
+    }
+    // Split an empty shelf which is tall enough
+    for (size_t p = 0; p < _pages.size(); ++p)
+    {
+        std::vector<Shelf> &shelves = _pages[p].Shelves;
+        for (size_t s = 0; s < shelves.size(); ++s)
+        {
+            if (shelves[s].Allocs > 0 || shelves[s].Height < shelf_height)
+                continue;
+            if (shelves[s].Height > shelf_height)
+            {
+                const Shelf rest = MakeShelf(shelves[s].Y + shelf_height, shelves[s].Height - shelf_height);
+                shelves[s].Height = shelf_height;
+                shelves.insert(shelves.begin() + s + 1, rest);
+            }
+            TakeSpan(shelves[s], width, x);
+            Commit(p, s, x, width, height, region);
+            return true;
+        }
+    }
+    // Use a taller shelf, but don't waste more than a half of its height
+    for (size_t p = 0; p < _pages.size(); ++p)
+    {
+        std::vector<Shelf> &shelves = _pages[p].Shelves;
+        for (size_t s = 0; s < shelves.size(); ++s)
+        {
+            if (shelves[s].Height > shelf_height && shelves[s].Height <= shelf_height * 2 &&
+                TakeSpan(shelves[s], width, x))
+            {
+                Commit(p, s, x, width, height, region);
+                return true;
+            }
+        }
+    }
+    // Take a released page, or add a new one
+    size_t p = 0;
+    for (; p < _pages.size() && _pages[p].Allocs > 0; ++p);
+    if (p == _pages.size())
+    {
+        if (_pages.size() >= _maxPages)
+            return false;
+        _pages.push_back(Page());
+    }
+    Page &page = _pages[p];
+    page.Shelves.clear();
+    page.Shelves.push_back(MakeShelf(0, shelf_height));
+    page.Top = shelf_height;
+    page.Allocs = 0;
+    TakeSpan(page.Shelves.back(), width, x);
+    Commit(p, 0, x, width, height, region);
+    return true;
+}
+
+bool TextureAtlas::Free(const AtlasRegion &region)
+{
+    if (!region.IsValid() || (size_t)region.Page >= _pages.size())
+        return false;
+    Page &page = _pages[region.Page];
+    size_t s = 0;
+    for (; s < page.Shelves.size() && page.Shelves[s].Y != region.Y; ++s);
+    if (s == page.Shelves.size() || page.Shelves[s].Allocs == 0)
+        return false; // not allocated here
+
+    // Return the space to the shelf, merging it with the adjacent free spans
+    Shelf &shelf = page.Shelves[s];
+    std::vector<Span> &spans = shelf.Free;
+    size_t i = 0;
+    for (; i < spans.size() && spans[i].X < region.X; ++i);
+    Span span = { region.X, region.Width };
+    spans.insert(spans.begin() + i, span);
+    if (i + 1 < spans.size() && spans[i].X + spans[i].Width == spans[i + 1].X)
+    {
+        spans[i].Width += spans[i + 1].Width;
+        spans.erase(spans.begin() + i + 1);
+    }
+    if (i > 0 && spans[i - 1].X + spans[i - 1].Width == spans[i].X)
+    {
+        spans[i - 1].Width += spans[i].Width;
+        spans.erase(spans.begin() + i);
+    }
+    shelf.Allocs--;
+    page.Allocs--;
+
+    if (page.Allocs == 0)
+    {
+        page.Shelves.clear();
+        page.Top = 0;
+        return true;
+    }
+    if (shelf.Allocs == 0)
+        MergeEmptyShelves(page);
+    return false;
+}
+
+void TextureAtlas::MergeEmptyShelves(Page &page)
+{
+    std::vector<Shelf> &shelves = page.Shelves;
+    for (size_t s = 0; s < shelves.size();)
+    {
+        if (shelves[s].Allocs == 0 && s + 1 < shelves.size() && shelves[s + 1].Allocs == 0)
+        {
+            shelves[s].Height += shelves[s + 1].Height;
+            shelves.erase(shelves.begin() + s + 1);
+            continue;
+        }
+        ++s;
+    }
+    while (!shelves.empty() && shelves.back().Allocs == 0)
+    {
+        page.Top = shelves.back().Y;
+        shelves.pop_back();
+    }
+}
+
+} // namespace Engine
+} // namespace AGS
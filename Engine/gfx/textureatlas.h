@@ -0,0 +1,116 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Texture atlas allocator, which packs small images into the shared pages.
+//
+// The allocator only does the bookkeeping; the pages are the textures
+// owned by the graphics driver. Each page is divided into horizontal
+// shelves of the similar height, and the images are placed in the shelves
+// from left to right. Freed space is returned to its shelf; the shelves
+// which became empty are merged with the empty neighbours, so that they
+// may be split again for the images of a different height. A page which
+// has no images left is released, and the driver should delete its texture.
+//
+//=============================================================================
+#ifndef __AGS_EE_GFX__TEXTUREATLAS_H
+#define __AGS_EE_GFX__TEXTUREATLAS_H
+
+#include <stddef.h>
+#include <vector>
+
+namespace AGS
+{
+namespace Engine
+{
+
+// Location of the image in the atlas
+struct AtlasRegion
+{
+    int Page;  // page index, or -1 if the region is not allocated
+    int X;
+    int Y;
+    int Width;
+    int Height;
+
+    AtlasRegion()
+        : Page(-1), X(0), Y(0), Width(0), Height(0) {}
+
+    bool IsValid() const { return Page >= 0; }
+};
+
+class TextureAtlas
+{
+public:
+    TextureAtlas();
+
+    // Sets the page size and the max number of pages; releases all pages
+    void Init(int page_width, int page_height, size_t max_pages);
+    // Releases all pages
+    void Reset();
+
+    int  GetPageWidth() const { return _pageWidth; }
+    int  GetPageHeight() const { return _pageHeight; }
+    // Gets the number of page slots, including the released ones
+    size_t GetPageCount() const { return _pages.size(); }
+    // Tells if the page has any images on it
+    bool IsPageInUse(size_t page) const;
+
+    // Allocates the region of the given size; returns false if there's no
+    // room left in the existing pages and no more pages may be added
+    bool Allocate(int width, int height, AtlasRegion &region);
+    // Frees the region; returns true if its page became empty and released
+    bool Free(const AtlasRegion &region);
+
+private:
+    // Free horizontal space in the shelf
+    struct Span
+    {
+        int X;
+        int Width;
+    };
+
+    struct Shelf
+    {
+        int    Y;
+        int    Height;
+        size_t Allocs;           // number of images in the shelf
+        std::vector<Span> Free;  // free spans, sorted by X
+    };
+
+    struct Page
+    {
+        std::vector<Shelf> Shelves; // sorted by Y
+        int    Top;                 // beginning of the unused page space
+        size_t Allocs;              // number of images on the page
+    };
+
+    // Makes an empty shelf of the full page width
+    Shelf MakeShelf(int y, int height) const;
+    // Takes the space from the shelf's free spans, returns false if there's none
+    static bool TakeSpan(Shelf &shelf, int width, int &x);
+    // Registers the image taken from the page's shelf, and fills the region
+    void Commit(size_t page_index, size_t shelf_index, int x, int width, int height, AtlasRegion &region);
+    // Merges adjacent empty shelves, and gives empty top shelves back to the page
+    void MergeEmptyShelves(Page &page);
+
+    int    _pageWidth;
+    int    _pageHeight;
+    size_t _maxPages;
+    std::vector<Page> _pages;
+};
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_GFX__TEXTUREATLAS_H
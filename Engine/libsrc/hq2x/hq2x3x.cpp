@@ -17,11 +17,13 @@
 //Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <stdlib.h>
+#include <utility>
+#include <vector>
 #include "core/types.h"
 
 static int   LUT16to32[65536];
 static int   RGBtoYUV[65536];
-static int   YUV1, YUV2;
+static bool  LUTsReady = false;
 const  int   Ymask = 0x00FF0000;
 const  int   Umask = 0x0000FF00;
 const  int   Vmask = 0x000000FF;
@@ -144,24 +146,97 @@ inline void Interp10(unsigned char * pc, int c1, int c2, int c3)
 
 
 
-inline bool Diff(unsigned int w1, unsigned int w2)
+// Tells if the two YUV colors differ above the threshold; returns 0 or 1.
+// Uses no branches, so that the loops over the rows could be vectorized.
+inline int YUVDiffer(int YUV1, int YUV2)
 {
-  YUV1 = RGBtoYUV[w1];
-  YUV2 = RGBtoYUV[w2];
-  return ( ( abs((YUV1 & Ymask) - (YUV2 & Ymask)) > trY ) ||
-           ( abs((YUV1 & Umask) - (YUV2 & Umask)) > trU ) ||
+  return ( ( abs((YUV1 & Ymask) - (YUV2 & Ymask)) > trY ) |
+           ( abs((YUV1 & Umask) - (YUV2 & Umask)) > trU ) |
            ( abs((YUV1 & Vmask) - (YUV2 & Vmask)) > trV ) );
 }
 
-#define INPUT_IMAGE_PIXEL_SIZE uint32_t
-#define INPUT_IMAGE_PIXEL_SIZE_IN_BYTES sizeof(INPUT_IMAGE_PIXEL_SIZE)
+inline bool Diff(unsigned int w1, unsigned int w2)
+{
+  return YUVDiffer(RGBtoYUV[w1], RGBtoYUV[w2]) != 0;
+}
 
-void hq2x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL )
+// Input rows above, at and below the one being scaled, converted down to
+// 16-bit and to YUV. Each row has the edge pixels repeated on both sides,
+// so the pixel i has its neighbours at i and i + 2.
+// The rows are kept per call, which lets the threads scale different
+// parts of the image at the same time.
+struct HqxRows
+{
+  std::vector<int> W16[3];
+  std::vector<int> YUV[3];
+  std::vector<int> Pattern; // neighbour difference flags for each pixel
+
+  HqxRows(int Xres)
+  {
+    for (int r = 0; r < 3; r++)
+    {
+      W16[r].resize(Xres + 2);
+      YUV[r].resize(Xres + 2);
+    }
+    Pattern.resize(Xres);
+  }
+
+  void ConvertRow(int r, const unsigned char *pIn, int Xres, int y)
+  {
+    const uint32_t *src = (const uint32_t*)(pIn + y * Xres * 4);
+    int *w16 = &W16[r][0];
+    int *yuv = &YUV[r][0];
+    for (int i = 0; i < Xres; i++)
+    {
+      w16[i + 1] = ((((src[i] >> 16) & 0x00ff) / 8) << 11) +
+        ((((src[i] >> 8) & 0x00ff) / 4) << 5) +
+        ((src[i] & 0x00ff) / 8);
+    }
+    w16[0] = w16[1];
+    w16[Xres + 1] = w16[Xres];
+    for (int i = 0; i < Xres + 2; i++)
+      yuv[i] = RGBtoYUV[w16[i]];
+  }
+
+  // Prepares the rows for scaling the row y; rows are expected to go in order
+  void Fill(const unsigned char *pIn, int Xres, int Yres, int y, bool first)
+  {
+    const int next_y = y < Yres - 1 ? y + 1 : y;
+    if (first)
+    {
+      ConvertRow(0, pIn, Xres, y > 0 ? y - 1 : y);
+      ConvertRow(1, pIn, Xres, y);
+    }
+    else
+    {
+      std::swap(W16[0], W16[1]); std::swap(W16[1], W16[2]);
+      std::swap(YUV[0], YUV[1]); std::swap(YUV[1], YUV[2]);
+    }
+    ConvertRow(2, pIn, Xres, next_y);
+
+    const int *up = &YUV[0][0];
+    const int *mid = &YUV[1][0];
+    const int *down = &YUV[2][0];
+    int *pattern = &Pattern[0];
+    for (int i = 0; i < Xres; i++)
+    {
+      const int yuv = mid[i + 1];
+      pattern[i] =
+        YUVDiffer(yuv, up[i])            | (YUVDiffer(yuv, up[i + 1]) << 1)   |
+        (YUVDiffer(yuv, up[i + 2]) << 2)  | (YUVDiffer(yuv, mid[i]) << 3)     |
+        (YUVDiffer(yuv, mid[i + 2]) << 4) | (YUVDiffer(yuv, down[i]) << 5)    |
+        (YUVDiffer(yuv, down[i + 1]) << 6) | (YUVDiffer(yuv, down[i + 2]) << 7);
+    }
+  }
+};
+
+
+void hq2x_32_rows( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL, int y_from, int y_to )
 {
   int  i, j, k;
-  int  prevline, nextline;
   int  w[10];
   int  c[10];
+  HqxRows rows(Xres);
 
   //   +----+----+----+
   //   |    |    |    |
@@ -174,69 +249,21 @@ void hq2x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int
   //   | w7 | w8 | w9 |
   //   +----+----+----+
 
-  for (j=0; j<Yres; j++)
+  pOut += y_from * 2 * BpL;
+  for (j=y_from; j<y_to; j++)
   {
-    if (j>0)      prevline = -Xres*4; else prevline = 0;
-    if (j<Yres-1) nextline =  Xres*4; else nextline = 0;
+    rows.Fill(pIn, Xres, Yres, j, j == y_from);
+    const int *up = &rows.W16[0][0];
+    const int *mid = &rows.W16[1][0];
+    const int *down = &rows.W16[2][0];
 
     for (i=0; i<Xres; i++)
     {
-      w[2] = *((INPUT_IMAGE_PIXEL_SIZE*)(pIn + prevline));
-      w[5] = *((INPUT_IMAGE_PIXEL_SIZE*)pIn);
-      w[8] = *((INPUT_IMAGE_PIXEL_SIZE*)(pIn + nextline));
-
-      if (i>0)
-      {
-        w[1] = *((INPUT_IMAGE_PIXEL_SIZE*)(pIn + prevline - INPUT_IMAGE_PIXEL_SIZE_IN_BYTES));
-        w[4] = *((INPUT_IMAGE_PIXEL_SIZE*)(pIn - INPUT_IMAGE_PIXEL_SIZE_IN_BYTES));
-        w[7] = *((INPUT_IMAGE_PIXEL_SIZE*)(pIn + nextline - INPUT_IMAGE_PIXEL_SIZE_IN_BYTES));
-      }
-      else
-      {
-        w[1] = w[2];
-        w[4] = w[5];
-        w[7] = w[8];
-      }
-
-      if (i<Xres-1)
-      {
-        w[3] = *((INPUT_IMAGE_PIXEL_SIZE*)(pIn + prevline + INPUT_IMAGE_PIXEL_SIZE_IN_BYTES));
-        w[6] = *((INPUT_IMAGE_PIXEL_SIZE*)(pIn + INPUT_IMAGE_PIXEL_SIZE_IN_BYTES));
-        w[9] = *((INPUT_IMAGE_PIXEL_SIZE*)(pIn + nextline + INPUT_IMAGE_PIXEL_SIZE_IN_BYTES));
-      }
-      else
-      {
-        w[3] = w[2];
-        w[6] = w[5];
-        w[9] = w[8];
-      }
-
-      // convert down to 16-bit
-      for (k = 1; k <= 9; k++) {
-        w[k] = (((((w[k] >> 16) & 0x00ff) / 8) << 11) +
-          ((((w[k] >> 8) & 0x00ff) / 4) << 5) +
-          ((w[k]  & 0x00ff) / 8)) & 0x000ffff;
-      }
-
-      int pattern = 0;
-      int flag = 1;
-
-      YUV1 = RGBtoYUV[w[5]];
-
-      for (k=1; k<=9; k++)
-      {
-        if (k==5) continue;
+      w[1] = up[i];   w[2] = up[i + 1];   w[3] = up[i + 2];
+      w[4] = mid[i];  w[5] = mid[i + 1];  w[6] = mid[i + 2];
+      w[7] = down[i]; w[8] = down[i + 1]; w[9] = down[i + 2];
 
-        if ( w[k] != w[5] )
-        {
-          YUV2 = RGBtoYUV[w[k]];
-          if ( ( abs((YUV1 & Ymask) - (YUV2 & Ymask)) > trY ) ||
-               ( abs((YUV1 & Umask) - (YUV2 & Umask)) > trU ) ||
-               ( abs((YUV1 & Vmask) - (YUV2 & Vmask)) > trV ) )
-            pattern |= flag;
-        }
-        flag <<= 1;
-      }
+      int pattern = rows.Pattern[i];
 
       for (k=1; k<=9; k++)
         c[k] = LUT16to32[w[k]];
@@ -2883,17 +2910,25 @@ void hq2x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int
           break;
         }
       }
-      pIn += INPUT_IMAGE_PIXEL_SIZE_IN_BYTES;
       pOut+=8;
     }
     pOut+=BpL + (BpL - Xres * 8);
   }
 }
 
+void hq2x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL )
+{
+  hq2x_32_rows(pIn, pOut, Xres, Yres, BpL, 0, Yres);
+}
+
 void InitLUTs(void)
 {
   int i, j, k, r, g, b, Y, u, v;
 
+  if (LUTsReady)
+    return; // tables do not depend on anything
+  LUTsReady = true;
+
   for (i=0; i<65536; i++)
     LUT16to32[i] = ((i & 0xF800) << 8) + ((i & 0x07E0) << 5) + ((i & 0x001F) << 3);
 
@@ -2972,12 +3007,12 @@ void InitLUTs(void)
 
 
 
-void hq3x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL )
+void hq3x_32_rows( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL, int y_from, int y_to )
 {
   int  i, j, k;
-  int  prevline, nextline;
   int  w[10];
   int  c[10];
+  HqxRows rows(Xres);
 
   //   +----+----+----+
   //   |    |    |    |
@@ -2990,69 +3025,21 @@ void hq3x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int
   //   | w7 | w8 | w9 |
   //   +----+----+----+
 
-  for (j=0; j<Yres; j++)
+  pOut += y_from * 3 * BpL;
+  for (j=y_from; j<y_to; j++)
   {
-    if (j>0)      prevline = -Xres*4; else prevline = 0;
-    if (j<Yres-1) nextline =  Xres*4; else nextline = 0;
+    rows.Fill(pIn, Xres, Yres, j, j == y_from);
+    const int *up = &rows.W16[0][0];
+    const int *mid = &rows.W16[1][0];
+    const int *down = &rows.W16[2][0];
 
     for (i=0; i<Xres; i++)
     {
-      w[2] = *((INPUT_IMAGE_PIXEL_SIZE*)(pIn + prevline));
-      w[5] = *((INPUT_IMAGE_PIXEL_SIZE*)pIn);
-      w[8] = *((INPUT_IMAGE_PIXEL_SIZE*)(pIn + nextline));
+      w[1] = up[i];   w[2] = up[i + 1];   w[3] = up[i + 2];
+      w[4] = mid[i];  w[5] = mid[i + 1];  w[6] = mid[i + 2];
+      w[7] = down[i]; w[8] = down[i + 1]; w[9] = down[i + 2];
 
-      if (i>0)
-      {
-        w[1] = *((INPUT_IMAGE_PIXEL_SIZE*)(pIn + prevline - INPUT_IMAGE_PIXEL_SIZE_IN_BYTES));
-        w[4] = *((INPUT_IMAGE_PIXEL_SIZE*)(pIn - INPUT_IMAGE_PIXEL_SIZE_IN_BYTES));
-        w[7] = *((INPUT_IMAGE_PIXEL_SIZE*)(pIn + nextline - INPUT_IMAGE_PIXEL_SIZE_IN_BYTES));
-      }
-      else
-      {
-        w[1] = w[2];
-        w[4] = w[5];
-        w[7] = w[8];
-      }
-
-      if (i<Xres-1)
-      {
-        w[3] = *((INPUT_IMAGE_PIXEL_SIZE*)(pIn + prevline + INPUT_IMAGE_PIXEL_SIZE_IN_BYTES));
-        w[6] = *((INPUT_IMAGE_PIXEL_SIZE*)(pIn + INPUT_IMAGE_PIXEL_SIZE_IN_BYTES));
-        w[9] = *((INPUT_IMAGE_PIXEL_SIZE*)(pIn + nextline + INPUT_IMAGE_PIXEL_SIZE_IN_BYTES));
-      }
-      else
-      {
-        w[3] = w[2];
-        w[6] = w[5];
-        w[9] = w[8];
-      }
-
-      // convert down to 16-bit
-      for (k = 1; k <= 9; k++) {
-        w[k] = (((((w[k] >> 16) & 0x00ff) / 8) << 11) +
-          ((((w[k] >> 8) & 0x00ff) / 4) << 5) +
-          ((w[k]  & 0x00ff) / 8)) & 0x000ffff;
-      }
-
-      int pattern = 0;
-      int flag = 1;
-
-      YUV1 = RGBtoYUV[w[5]];
-
-      for (k=1; k<=9; k++)
-      {
-        if (k==5) continue;
-
-        if ( w[k] != w[5] )
-        {
-          YUV2 = RGBtoYUV[w[k]];
-          if ( ( abs((YUV1 & Ymask) - (YUV2 & Ymask)) > trY ) ||
-               ( abs((YUV1 & Umask) - (YUV2 & Umask)) > trU ) ||
-               ( abs((YUV1 & Vmask) - (YUV2 & Vmask)) > trV ) )
-            pattern |= flag;
-        }
-        flag <<= 1;
-      }
+      int pattern = rows.Pattern[i];
 
       for (k=1; k<=9; k++)
         c[k] = LUT16to32[w[k]];
@@ -6672,10 +6659,14 @@ void hq3x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int
           break;
         }
       }
-      pIn += INPUT_IMAGE_PIXEL_SIZE_IN_BYTES;
       pOut+=12;
     }
     pOut+=BpL + (BpL - Xres * 12);
     pOut+=BpL;
   }
 }
+
+void hq3x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL )
+{
+  hq3x_32_rows(pIn, pOut, Xres, Yres, BpL, 0, Yres);
+}
@@ -21,10 +21,16 @@
 void InitLUTs(){}
 void hq2x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL ){}
 void hq3x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL ){}
+void hq2x_32_rows( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL, int y_from, int y_to ){}
+void hq3x_32_rows( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL, int y_from, int y_to ){}
 #else
 void InitLUTs();
 void hq2x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL );
 void hq3x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL );
+// Scale only the input rows from y_from to y_to - 1, writing the matching
+// output rows; the parts of the same image may be scaled in parallel
+void hq2x_32_rows( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL, int y_from, int y_to );
+void hq3x_32_rows( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL, int y_from, int y_to );
 #endif
 
 #endif // __AC_HQ2X3X_H
\ No newline at end of file
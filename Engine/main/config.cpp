@@ -556,6 +556,9 @@ void apply_config(const ConfigTree &cfg)
         usetup.Screen.DisplayMode.VSync = INIreadint(cfg, "graphics", "vsync") > 0;
         usetup.RenderAtScreenRes = INIreadint(cfg, "graphics", "render_at_screenres") > 0;
         usetup.Supersampling = INIreadint(cfg, "graphics", "supersampling", 1);
+        usetup.RenderThreads = INIreadint(cfg, "graphics", "render_threads", 1);
+        usetup.FrameDumpInterval = INIreadint(cfg, "graphics", "frame_dump_interval");
+        usetup.FrameDumpDir = INIreadstring(cfg, "graphics", "frame_dump_dir");
 
         usetup.enable_antialiasing = INIreadint(cfg, "misc", "antialias") > 0;
 
@@ -570,6 +573,19 @@ void apply_config(const ConfigTree &cfg)
         int cache_size_kb = INIreadint(cfg, "misc", "cachemax", DEFAULTCACHESIZE_KB);
         if (cache_size_kb > 0)
             spriteset.SetMaxCacheSize((size_t)cache_size_kb * 1024);
+        const char *cache_policy_options[kNumSprCachePolicies] = { "lru", "slru" };
+        String cache_policy_str = INIreadstring(cfg, "misc", "cache_policy", "slru");
+        for (int i = 0; i < kNumSprCachePolicies; ++i)
+        {
+            if (cache_policy_str.CompareNoCase(cache_policy_options[i]) == 0)
+            {
+                spriteset.SetCachePolicy((SpriteCachePolicy)i);
+                break;
+            }
+        }
+
+        usetup.BatchPathfinding = INIreadint(cfg, "misc", "batch_pathfinding") > 0;
+        usetup.Unthrottled = INIreadint(cfg, "misc", "unthrottled") > 0;
 
         usetup.mouse_auto_lock = INIreadint(cfg, "mouse", "auto_lock") > 0;
 
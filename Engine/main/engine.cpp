@@ -435,6 +435,7 @@ void engine_init_timer()
 {
     Debug::Printf(kDbgMsg_Init, "Install timer");
 
+    setTimerUnthrottled(usetup.Unthrottled);
     skipMissedTicks();
 }
 
@@ -1456,6 +1457,11 @@ int initialize_engine(const ConfigTree &startup_opts)
 
     //-----------------------------------------------------
     // Install backend
+    // The offscreen renderer may run without a display, but SDL has to be told
+    // so before it's initialized, when only the command line options are known
+    const String startup_driver = INIreadstring(startup_opts, "graphics", "driver");
+    if (startup_driver.CompareNoCase("Null") == 0 || startup_driver.CompareNoCase("Offscreen") == 0)
+        SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
     if (!engine_init_allegro())
         return EXIT_ERROR;
 
@@ -1614,6 +1620,7 @@ bool engine_try_set_gfxmode_any(const ScreenSetup &setup)
     const Size init_desktop = get_desktop_size();
     if (!graphics_mode_init_any(game.GetGameRes(), setup, ColorDepthOption(game.GetColorDepth())))
         return false;
+    gfxDriver->SetFrameDump(usetup.FrameDumpInterval, usetup.FrameDumpDir);
 
     const Size ignored;
     engine_post_gfxmode_setup(ignored);
@@ -169,9 +169,9 @@ void main_print_help() {
            "  --fullscreen                 Force display mode to fullscreen\n"
            "  --gfxdriver <id>             Request graphics driver. Available options:\n"
 #if AGS_PLATFORM_OS_WINDOWS
-           "                                 d3d9, dx5, ogl, software\n"
+           "                                 d3d9, dx5, ogl, software, null\n"
 #else
-           "                                 ogl, software\n"
+           "                                 ogl, software, null\n"
 #endif
            "  --gfxfilter <filter> [<scaling>]\n"
            "                               Request graphics filter. Available options:\n"           
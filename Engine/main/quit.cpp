@@ -22,6 +22,8 @@
 #include "ac/gamesetupstruct.h"
 #include "ac/roomstatus.h"
 #include "ac/translation.h"
+#include "ac/dynobj/managedobjectpool.h"
+#include "util/slaballocator.h"
 #include "debug/agseditordebugger.h"
 #include "debug/debug_log.h"
 #include "debug/debugger.h"
@@ -267,6 +269,19 @@ void quit(const char *quitmsg)
     shutdown_font_renderer();
     our_eip = 9902;
 
+    const SpriteCacheStats &spr_stats = spriteset.GetStats();
+    Debug::Printf(kDbgMsg_Init, "Sprite cache stats: hits %llu, misses %llu, prefetched %llu, evictions %llu (%llu KB)",
+        (unsigned long long)spr_stats.Hits, (unsigned long long)spr_stats.Misses, (unsigned long long)spr_stats.Prefetched,
+        (unsigned long long)spr_stats.Evictions, (unsigned long long)(spr_stats.EvictedBytes / 1024));
+    const ManagedObjectPoolStats &pool_stats = pool.GetStats();
+    Debug::Printf(kDbgMsg_Init, "Managed pool stats: objects %u, collections %llu, collected %llu, GC time %llu us (max step %llu us)",
+        pool_stats.objects, (unsigned long long)pool_stats.collections, (unsigned long long)pool_stats.collected,
+        (unsigned long long)pool_stats.pauseTotalUs, (unsigned long long)pool_stats.pauseMaxUs);
+    const SlabAllocatorStats &data_stats = ccGetManagedDataStats();
+    Debug::Printf(kDbgMsg_Init, "Managed data allocator stats: allocations %llu (%llu large), live %llu KB in %llu blocks, reserved %llu KB, fragmentation %.1f%%",
+        (unsigned long long)data_stats.Allocations, (unsigned long long)data_stats.LargeAllocations,
+        (unsigned long long)(data_stats.LiveBytes / 1024), (unsigned long long)data_stats.LiveBlocks,
+        (unsigned long long)(data_stats.ReservedBytes / 1024), data_stats.GetFragmentation() * 100.f);
     spriteset.Reset();
 
     our_eip = 9907;
@@ -21,6 +21,7 @@
 #include "ac/character.h"
 #include "ac/characterextras.h"
 #include "ac/draw.h"
+#include "ac/gamesetup.h"
 #include "ac/gamestate.h"
 #include "ac/gamesetupstruct.h"
 #include "ac/global_character.h"
@@ -213,6 +214,10 @@ void update_shadow_areas()
 
 void update_character_move_and_anim(int &numSheep, int *followingAsSheep)
 {
+  // the follower walks made during the update may be searched in parallel
+  if (usetup.BatchPathfinding)
+    begin_walk_batch();
+
 	// move & animate characters
   for (int aa=0;aa<game.numcharacters;aa++) {
     if (game.chars[aa].on != 1) continue;
@@ -222,6 +227,9 @@ void update_character_move_and_anim(int &numSheep, int *followingAsSheep)
 
 	chi->UpdateMoveAndAnim(aa, chex, numSheep, followingAsSheep);
   }
+
+  if (usetup.BatchPathfinding)
+    end_walk_batch();
 }
 
 void update_following_exactly_characters(int &numSheep, int *followingAsSheep)
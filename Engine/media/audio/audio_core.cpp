@@ -9,7 +9,10 @@
 #include <iostream>
 #include <deque>
 #include <chrono>
-#include <future>
+#include <atomic>
+#include <condition_variable>
+#include <thread>
+#include <algorithm>
 
 #include "core/platform.h"
 
@@ -48,6 +51,13 @@ const auto SourceMinimumQueuedBuffers = 2;
 
 const auto GlobalGainScaling = 0.7f;
 
+// The audio thread sleeps until a command arrives or one of the sources
+// finishes playing its current buffer; these limit the sleep time
+const auto MinPollDelayMs = 1.0f;
+const auto MaxPollDelayMs = 100.0f;
+
+using AudioCoreClock = std::chrono::steady_clock;
+
 
 struct SoundSampleDeleterFunctor {
     void operator()(Sound_Sample* p) {
@@ -61,9 +71,23 @@ struct SoundSampleDeleterFunctor {
 using SoundSampleUniquePtr = std::unique_ptr<Sound_Sample, SoundSampleDeleterFunctor>;
 
 static void audio_core_entry();
+static void audio_core_wakeup();
+
 
+// Audio asset which is read by the decoder in chunks, as the playback goes;
+// asset may be located inside a larger package file, so the reads are
+// restricted to its own range.
+struct AudioAssetStream
+{
+    std::unique_ptr<AGS::Common::Stream> stream;
+    soff_t start = 0;
+    soff_t size = 0;
+};
 
-enum AudioCoreSlotCommandType { Nothing, Initialise, Play, Pause, StopAndRelease, Seek};
+using AudioAssetStreamPtr = std::unique_ptr<AudioAssetStream>;
+
+
+enum AudioCoreSlotCommandType { Nothing, Initialise, Play, Pause, Stop, StopAndRelease, Seek};
 
 struct AudioCoreSlotCommand 
 {
@@ -71,10 +95,58 @@ struct AudioCoreSlotCommand
 
     AudioCoreSlotCommandType command = AudioCoreSlotCommandType::Nothing;
 
-    std::vector<char> sampledata;
-    AGS::Common::String sampleext;
-
     float seekPosMs = -1.0f;
+
+    // when the command was issued, for the latency stats
+    AudioCoreClock::time_point issuedAt {};
+};
+
+
+// Lock-free queue of the commands from the game thread to the audio thread.
+// Any number of threads may push, and only the audio thread pops; pushing
+// never waits for the audio thread (Vyukov's MPSC queue).
+class AudioCoreCommandQueue
+{
+private:
+    struct Node
+    {
+        AudioCoreSlotCommand command;
+        std::atomic<Node*> next {nullptr};
+    };
+
+    // producers append after the head, consumer reads after the tail;
+    // tail is always a node which was already read, or the initial one
+    std::atomic<Node*> head_;
+    Node *tail_;
+
+public:
+    AudioCoreCommandQueue() : head_(new Node()), tail_(head_.load()) {}
+    ~AudioCoreCommandQueue()
+    {
+        while (tail_) {
+            auto next = tail_->next.load();
+            delete tail_;
+            tail_ = next;
+        }
+    }
+
+    void Push(AudioCoreSlotCommand command)
+    {
+        auto node = new Node();
+        node->command = std::move(command);
+        auto prev = head_.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    bool Pop(AudioCoreSlotCommand &command)
+    {
+        auto next = tail_->next.load(std::memory_order_acquire);
+        if (!next) { return false; }
+        command = std::move(next->command);
+        delete tail_;
+        tail_ = next;
+        return true;
+    }
 };
 
 
@@ -88,8 +160,7 @@ private:
 
     AudioCorePlayState playState_ = PlayStateInitial;
 
-    std::future<std::vector<char>> sampleBufFuture_ {};
-    std::vector<char> sampleData_ {};
+    AudioAssetStreamPtr asset_ = nullptr;
     AGS::Common::String sampleExt_ = "";
     ALenum sampleOpenAlFormat_ = 0;
     SoundSampleUniquePtr sample_ = nullptr;
@@ -98,15 +169,19 @@ private:
     float onLoadPositionMs = 0.0f;
 
     float processedBuffersDurationMs_ = 0.0f;
+    // durations of the buffers in the source queue, in the play order
+    std::deque<float> queuedBuffersDurationMs_ {};
 
     bool EOS_ = false;
+    // source was started by us, so stopping by itself means it ran out of data
+    bool sourceStarted_ = false;
 
     static float buffer_duration_ms(ALuint bufferID);
     static ALenum openalFormatFromSample(const SoundSampleUniquePtr &sample);
     void DecoderUnqueueProcessedBuffers();
 
 public:
-    OpenALDecoder(ALuint source, std::future<std::vector<char>> sampleBufFuture, AGS::Common::String sampleExt, bool repeat);
+    OpenALDecoder(ALuint source, AudioAssetStreamPtr asset, AGS::Common::String sampleExt, bool repeat);
     void Poll();
     void Play();
     void Pause();
@@ -114,6 +189,8 @@ public:
     void Seek(float pos_ms);
     AudioCorePlayState GetPlayState();
     float GetPositionMs();
+    // Tells how soon the decoder should be polled again to keep the source fed
+    float GetNextPollDelayMs();
 };
 
 
@@ -124,7 +201,20 @@ struct AudioCoreSlot
     int handle_ = -1;
     std::atomic<ALuint> source_ {0};
 
+    // guards the decoder, which is polled by the audio thread and queried
+    // by the game thread
+    std::mutex mutex_;
     OpenALDecoder decoder_;
+
+    // State the slot will have after the queued commands are applied; it is
+    // reported to the game thread instead of the decoder's state until then,
+    // so that the queries right after a command see its result.
+    // Also guarded by the mutex.
+    int pendingCommands_ = 0;
+    bool hasPendingState_ = false;
+    AudioCorePlayState pendingState_ = PlayStateInitial;
+    bool hasPendingPos_ = false;
+    float pendingPosMs_ = 0.0f;
 };
 
 
@@ -135,17 +225,32 @@ static struct
     ALCcontext *alcContext = nullptr;
 
     std::thread audio_core_thread;
-    bool audio_core_thread_running = false;
+    std::atomic<bool> audio_core_thread_running {false};
 
     // slot ids
     int nextId = 0;
 
+    // wakes up the audio thread; the mutex only guards the wakeup flag
     std::mutex mixer_mutex_m;
     std::condition_variable mixer_cv;
+    bool mixer_wakeup = false;
+
+    // slots by handle; locked only to add or find a slot
+    std::mutex slots_mutex_;
     std::unordered_map<int, std::unique_ptr<AudioCoreSlot>> slots_;
 
+    AudioCoreCommandQueue commands_;
+
+    // owned by the audio thread
+    std::vector<AudioCoreSlot*> activeSlots_;
     std::vector<ALuint> freeBuffers_;
 
+    // instrumentation, written by the audio thread
+    std::atomic<uint64_t> underruns {0};
+    std::atomic<uint64_t> commandCount {0};
+    std::atomic<uint64_t> commandLatencyTotalUs {0};
+    std::atomic<uint64_t> commandLatencyMaxUs {0};
+
 } global_;
 
 
@@ -177,30 +282,115 @@ void dump_al_errors()
 
 
 // -------------------------------------------------------------------------------------------------
-// AUDIO ASSET INFO
+// ASSET STREAMS
 // -------------------------------------------------------------------------------------------------
 
-float audio_core_asset_length_ms(const AssetPath &asset_path)
+static Sint64 SDLCALL asset_rw_size(SDL_RWops *rw)
+{
+    auto asset = static_cast<AudioAssetStream*>(rw->hidden.unknown.data1);
+    return asset->size;
+}
+
+static Sint64 SDLCALL asset_rw_seek(SDL_RWops *rw, Sint64 offset, int whence)
+{
+    auto asset = static_cast<AudioAssetStream*>(rw->hidden.unknown.data1);
+    Sint64 pos = asset->stream->GetPosition() - asset->start;
+    switch (whence) {
+        case RW_SEEK_SET: pos = offset; break;
+        case RW_SEEK_CUR: pos += offset; break;
+        case RW_SEEK_END: pos = asset->size + offset; break;
+        default: return SDL_SetError("Unknown seek origin");
+    }
+    if (pos < 0) { return SDL_SetError("Seek before the asset start"); }
+    pos = std::min<Sint64>(pos, asset->size);
+    if (!asset->stream->Seek(asset->start + pos, AGS::Common::kSeekBegin)) { return SDL_SetError("Asset seek failed"); }
+    return pos;
+}
+
+static size_t SDLCALL asset_rw_read(SDL_RWops *rw, void *ptr, size_t size, size_t maxnum)
+{
+    auto asset = static_cast<AudioAssetStream*>(rw->hidden.unknown.data1);
+    if (size == 0) { return 0; }
+    const soff_t remains = asset->start + asset->size - asset->stream->GetPosition();
+    if (remains <= 0) { return 0; }
+    const size_t num = std::min<size_t>(maxnum, remains / size);
+    return asset->stream->Read(ptr, num * size) / size;
+}
+
+static size_t SDLCALL asset_rw_write(SDL_RWops *rw, const void *ptr, size_t size, size_t num)
+{
+    SDL_SetError("Audio assets are read-only");
+    return 0;
+}
+
+static int SDLCALL asset_rw_close(SDL_RWops *rw)
+{
+    // the stream itself belongs to the decoder, which may reopen the sample
+    SDL_FreeRW(rw);
+    return 0;
+}
+
+// Creates SDL_RWops reading from the beginning of the asset
+static SDL_RWops *asset_rw_open(AudioAssetStream &asset)
+{
+    if (!asset.stream->Seek(asset.start, AGS::Common::kSeekBegin)) { return nullptr; }
+    auto rw = SDL_AllocRW();
+    if (!rw) { return nullptr; }
+    rw->size = asset_rw_size;
+    rw->seek = asset_rw_seek;
+    rw->read = asset_rw_read;
+    rw->write = asset_rw_write;
+    rw->close = asset_rw_close;
+    rw->type = SDL_RWOPS_UNKNOWN;
+    rw->hidden.unknown.data1 = &asset;
+    return rw;
+}
+
+// Creates sample which decodes the asset, reading it from the stream as necessary
+static SoundSampleUniquePtr asset_sample_open(AudioAssetStream &asset, const AGS::Common::String &ext, Sound_AudioInfo *desired, Uint32 bufferSize)
+{
+    auto rw = asset_rw_open(asset);
+    if (!rw) { return nullptr; }
+    auto sample = Sound_NewSample(rw, ext.GetCStr(), desired, bufferSize);
+    // SDL_sound owns the rwops now, and closes it along with the sample
+    return SoundSampleUniquePtr(sample);
+}
+
+// Opens the asset stream; this only opens the file, and does not read any data
+static AudioAssetStreamPtr audio_core_asset_open(const AssetPath &asset_path)
 {
     auto &asset_lib = asset_path.first;
     auto &asset_name = asset_path.second;
 
     WithAssetLibrary w(asset_lib);
-    if (!AGS::Common::AssetManager::DoesAssetExist(asset_name))  { return -1; }
+    if (!AGS::Common::AssetManager::DoesAssetExist(asset_name))  { return nullptr; }
 
     const auto sz = AGS::Common::AssetManager::GetAssetSize(asset_name);
-    if (sz <= 0) { return -1; }
+    if (sz <= 0) { return nullptr; }
 
-    auto extension = GetFileExtension(asset_name);
-
-    std::vector<char> clipData(sz);
     auto s = AGS::Common::AssetManager::OpenAsset(asset_name, AGS::Common::kFile_Open, AGS::Common::kFile_Read);
-    if (!s) { return -1; }
-    s->Read(clipData.data(), sz);
-    delete (s);
-    s = nullptr;
+    if (!s) { return nullptr; }
+
+    auto asset = AudioAssetStreamPtr(new AudioAssetStream());
+    asset->stream.reset(s);
+    asset->start = s->GetPosition();
+    asset->size = sz;
+    return asset;
+}
+
+
+// -------------------------------------------------------------------------------------------------
+// AUDIO ASSET INFO
+// -------------------------------------------------------------------------------------------------
+
+float audio_core_asset_length_ms(const AssetPath &asset_path)
+{
+    auto asset = audio_core_asset_open(asset_path);
+    if (!asset) { return -1; }
 
-    auto sample = SoundSampleUniquePtr(Sound_NewSampleFromMem((Uint8 *)clipData.data(), clipData.size(), extension.GetCStr(), nullptr, 32*1024));
+    auto extension = GetFileExtension(asset_path.second);
+
+    auto sample = asset_sample_open(*asset, extension, nullptr, 32*1024);
     if (sample == nullptr) { return -1; }
 
     return Sound_GetDuration(sample.get());
@@ -273,8 +463,13 @@ void audio_core_init()
 void audio_core_shutdown()
 {
     global_.audio_core_thread_running = false;
+    audio_core_wakeup();
     global_.audio_core_thread.join();
 
+    auto stats = audio_core_get_stats();
+    agsdbg::Printf(ags::kDbgMsg_Init, "Audio core: %llu commands, latency avg %.2f ms, max %.2f ms; %llu underruns",
+        (unsigned long long)stats.commands, stats.avgCommandLatencyMs, stats.maxCommandLatencyMs, (unsigned long long)stats.underruns);
+
     // SDL_Sound
     Sound_Quit();
 
@@ -302,26 +497,81 @@ static int avail_slot_id()
     return result;
 }
 
-// if none free, add a new one.
-int audio_core_slot_initialise(const AssetPath &asset_path, bool repeat)  
+static AudioCoreSlot *find_slot(int slot_handle)
 {
-    auto &asset_lib = asset_path.first;
-    auto &asset_name = asset_path.second;
+    std::lock_guard<std::mutex> lk(global_.slots_mutex_);
+    auto it = global_.slots_.find(slot_handle);
+    return it != global_.slots_.end() ? it->second.get() : nullptr;
+}
 
-    WithAssetLibrary w(asset_lib);
-    if (!AGS::Common::AssetManager::DoesAssetExist(asset_name))  { return -1; }
+static void audio_core_wakeup()
+{
+    {
+        std::lock_guard<std::mutex> lk(global_.mixer_mutex_m);
+        global_.mixer_wakeup = true;
+    }
+    global_.mixer_cv.notify_all();
+}
 
-    const auto sz = AGS::Common::AssetManager::GetAssetSize(asset_name);
-    if (sz <= 0) { return -1; }
+// Records the state which the slot will have after the command is applied;
+// follows the state changes done by the decoder
+static void audio_core_slot_expect(AudioCoreSlot &slot, AudioCoreSlotCommandType type, float seekPosMs)
+{
+    auto state = slot.hasPendingState_ ? slot.pendingState_ : slot.decoder_.GetPlayState();
+    switch (type) {
+        case AudioCoreSlotCommandType::Play:
+            if (state == PlayStateStopped) {
+                slot.hasPendingPos_ = true;
+                slot.pendingPosMs_ = 0.0f;
+            }
+            if (state == PlayStateStopped || state == PlayStatePaused) { state = PlayStatePlaying; }
+            break;
+        case AudioCoreSlotCommandType::Pause:
+            if (state == PlayStatePlaying) { state = PlayStatePaused; }
+            break;
+        case AudioCoreSlotCommandType::Stop:
+            if (state == PlayStatePlaying) { state = PlayStateStopped; }
+            break;
+        case AudioCoreSlotCommandType::Seek:
+            if (state != PlayStateError) {
+                slot.hasPendingPos_ = true;
+                slot.pendingPosMs_ = seekPosMs;
+            }
+            break;
+        default:
+            break;
+    }
+    slot.hasPendingState_ = true;
+    slot.pendingState_ = state;
+    slot.pendingCommands_++;
+}
 
-    auto extension = GetFileExtension(asset_name);
+// Passes command to the audio thread, without waiting for it
+static void audio_core_push_command(int slot_handle, AudioCoreSlotCommandType type, float seekPosMs = -1.0f)
+{
+    auto slot = find_slot(slot_handle);
+    if (slot) {
+        std::lock_guard<std::mutex> lk(slot->mutex_);
+        audio_core_slot_expect(*slot, type, seekPosMs);
+    }
 
-    std::vector<char> clipData(sz);
-    auto s = AGS::Common::AssetManager::OpenAsset(asset_name, AGS::Common::kFile_Open, AGS::Common::kFile_Read);
-    if (!s) { return -1; }
-    s->Read(clipData.data(), sz);
-    delete (s);
-    s = nullptr;
+    AudioCoreSlotCommand cmd;
+    cmd.handle = slot_handle;
+    cmd.command = type;
+    cmd.seekPosMs = seekPosMs;
+    cmd.issuedAt = AudioCoreClock::now();
+    global_.commands_.Push(std::move(cmd));
+    audio_core_wakeup();
+}
+
+// if none free, add a new one.
+int audio_core_slot_initialise(const AssetPath &asset_path, bool repeat)  
+{
+    // only open the asset here, the data is read and decoded on the audio thread
+    auto asset = audio_core_asset_open(asset_path);
+    if (!asset) { return -1; }
+
+    auto extension = GetFileExtension(asset_path.second);
 
     auto handle = avail_slot_id();
 
@@ -330,14 +580,13 @@ int audio_core_slot_initialise(const AssetPath &asset_path, bool repeat)
     alGenSources(1, &source_);
     dump_al_errors();
 
-    auto promise = std::promise<std::vector<char>>();
-    promise.set_value(std::move(clipData));
+    auto decoder = OpenALDecoder(source_, std::move(asset), extension, repeat);
 
-    auto decoder = OpenALDecoder(source_, promise.get_future(), extension, repeat);
-
-    std::lock_guard<std::mutex> lk(global_.mixer_mutex_m);
-    global_.slots_[handle] = std::make_unique<AudioCoreSlot>(handle, source_, std::move(decoder));
-    global_.mixer_cv.notify_all();
+    {
+        std::lock_guard<std::mutex> lk(global_.slots_mutex_);
+        global_.slots_[handle] = std::make_unique<AudioCoreSlot>(handle, source_, std::move(decoder));
+    }
+    audio_core_push_command(handle, AudioCoreSlotCommandType::Initialise);
 
     return handle;
 }
@@ -355,7 +604,9 @@ void audio_core_set_master_volume(float newvol)
 
 void audio_core_slot_configure(int slot_handle, float volume, float speed, float panning)
 {
-    ALuint source_ = global_.slots_[slot_handle]->source_;
+    auto slot = find_slot(slot_handle);
+    if (!slot) { return; }
+    ALuint source_ = slot->source_;
 
     alSourcef(source_, AL_GAIN, volume*0.7f);
     dump_al_errors();
@@ -384,30 +635,22 @@ void audio_core_slot_configure(int slot_handle, float volume, float speed, float
 
 void audio_core_slot_play(int slot_handle)
 {
-    std::lock_guard<std::mutex> lk(global_.mixer_mutex_m);
-    global_.slots_[slot_handle]->decoder_.Play();
-    global_.mixer_cv.notify_all();
+    audio_core_push_command(slot_handle, AudioCoreSlotCommandType::Play);
 }
 
 void audio_core_slot_pause(int slot_handle)
 {
-    std::lock_guard<std::mutex> lk(global_.mixer_mutex_m);
-    global_.slots_[slot_handle]->decoder_.Pause();
-    global_.mixer_cv.notify_all();
+    audio_core_push_command(slot_handle, AudioCoreSlotCommandType::Pause);
 }
 
 void audio_core_slot_stop(int slot_handle)
 {
-    std::lock_guard<std::mutex> lk(global_.mixer_mutex_m);
-    global_.slots_[slot_handle]->decoder_.Stop();
-    global_.mixer_cv.notify_all();
+    audio_core_push_command(slot_handle, AudioCoreSlotCommandType::Stop);
 }
 
 void audio_core_slot_seek_ms(int slot_handle, float pos_ms)
 {
-    std::lock_guard<std::mutex> lk(global_.mixer_mutex_m);
-    global_.slots_[slot_handle]->decoder_.Seek(pos_ms);
-    global_.mixer_cv.notify_all();
+    audio_core_push_command(slot_handle, AudioCoreSlotCommandType::Seek, pos_ms);
 }
 
 
@@ -418,15 +661,30 @@ void audio_core_slot_seek_ms(int slot_handle, float pos_ms)
 
 float audio_core_slot_get_pos_ms(int slot_handle)
 {
-    std::lock_guard<std::mutex> lk(global_.mixer_mutex_m);
-    return global_.slots_[slot_handle]->decoder_.GetPositionMs();
-    global_.mixer_cv.notify_all();
+    auto slot = find_slot(slot_handle);
+    if (!slot) { return -1.0f; }
+    std::lock_guard<std::mutex> lk(slot->mutex_);
+    if (slot->hasPendingPos_) { return slot->pendingPosMs_; }
+    return slot->decoder_.GetPositionMs();
 }
 AudioCorePlayState audio_core_slot_get_play_state(int slot_handle)
 {
-    std::lock_guard<std::mutex> lk(global_.mixer_mutex_m);
-    return global_.slots_[slot_handle]->decoder_.GetPlayState();
-    global_.mixer_cv.notify_all();
+    auto slot = find_slot(slot_handle);
+    if (!slot) { return PlayStateError; }
+    std::lock_guard<std::mutex> lk(slot->mutex_);
+    if (slot->hasPendingState_) { return slot->pendingState_; }
+    return slot->decoder_.GetPlayState();
+}
+
+AudioCoreStats audio_core_get_stats()
+{
+    AudioCoreStats stats;
+    stats.underruns = global_.underruns;
+    stats.commands = global_.commandCount;
+    stats.avgCommandLatencyMs = stats.commands > 0 ?
+        (float)global_.commandLatencyTotalUs / stats.commands / 1000.0f : 0.0f;
+    stats.maxCommandLatencyMs = (float)global_.commandLatencyMaxUs / 1000.0f;
+    return stats;
 }
 
 
@@ -435,26 +693,75 @@ AudioCorePlayState audio_core_slot_get_play_state(int slot_handle)
 // -------------------------------------------------------------------------------------------------
 
 
-static void audio_core_entry()
+static void audio_core_process_commands()
 {
-    std::unique_lock<std::mutex> lk(global_.mixer_mutex_m);
+    AudioCoreSlotCommand cmd;
+    while (global_.commands_.Pop(cmd)) {
+        auto latencyUs = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(AudioCoreClock::now() - cmd.issuedAt).count();
+        global_.commandCount++;
+        global_.commandLatencyTotalUs += latencyUs;
+        if (latencyUs > global_.commandLatencyMaxUs) { global_.commandLatencyMaxUs = latencyUs; }
+
+        auto slot = find_slot(cmd.handle);
+        if (!slot) { continue; }
+
+        std::lock_guard<std::mutex> lk(slot->mutex_);
+        try {
+            switch (cmd.command) {
+                case AudioCoreSlotCommandType::Initialise:
+                    global_.activeSlots_.push_back(slot);
+                    break;
+                case AudioCoreSlotCommandType::Play:
+                    slot->decoder_.Play();
+                    break;
+                case AudioCoreSlotCommandType::Pause:
+                    slot->decoder_.Pause();
+                    break;
+                case AudioCoreSlotCommandType::Stop:
+                    slot->decoder_.Stop();
+                    break;
+                case AudioCoreSlotCommandType::Seek:
+                    slot->decoder_.Seek(cmd.seekPosMs);
+                    break;
+                default:
+                    break;
+            }
+        } catch (const std::exception& e) {
+            std::cout << "Caught exception \"" << e.what() << "\"\n";
+        }
+        // the decoder tells the real state once all the queued commands are applied
+        if (--slot->pendingCommands_ == 0) {
+            slot->hasPendingState_ = false;
+            slot->hasPendingPos_ = false;
+        }
+    }
+}
 
+static void audio_core_entry()
+{
     while (global_.audio_core_thread_running) {
         
         // burn off any errors for new loop
         dump_al_errors();
 
-        for (auto &entry : global_.slots_) {
-            auto &slot = entry.second;
+        audio_core_process_commands();
 
+        auto waitMs = MaxPollDelayMs;
+        for (auto slot : global_.activeSlots_) {
+            // game thread only waits for this slot, and only if it asks for its state now
+            std::lock_guard<std::mutex> slotLock(slot->mutex_);
             try {
                 slot->decoder_.Poll();
+                waitMs = std::min(waitMs, slot->decoder_.GetNextPollDelayMs());
             } catch (const std::exception& e) {
                 std::cout << "Caught exception \"" << e.what() << "\"\n";
             }
         }
 
-        global_.mixer_cv.wait_for(lk, std::chrono::milliseconds(50));
+        // sleep until a new command, or until a source needs more data
+        std::unique_lock<std::mutex> lk(global_.mixer_mutex_m);
+        global_.mixer_cv.wait_for(lk, std::chrono::microseconds((int64_t)(waitMs * 1000.0f)), [] { return global_.mixer_wakeup; });
+        global_.mixer_wakeup = false;
     }
 }
 
@@ -526,6 +833,7 @@ void OpenALDecoder::DecoderUnqueueProcessedBuffers()
         dump_al_errors();
 
         processedBuffersDurationMs_ += buffer_duration_ms(b);
+        if (!queuedBuffersDurationMs_.empty()) { queuedBuffersDurationMs_.pop_front(); }
 
         global_.freeBuffers_.push_back(b);
     }
@@ -533,8 +841,8 @@ void OpenALDecoder::DecoderUnqueueProcessedBuffers()
 
 
 
-OpenALDecoder::OpenALDecoder(ALuint source, std::future<std::vector<char>> sampleBufFuture, AGS::Common::String sampleExt, bool repeat)
-    : source_(source), sampleBufFuture_(std::move(sampleBufFuture)), sampleExt_(sampleExt), repeat_(repeat) {
+OpenALDecoder::OpenALDecoder(ALuint source, AudioAssetStreamPtr asset, AGS::Common::String sampleExt, bool repeat)
+    : source_(source), asset_(std::move(asset)), sampleExt_(sampleExt), repeat_(repeat) {
 
 }
 
@@ -544,11 +852,8 @@ void OpenALDecoder::Poll()
 
     if (playState_ == AudioCorePlayState::PlayStateInitial) {
 
-        if (sampleBufFuture_.wait_for(std::chrono::seconds(0)) != std::future_status::ready) { return; }
-
-        sampleData_ = std::move(sampleBufFuture_.get());
-
-        auto sample = SoundSampleUniquePtr(Sound_NewSampleFromMem((uint8_t *)sampleData_.data(), sampleData_.size(), sampleExt_.GetCStr(), nullptr, SampleDefaultBufferSize));
+        // the asset is decoded while streaming, so only the sample buffer is kept in memory
+        auto sample = asset_sample_open(*asset_, sampleExt_, nullptr, SampleDefaultBufferSize);
         if(!sample) { playState_ = AudioCorePlayState::PlayStateError; return; }
 
         auto bufferFormat = openalFormatFromSample(sample);
@@ -559,8 +864,9 @@ void OpenALDecoder::Poll()
         #endif
             auto desired = Sound_AudioInfo { AUDIO_S16SYS, sample->actual.channels, sample->actual.rate };
 
-            Sound_FreeSample(sample.get());
-            sample = SoundSampleUniquePtr(Sound_NewSampleFromMem((uint8_t *)sampleData_.data(), sampleData_.size(), sampleExt_.GetCStr(), &desired, SampleDefaultBufferSize));
+            // reopen the sample from the asset start
+            sample.reset();
+            sample = asset_sample_open(*asset_, sampleExt_, &desired, SampleDefaultBufferSize);
 
             if(!sample) { playState_ = AudioCorePlayState::PlayStateError; return; }
 
@@ -582,6 +888,17 @@ void OpenALDecoder::Poll()
 
     if (playState_ != PlayStatePlaying) { return; }
 
+    // a source we started which has stopped before the end of stream ran out of data
+    ALint state = AL_INITIAL;
+    alGetSourcei(source_, AL_SOURCE_STATE, &state);
+    dump_al_errors();
+    if (sourceStarted_ && state == AL_STOPPED && !EOS_) {
+        global_.underruns++;
+    #ifdef AUDIO_CORE_DEBUG
+        agsdbg::Printf(ags::kDbgMsg_Init, "OpenALDecoder: buffer underrun");
+    #endif
+    }
+
     // buffer management
     DecoderUnqueueProcessedBuffers();
 
@@ -624,6 +941,7 @@ void OpenALDecoder::Poll()
 
         alSourceQueueBuffers(source_, 1, &b);
         dump_al_errors();
+        queuedBuffersDurationMs_.push_back(buffer_duration_ms(b));
 
         global_.freeBuffers_.erase(it);
     }
@@ -631,13 +949,13 @@ void OpenALDecoder::Poll()
 
     // setup play state
 
-    ALint state = AL_INITIAL;
     alGetSourcei(source_, AL_SOURCE_STATE, &state);
     dump_al_errors();
 
     if (state != AL_PLAYING) {
         alSourcePlay(source_);
         dump_al_errors();
+        sourceStarted_ = true;
     }
 
     // if end of stream and still not playing, we done here.
@@ -682,6 +1000,7 @@ void OpenALDecoder::Pause()
             playState_ = AudioCorePlayState::PlayStatePaused;
             alSourcePause(source_);
             dump_al_errors();
+            sourceStarted_ = false;
             break;
         default:
             break;
@@ -700,6 +1019,7 @@ void OpenALDecoder::Stop()
             playState_ = AudioCorePlayState::PlayStateStopped;
             alSourceStop(source_);
             dump_al_errors();
+            sourceStarted_ = false;
             break;
         default:
             break;
@@ -717,6 +1037,7 @@ void OpenALDecoder::Seek(float pos_ms)
         default:
             alSourceStop(source_);
             dump_al_errors();
+            sourceStarted_ = false;
             DecoderUnqueueProcessedBuffers();
             Sound_Seek(sample_.get(), pos_ms);
             processedBuffersDurationMs_ = pos_ms;
@@ -724,6 +1045,25 @@ void OpenALDecoder::Seek(float pos_ms)
     }
 }
 
+float OpenALDecoder::GetNextPollDelayMs()
+{
+    if (playState_ != PlayStatePlaying) { return MaxPollDelayMs; }
+    if (queuedBuffersDurationMs_.empty()) { return MinPollDelayMs; }
+
+    // processed buffers were just unqueued, so the offset is within the first buffer;
+    // when it's played through, the buffer may be refilled
+    float alSecOffset = 0.0f;
+    alGetSourcef(source_, AL_SEC_OFFSET, &alSecOffset);
+    dump_al_errors();
+    float pitch = 1.0f;
+    alGetSourcef(source_, AL_PITCH, &pitch);
+    dump_al_errors();
+    if (pitch <= 0.0f) { pitch = 1.0f; }
+
+    auto remainsMs = (queuedBuffersDurationMs_.front() - alSecOffset * 1000.0f) / pitch;
+    return std::max(MinPollDelayMs, std::min(remainsMs, MaxPollDelayMs));
+}
+
 AudioCorePlayState OpenALDecoder::GetPlayState()
 {
     return playState_;
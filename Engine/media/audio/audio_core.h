@@ -36,3 +36,13 @@ enum AudioCorePlayState { PlayStateInitial, PlayStatePlaying, PlayStatePaused, P
 
 AudioCorePlayState audio_core_slot_get_play_state(int slot_handle);
 float audio_core_slot_get_pos_ms(int slot_handle);  // ms
+
+// instrumentation
+struct AudioCoreStats
+{
+    uint64_t underruns = 0;   // times a playing source ran out of data before the end
+    uint64_t commands = 0;    // slot commands processed by the audio thread
+    float avgCommandLatencyMs = 0.0f; // time from issuing a command to processing it
+    float maxCommandLatencyMs = 0.0f;
+};
+AudioCoreStats audio_core_get_stats();
@@ -22,6 +22,7 @@
 
 #include "platform/windows/gfx/ali3dd3d.h"
 
+#include <vector>
 #include <allegro.h>
 #include <allegro/platform/aintwin.h>
 #include "ac/timer.h"
@@ -1289,6 +1290,9 @@ void D3DGraphicsDriver::_renderSprite(const D3DDrawListEntry *drawListEntry, con
     {
       throw Ali3DException("IDirect3DDevice9::DrawPrimitive failed");
     }
+    _renderStats.TextureBinds++;
+    _renderStats.DrawCalls++;
+    _renderStats.Sprites++;
 
   }
 }
@@ -1307,6 +1311,7 @@ void D3DGraphicsDriver::_render(bool clearDrawListAfterwards)
     throw Ali3DException("IDirect3DSurface9::GetRenderTarget failed");
   }
   direct3ddevice->ColorFill(pBackBuffer, nullptr, D3DCOLOR_RGBA(0, 0, 0, 255));
+  _renderStats = RenderStats();
 
   if (!_renderSprAtScreenRes) {
     if (direct3ddevice->SetRenderTarget(0, pNativeSurface) != D3D_OK)
@@ -1521,29 +1526,74 @@ void D3DGraphicsDriver::DestroyDDB(IDriverDependantBitmap* bitmap)
     delete bitmap;
 }
 
-void D3DGraphicsDriver::UpdateTextureRegion(D3DTextureTile *tile, Bitmap *bitmap, D3DBitmap *target, bool hasAlpha)
+void D3DGraphicsDriver::UpdateTextureRegion(D3DTextureTile *tile, Bitmap *bitmap, D3DBitmap *target, bool hasAlpha,
+    const Rect &region)
 {
   IDirect3DTexture9* newTexture = tile->texture;
 
+  // Find out which part of the tile has to be converted and uploaded
+  Rect update, convert;
+  GetTileUpdateRects(*tile, region, target->_opaque, update, convert);
+  const bool wholeTile = update.GetWidth() == tile->width && update.GetHeight() == tile->height;
+
   D3DLOCKED_RECT lockedRegion;
-  HRESULT hr = newTexture->LockRect(0, &lockedRegion, NULL, D3DLOCK_NOSYSLOCK | D3DLOCK_DISCARD);
+  RECT lockRect = { update.Left, update.Top, update.Right + 1, update.Bottom + 1 };
+  // The texture contents may only be discarded when it is all rewritten
+  HRESULT hr = wholeTile ?
+    newTexture->LockRect(0, &lockedRegion, NULL, D3DLOCK_NOSYSLOCK | D3DLOCK_DISCARD) :
+    newTexture->LockRect(0, &lockedRegion, &lockRect, D3DLOCK_NOSYSLOCK);
   if (hr != D3D_OK)
   {
     throw Ali3DException("Unable to lock texture");
   }
 
   bool usingLinearFiltering = _filter->NeedToColourEdgeLines();
-  char *memPtr = (char*)lockedRegion.pBits;
+  TextureTile fixedTile;
+  fixedTile.x = tile->x + convert.Left;
+  fixedTile.y = tile->y + convert.Top;
+  fixedTile.width = convert.GetWidth();
+  fixedTile.height = convert.GetHeight();
+
+  char *memPtr;
+  int pitch;
+  std::vector<unsigned int> convertBuf;
+  if (convert.Left == update.Left && convert.Top == update.Top &&
+      convert.Right == update.Right && convert.Bottom == update.Bottom)
+  {
+    // Converted pixels go directly into the locked part of the texture
+    memPtr = (char*)lockedRegion.pBits;
+    pitch = lockedRegion.Pitch;
+  }
+  else
+  {
+    // Converted area is larger than the uploaded one, so use a buffer
+    convertBuf.resize(fixedTile.width * fixedTile.height);
+    memPtr = (char*)convertBuf.data();
+    pitch = fixedTile.width * sizeof(int);
+  }
 
   if (target->_opaque)
-    BitmapToVideoMemOpaque(bitmap, hasAlpha, tile, target, memPtr, lockedRegion.Pitch);
+    BitmapToVideoMemOpaque(bitmap, hasAlpha, &fixedTile, target, memPtr, pitch);
   else
-    BitmapToVideoMem(bitmap, hasAlpha, tile, target, memPtr, lockedRegion.Pitch, usingLinearFiltering);
+    BitmapToVideoMem(bitmap, hasAlpha, &fixedTile, target, memPtr, pitch, usingLinearFiltering);
+
+  if (memPtr != lockedRegion.pBits)
+  {
+    const char *srcPtr = memPtr + pitch * (update.Top - convert.Top) + (update.Left - convert.Left) * sizeof(int);
+    char *dstPtr = (char*)lockedRegion.pBits;
+    for (int y = 0; y < update.GetHeight(); y++, srcPtr += pitch, dstPtr += lockedRegion.Pitch)
+      memcpy(dstPtr, srcPtr, update.GetWidth() * sizeof(int));
+  }
 
   newTexture->UnlockRect(0);
 }
 
 void D3DGraphicsDriver::UpdateDDBFromBitmap(IDriverDependantBitmap* bitmapToUpdate, Bitmap *bitmap, bool hasAlpha)
+{
+  UpdateDDBRegionFromBitmap(bitmapToUpdate, bitmap, hasAlpha, RectWH(0, 0, bitmap->GetWidth(), bitmap->GetHeight()));
+}
+
+void D3DGraphicsDriver::UpdateDDBRegionFromBitmap(IDriverDependantBitmap* bitmapToUpdate, Bitmap *bitmap, bool hasAlpha, const Rect &region)
 {
   D3DBitmap *target = (D3DBitmap*)bitmapToUpdate;
   if (target->_width != bitmap->GetWidth() || target->_height != bitmap->GetHeight())
@@ -1558,7 +1608,11 @@ void D3DGraphicsDriver::UpdateDDBFromBitmap(IDriverDependantBitmap* bitmapToUpda
 
   for (int i = 0; i < target->_numTiles; i++)
   {
-    UpdateTextureRegion(&target->_tiles[i], bitmap, target, hasAlpha);
+    // only upload the tiles which intersect the changed region
+    const TextureTile &tile = target->_tiles[i];
+    if (!AreRectsIntersecting(RectWH(tile.x, tile.y, tile.width, tile.height), region))
+      continue;
+    UpdateTextureRegion(&target->_tiles[i], bitmap, target, hasAlpha, region);
   }
 
   if (color_depth == 8)
@@ -13,6 +13,8 @@
 //=============================================================================
 
 #include <string.h>
+#include <algorithm>
+#include <vector>
 #include "ac/common.h"
 #include "ac/dynobj/cc_dynamicarray.h"
 #include "ac/dynobj/managedobjectpool.h"
@@ -23,6 +25,7 @@
 #include "debug/out.h"
 #include "script/cc_options.h"
 #include "script/script.h"
+#include "script/script_profiler.h"
 #include "script/script_runtime.h"
 #include "script/systemimports.h"
 #include "util/bbop.h"
@@ -39,6 +42,7 @@
 
 using namespace AGS::Common;
 using namespace AGS::Common::Memory;
+using namespace AGS::Engine;
 
 extern ccInstance *loadedInstances[MAX_LOADED_INSTANCES]; // in script/script_runtime
 extern int gameHasBeenRestored; // in ac/game
@@ -155,6 +159,64 @@ const ScriptCommandInfo sccmd_info[CC_NUM_SCCMDS] =
     ScriptCommandInfo( SCMD_NEWUSEROBJECT   , "newuserobject"     , 2, kScOpOneArgIsReg ),
 };
 
+// Superinstructions: engine-only operation codes, which are never found in
+// the compiled scripts, but made when linking the script by fusing common
+// sequences of operations. Their ArgCount is the total number of code
+// elements following the first instruction.
+#define SCMD_SUPER_LOADSPOFFS_MEMREAD   (CC_NUM_SCCMDS + 0) // MAR = SP - arg1; reg2 = m[MAR]
+#define SCMD_SUPER_LITTOREG_PUSHREG     (CC_NUM_SCCMDS + 1) // reg1 = arg2; m[sp] = reg3; sp++
+#define CC_NUM_EXT_SCCMDS               (CC_NUM_SCCMDS + 2)
+
+// Threaded dispatch jumps straight to the instruction handlers by their
+// addresses, which requires "labels as values" extension (GCC and Clang)
+#if defined(AGS_SCRIPT_THREADED_DISPATCH) && (defined(__GNUC__) || defined(__clang__))
+#define AGS_SCRIPT_HAS_THREADED_DISPATCH 1
+#define SCMD_CASE(cmd) case cmd: op_##cmd
+#define SCMD_DEFAULT   default: op_default
+#else
+#define AGS_SCRIPT_HAS_THREADED_DISPATCH 0
+#define SCMD_CASE(cmd) case cmd
+#define SCMD_DEFAULT   default
+#endif
+
+// Gets the operation at the current program counter, either pre-decoded
+// or decoded right now; debug dump always decodes, as it has to see the
+// unfused instructions
+#define FETCH_OPERATION \
+    { \
+        const int32_t op_index = (!write_debug_dump && (uint32_t)pc < (uint32_t)codeInst->codesize) ? \
+            codeInst->code_op_index[pc] : -1; \
+        if (op_index < 0 && !codeInst->ReadOperation(tempOp, pc, this)) \
+            return -1; \
+        cur_op = op_index >= 0 ? &codeInst->code_ops[op_index] : &tempOp; \
+        const int32_t reg1_index = cur_op->Args[0].IValue; \
+        const int32_t reg2_index = cur_op->Args[1].IValue; \
+        cur_reg1 = &registers[reg1_index >= 0 && reg1_index < CC_NUM_REGISTERS ? reg1_index : 0]; \
+        cur_reg2 = &registers[reg2_index >= 0 && reg2_index < CC_NUM_REGISTERS ? reg2_index : 0]; \
+        if (write_debug_dump) \
+            DumpInstruction(*cur_op); \
+        if (profile) \
+            ScriptProfiler::CountInstruction(cur_op->Instruction.Code); \
+    }
+
+// Ends the instruction handler; with the threaded dispatch every handler
+// fetches the next operation and jumps to its handler on its own, which
+// gives the CPU a separate branch prediction slot for each instruction
+#if AGS_SCRIPT_HAS_THREADED_DISPATCH
+#define NEXT \
+    if (threaded_dispatch) \
+    { \
+        if (flags & INSTF_ABORTED) \
+            return 0; \
+        pc += cur_op->ArgCount + 1; \
+        FETCH_OPERATION; \
+        goto *dispatch_table[cur_op->Instruction.Code]; \
+    } \
+    break
+#else
+#define NEXT break
+#endif
+
 const char *regnames[] = { "null", "sp", "mar", "ax", "bx", "cx", "op", "dx" };
 
 const char *fixupnames[] = { "null", "fix_gldata", "fix_func", "fix_string", "fix_import", "fix_datadata", "fix_stack" };
@@ -240,6 +302,8 @@ ccInstance::ccInstance()
     numimports = 0;
     resolved_imports = nullptr;
     code_fixups         = nullptr;
+    code_ops            = nullptr;
+    code_op_index       = nullptr;
 
     memset(callStackLineNumber, 0, sizeof(callStackLineNumber));
     memset(callStackAddr, 0, sizeof(callStackAddr));
@@ -440,127 +504,81 @@ int ccInstance::Run(int32_t curpc)
     current_instance = this;
     ccInstance *codeInst = runningInst;
     int write_debug_dump = ccGetOption(SCOPT_DEBUGRUN);
-	ScriptOperation codeOp;
+    ScriptOperation tempOp; // for the operations not decoded beforehand
+    // Profiler is told about every function call and return; the guard
+    // takes care of the functions left when script is interrupted
+    const bool profile = ScriptProfiler::IsEnabled();
+    ScriptProfiler::StackGuard profile_guard(profile);
+    if (profile)
+        ScriptProfiler::EnterFunction(codeInst, pc);
+
+#if AGS_SCRIPT_HAS_THREADED_DISPATCH
+    // Instruction handlers, in the order of instruction codes
+    static const void *const dispatch_table[] =
+    {
+        &&op_default,
+        &&op_SCMD_ADD, &&op_SCMD_SUB, &&op_SCMD_REGTOREG, &&op_SCMD_WRITELIT,
+        &&op_SCMD_RET, &&op_SCMD_LITTOREG, &&op_SCMD_MEMREAD, &&op_SCMD_MEMWRITE,
+        &&op_SCMD_MULREG, &&op_SCMD_DIVREG, &&op_SCMD_ADDREG, &&op_SCMD_SUBREG,
+        &&op_SCMD_BITAND, &&op_SCMD_BITOR, &&op_SCMD_ISEQUAL, &&op_SCMD_NOTEQUAL,
+        &&op_SCMD_GREATER, &&op_SCMD_LESSTHAN, &&op_SCMD_GTE, &&op_SCMD_LTE,
+        &&op_SCMD_AND, &&op_SCMD_OR, &&op_SCMD_CALL, &&op_SCMD_MEMREADB,
+        &&op_SCMD_MEMREADW, &&op_SCMD_MEMWRITEB, &&op_SCMD_MEMWRITEW, &&op_SCMD_JZ,
+        &&op_SCMD_PUSHREG, &&op_SCMD_POPREG, &&op_SCMD_JMP, &&op_SCMD_MUL,
+        &&op_SCMD_CALLEXT, &&op_SCMD_PUSHREAL, &&op_SCMD_SUBREALSTACK, &&op_SCMD_LINENUM,
+        &&op_SCMD_CALLAS, &&op_SCMD_THISBASE, &&op_SCMD_NUMFUNCARGS, &&op_SCMD_MODREG,
+        &&op_SCMD_XORREG, &&op_SCMD_NOTREG, &&op_SCMD_SHIFTLEFT, &&op_SCMD_SHIFTRIGHT,
+        &&op_SCMD_CALLOBJ, &&op_SCMD_CHECKBOUNDS, &&op_SCMD_MEMWRITEPTR, &&op_SCMD_MEMREADPTR,
+        &&op_SCMD_MEMZEROPTR, &&op_SCMD_MEMINITPTR, &&op_SCMD_LOADSPOFFS, &&op_SCMD_CHECKNULL,
+        &&op_SCMD_FADD, &&op_SCMD_FSUB, &&op_SCMD_FMULREG, &&op_SCMD_FDIVREG,
+        &&op_SCMD_FADDREG, &&op_SCMD_FSUBREG, &&op_SCMD_FGREATER, &&op_SCMD_FLESSTHAN,
+        &&op_SCMD_FGTE, &&op_SCMD_FLTE, &&op_SCMD_ZEROMEMORY, &&op_SCMD_CREATESTRING,
+        &&op_SCMD_STRINGSEQUAL, &&op_SCMD_STRINGSNOTEQ, &&op_SCMD_CHECKNULLREG, &&op_SCMD_LOOPCHECKOFF,
+        &&op_SCMD_MEMZEROPTRND, &&op_SCMD_JNZ, &&op_SCMD_DYNAMICBOUNDS, &&op_SCMD_NEWARRAY,
+        &&op_SCMD_NEWUSEROBJECT,
+        &&op_SCMD_SUPER_LOADSPOFFS_MEMREAD, &&op_SCMD_SUPER_LITTOREG_PUSHREG,
+    };
+    static_assert(sizeof(dispatch_table) / sizeof(dispatch_table[0]) == CC_NUM_EXT_SCCMDS,
+        "dispatch table does not match the instruction set");
+    const bool threaded_dispatch = ccGetOption(SCOPT_SWITCHDISPATCH) == 0;
+#endif
 
     FunctionCallStack func_callstack;
 
-    while (1) {
+    // The running operation and the registers which its arguments refer to;
+    // these are pointers, because with the threaded dispatch the handlers
+    // move on to the next operation without returning to the loop start
+    const ScriptOperation *cur_op = nullptr;
+    RuntimeScriptValue *cur_reg1 = nullptr;
+    RuntimeScriptValue *cur_reg2 = nullptr;
+    const char *direct_ptr1;
+    const char *direct_ptr2;
+    // quick access to the arguments and registers
+#define codeOp (*cur_op)
+#define arg1   (cur_op->Args[0])
+#define arg2   (cur_op->Args[1])
+#define arg3   (cur_op->Args[2])
+#define reg1   (*cur_reg1)
+#define reg2   (*cur_reg2)
 
-        /*
-		if (!codeInst->ReadOperation(codeOp, pc))
-        {
-            return -1;
-        }
-        */
-        /* ReadOperation */
-        //=====================================================================
-        codeOp.Instruction.Code			= codeInst->code[pc];
-        codeOp.Instruction.InstanceId	= (codeOp.Instruction.Code >> INSTANCE_ID_SHIFT) & INSTANCE_ID_MASK;
-        codeOp.Instruction.Code		   &= INSTANCE_ID_REMOVEMASK; // now this is pure instruction code
+    while (1) {
 
-        if (codeOp.Instruction.Code < 0 || codeOp.Instruction.Code >= CC_NUM_SCCMDS)
-        {
-            cc_error("invalid instruction %d found in code stream", codeOp.Instruction.Code);
-            return -1;
-        }
+        FETCH_OPERATION;
 
-        codeOp.ArgCount = sccmd_info[codeOp.Instruction.Code].ArgCount;
-        if (pc + codeOp.ArgCount >= codeInst->codesize)
-        {
-            cc_error("unexpected end of code data (%d; %d)", pc + codeOp.ArgCount, codeInst->codesize);
-            return -1;
-        }
-
-        int pc_at = pc + 1;
-        for (int i = 0; i < codeOp.ArgCount; ++i, ++pc_at)
-        {
-            char fixup = codeInst->code_fixups[pc_at];
-            if (fixup > 0)
-            {
-                // could be relative pointer or import address
-                /*
-                if (!FixupArgument(code[pc], fixup, codeOp.Args[i]))
-                {
-                    return -1;
-                }
-                */
-                /* FixupArgument */
-                //=====================================================================
-                switch (fixup)
-                {
-                case FIXUP_GLOBALDATA:
-                    {
-                        ScriptVariable *gl_var = (ScriptVariable*)codeInst->code[pc_at];
-                        codeOp.Args[i].SetGlobalVar(&gl_var->RValue);
-                    }
-                    break;
-                case FIXUP_FUNCTION:
-                    // originally commented -- CHECKME: could this be used in very old versions of AGS?
-                    //      code[fixup] += (long)&code[0];
-                    // This is a program counter value, presumably will be used as SCMD_CALL argument
-                    codeOp.Args[i].SetInt32((int32_t)codeInst->code[pc_at]);
-                    break;
-                case FIXUP_STRING:
-                    codeOp.Args[i].SetStringLiteral(&codeInst->strings[0] + codeInst->code[pc_at]);
-                    break;
-                case FIXUP_IMPORT:
-                    {
-                        const ScriptImport *import = simp.getByIndex((int32_t)codeInst->code[pc_at]);
-                        if (import)
-                        {
-                            codeOp.Args[i] = import->Value;
-                        }
-                        else
-                        {
-                            cc_error("cannot resolve import, key = %ld", codeInst->code[pc_at]);
-                            return -1;
-                        }
-                    }
-                    break;
-                case FIXUP_STACK:
-                    codeOp.Args[i] = GetStackPtrOffsetFw((int32_t)codeInst->code[pc_at]);
-                    break;
-                default:
-                    cc_error("internal fixup type error: %d", fixup);
-                    return -1;
-                }
-                /* End FixupArgument */
-                //=====================================================================
-            }
-            else
-            {
-                // should be a numeric literal (int32 or float)
-                codeOp.Args[i].SetInt32( (int32_t)codeInst->code[pc_at] );
-            }
-        }
-        /* End ReadOperation */
-        //=====================================================================
-
-        // save the arguments for quick access
-        RuntimeScriptValue &arg1 = codeOp.Args[0];
-        RuntimeScriptValue &arg2 = codeOp.Args[1];
-        RuntimeScriptValue &arg3 = codeOp.Args[2];
-        RuntimeScriptValue &reg1 = 
-            registers[arg1.IValue >= 0 && arg1.IValue < CC_NUM_REGISTERS ? arg1.IValue : 0];
-        RuntimeScriptValue &reg2 = 
-            registers[arg2.IValue >= 0 && arg2.IValue < CC_NUM_REGISTERS ? arg2.IValue : 0];
-
-        const char *direct_ptr1;
-        const char *direct_ptr2;
-
-        if (write_debug_dump)
-        {
-            DumpInstruction(codeOp);
-        }
+#if AGS_SCRIPT_HAS_THREADED_DISPATCH
+        // the instruction code was validated when the operation was decoded
+        if (threaded_dispatch)
+            goto *dispatch_table[codeOp.Instruction.Code];
+#endif
 
         switch (codeOp.Instruction.Code) {
-      case SCMD_LINENUM:
+      SCMD_CASE(SCMD_LINENUM):
           line_number = arg1.IValue;
           currentline = arg1.IValue;
           if (new_line_hook)
               new_line_hook(this, currentline);
-          break;
-      case SCMD_ADD:
+          NEXT;
+      SCMD_CASE(SCMD_ADD):
           // If the the register is SREG_SP, we are allocating new variable on the stack
           if (arg1.IValue == SREG_SP)
           {
@@ -585,8 +603,8 @@ int ccInstance::Run(int32_t curpc)
           {
             reg1.IValue += arg2.IValue;
           }
-          break;
-      case SCMD_SUB:
+          NEXT;
+      SCMD_CASE(SCMD_SUB):
           if (reg1.Type == kScValStackPtr)
           {
             // If this is SREG_SP, this is stack pop, which frees local variables;
@@ -612,11 +630,11 @@ int ccInstance::Run(int32_t curpc)
           {
             reg1.IValue -= arg2.IValue;
           }
-          break;
-      case SCMD_REGTOREG:
+          NEXT;
+      SCMD_CASE(SCMD_REGTOREG):
           reg2 = reg1;
-          break;
-      case SCMD_WRITELIT:
+          NEXT;
+      SCMD_CASE(SCMD_WRITELIT):
           // Take the data address from reg[MAR] and copy there arg1 bytes from arg2 address
           //
           // NOTE: since it reads directly from arg2 (which originally was
@@ -639,8 +657,8 @@ int ccInstance::Run(int32_t curpc)
               cc_error("unexpected data size for WRITELIT op: %d", arg1.IValue);
               break;
           }
-          break;
-      case SCMD_RET:
+          NEXT;
+      SCMD_CASE(SCMD_RET):
           {
           if (loopIterationCheckDisabled > 0)
               loopIterationCheckDisabled--;
@@ -656,90 +674,92 @@ int ccInstance::Run(int32_t curpc)
           }
           current_instance = this;
           POP_CALL_STACK;
+          if (profile)
+              ScriptProfiler::LeaveFunction();
           continue; // continue so that the PC doesn't get overwritten
           }
-      case SCMD_LITTOREG:
+      SCMD_CASE(SCMD_LITTOREG):
           reg1 = arg2;
-          break;
-      case SCMD_MEMREAD:
+          NEXT;
+      SCMD_CASE(SCMD_MEMREAD):
           // Take the data address from reg[MAR] and copy int32_t to reg[arg1]
           reg1 = registers[SREG_MAR].ReadValue();
-          break;
-      case SCMD_MEMWRITE:
+          NEXT;
+      SCMD_CASE(SCMD_MEMWRITE):
           // Take the data address from reg[MAR] and copy there int32_t from reg[arg1]
           registers[SREG_MAR].WriteValue(reg1);
-          break;
-      case SCMD_LOADSPOFFS:
+          NEXT;
+      SCMD_CASE(SCMD_LOADSPOFFS):
           registers[SREG_MAR] = GetStackPtrOffsetRw(arg1.IValue);
           if (ccError)
           {
               return -1;
           }
-          break;
+          NEXT;
 
           // 64 bit: Force 32 bit math
-      case SCMD_MULREG:
+      SCMD_CASE(SCMD_MULREG):
           reg1.SetInt32(reg1.IValue * reg2.IValue);
-          break;
-      case SCMD_DIVREG:
+          NEXT;
+      SCMD_CASE(SCMD_DIVREG):
           if (reg2.IValue == 0) {
               cc_error("!Integer divide by zero");
               return -1;
           } 
           reg1.SetInt32(reg1.IValue / reg2.IValue);
-          break;
-      case SCMD_ADDREG:
+          NEXT;
+      SCMD_CASE(SCMD_ADDREG):
           // This may be pointer arithmetics, in which case IValue stores offset from base pointer
           reg1.IValue += reg2.IValue;
-          break;
-      case SCMD_SUBREG:
+          NEXT;
+      SCMD_CASE(SCMD_SUBREG):
           // This may be pointer arithmetics, in which case IValue stores offset from base pointer
           reg1.IValue -= reg2.IValue;
-          break;
-      case SCMD_BITAND:
+          NEXT;
+      SCMD_CASE(SCMD_BITAND):
           reg1.SetInt32(reg1.IValue & reg2.IValue);
-          break;
-      case SCMD_BITOR:
+          NEXT;
+      SCMD_CASE(SCMD_BITOR):
           reg1.SetInt32(reg1.IValue | reg2.IValue);
-          break;
-      case SCMD_ISEQUAL:
+          NEXT;
+      SCMD_CASE(SCMD_ISEQUAL):
           reg1.SetInt32AsBool(reg1 == reg2);
-          break;
-      case SCMD_NOTEQUAL:
+          NEXT;
+      SCMD_CASE(SCMD_NOTEQUAL):
           reg1.SetInt32AsBool(reg1 != reg2);
-          break;
-      case SCMD_GREATER:
+          NEXT;
+      SCMD_CASE(SCMD_GREATER):
           reg1.SetInt32AsBool(reg1.IValue > reg2.IValue);
-          break;
-      case SCMD_LESSTHAN:
+          NEXT;
+      SCMD_CASE(SCMD_LESSTHAN):
           reg1.SetInt32AsBool(reg1.IValue < reg2.IValue);
-          break;
-      case SCMD_GTE:
+          NEXT;
+      SCMD_CASE(SCMD_GTE):
           reg1.SetInt32AsBool(reg1.IValue >= reg2.IValue);
-          break;
-      case SCMD_LTE:
+          NEXT;
+      SCMD_CASE(SCMD_LTE):
           reg1.SetInt32AsBool(reg1.IValue <= reg2.IValue);
-          break;
-      case SCMD_AND:
+          NEXT;
+      SCMD_CASE(SCMD_AND):
           reg1.SetInt32AsBool(reg1.IValue && reg2.IValue);
-          break;
-      case SCMD_OR:
+          NEXT;
+      SCMD_CASE(SCMD_OR):
           reg1.SetInt32AsBool(reg1.IValue || reg2.IValue);
-          break;
-      case SCMD_XORREG:
+          NEXT;
+      SCMD_CASE(SCMD_XORREG):
           reg1.SetInt32(reg1.IValue ^ reg2.IValue);
-          break;
-      case SCMD_MODREG:
+          NEXT;
+      SCMD_CASE(SCMD_MODREG):
           if (reg2.IValue == 0) {
               cc_error("!Integer divide by zero");
               return -1;
           } 
           reg1.SetInt32(reg1.IValue % reg2.IValue);
-          break;
-      case SCMD_NOTREG:
+          NEXT;
+      SCMD_CASE(SCMD_NOTREG):
           reg1 = !(reg1);
-          break;
-      case SCMD_CALL:
+          NEXT;
+      SCMD_CASE(SCMD_CALL):
           // CallScriptFunction another function within same script, just save PC
           // and continue from there
           if (curnest >= MAXNEST - 1) {
@@ -771,32 +791,34 @@ int ccInstance::Run(int32_t curpc)
           curnest++;
           thisbase[curnest] = 0;
           funcstart[curnest] = pc;
+          if (profile)
+              ScriptProfiler::EnterFunction(codeInst, pc);
           continue; // continue so that the PC doesn't get overwritten
-      case SCMD_MEMREADB:
+      SCMD_CASE(SCMD_MEMREADB):
           // Take the data address from reg[MAR] and copy byte to reg[arg1]
           reg1.SetUInt8(registers[SREG_MAR].ReadByte());
-          break;
-      case SCMD_MEMREADW:
+          NEXT;
+      SCMD_CASE(SCMD_MEMREADW):
           // Take the data address from reg[MAR] and copy int16_t to reg[arg1]
           reg1.SetInt16(registers[SREG_MAR].ReadInt16());
-          break;
-      case SCMD_MEMWRITEB:
+          NEXT;
+      SCMD_CASE(SCMD_MEMWRITEB):
           // Take the data address from reg[MAR] and copy there byte from reg[arg1]
           registers[SREG_MAR].WriteByte(reg1.IValue);
-          break;
-      case SCMD_MEMWRITEW:
+          NEXT;
+      SCMD_CASE(SCMD_MEMWRITEW):
           // Take the data address from reg[MAR] and copy there int16_t from reg[arg1]
           registers[SREG_MAR].WriteInt16(reg1.IValue);
-          break;
-      case SCMD_JZ:
+          NEXT;
+      SCMD_CASE(SCMD_JZ):
           if (registers[SREG_AX].IsNull())
               pc += arg1.IValue;
-          break;
-      case SCMD_JNZ:
+          NEXT;
+      SCMD_CASE(SCMD_JNZ):
           if (!registers[SREG_AX].IsNull())
               pc += arg1.IValue;
-          break;
-      case SCMD_PUSHREG:
+          NEXT;
+      SCMD_CASE(SCMD_PUSHREG):
           // Push reg[arg1] value to the stack
           ASSERT_STACK_SPACE_AVAILABLE(1);
           PushValueToStack(reg1);
@@ -804,12 +826,12 @@ int ccInstance::Run(int32_t curpc)
           {
               return -1;
           }
-          break;
-      case SCMD_POPREG:
+          NEXT;
+      SCMD_CASE(SCMD_POPREG):
           ASSERT_STACK_SIZE(1);
           reg1 = PopValueFromStack();
-          break;
-      case SCMD_JMP:
+          NEXT;
+      SCMD_CASE(SCMD_JMP):
           pc += arg1.IValue;
 
           if ((arg1.IValue < 0) && (maxWhileLoops > 0) && (loopIterationCheckDisabled == 0)) {
@@ -824,18 +846,18 @@ int ccInstance::Run(int32_t curpc)
                   return -1;
               }
           }
-          break;
-      case SCMD_MUL:
+          NEXT;
+      SCMD_CASE(SCMD_MUL):
           reg1.IValue *= arg2.IValue;
-          break;
-      case SCMD_CHECKBOUNDS:
+          NEXT;
+      SCMD_CASE(SCMD_CHECKBOUNDS):
           if ((reg1.IValue < 0) ||
               (reg1.IValue >= arg2.IValue)) {
                   cc_error("!Array index out of bounds (index: %d, bounds: 0..%d)", reg1.IValue, arg2.IValue - 1);
                   return -1;
           }
-          break;
-      case SCMD_DYNAMICBOUNDS:
+          NEXT;
+      SCMD_CASE(SCMD_DYNAMICBOUNDS):
           {
               // TODO: test reg[MAR] type here;
               // That might be dynamic object, but also a non-managed dynamic array, "allocated"
@@ -848,12 +870,12 @@ int ccInstance::Run(int32_t curpc)
                       cc_error("!Array index out of bounds (index: %d, bounds: 0..%d)", reg1.IValue / elementSize, upperBound - 1);
                       return -1;
               }
-              break;
+              NEXT;
           }
 
           // 64 bit: Handles are always 32 bit values. They are not C pointer.
 
-      case SCMD_MEMREADPTR: {
+      SCMD_CASE(SCMD_MEMREADPTR): {
           ccError = 0;
 
           int32_t handle = registers[SREG_MAR].ReadInt32();
@@ -872,8 +894,8 @@ int ccInstance::Run(int32_t curpc)
           // if error occurred, cc_error will have been set
           if (ccError)
               return -1;
-          break; }
-      case SCMD_MEMWRITEPTR: {
+          NEXT; }
+      SCMD_CASE(SCMD_MEMWRITEPTR): {
 
           int32_t handle = registers[SREG_MAR].ReadInt32();
           char *address = nullptr;
@@ -907,9 +929,9 @@ int ccInstance::Run(int32_t curpc)
               ccAddObjectReference(newHandle);
               registers[SREG_MAR].WriteInt32(newHandle);
           }
-          break;
+          NEXT;
                              }
-      case SCMD_MEMINITPTR: { 
+      SCMD_CASE(SCMD_MEMINITPTR): { 
           char *address = nullptr;
 
           if (reg1.Type == kScValStaticArray && reg1.StcArr->GetDynamicManager())
@@ -938,15 +960,15 @@ int ccInstance::Run(int32_t curpc)
 
           ccAddObjectReference(newHandle);
           registers[SREG_MAR].WriteInt32(newHandle);
-          break;
+          NEXT;
                             }
-      case SCMD_MEMZEROPTR: {
+      SCMD_CASE(SCMD_MEMZEROPTR): {
           int32_t handle = registers[SREG_MAR].ReadInt32();
           ccReleaseObjectReference(handle);
           registers[SREG_MAR].WriteInt32(0);
-          break;
+          NEXT;
                             }
-      case SCMD_MEMZEROPTRND: {
+      SCMD_CASE(SCMD_MEMZEROPTRND): {
           int32_t handle = registers[SREG_MAR].ReadInt32();
 
           // don't do the Dispose check for the object being returned -- this is
@@ -958,24 +980,24 @@ int ccInstance::Run(int32_t curpc)
           ccReleaseObjectReference(handle);
           pool.disableDisposeForObject = nullptr;
           registers[SREG_MAR].WriteInt32(0);
-          break;
+          NEXT;
                               }
-      case SCMD_CHECKNULL:
+      SCMD_CASE(SCMD_CHECKNULL):
           if (registers[SREG_MAR].IsNull()) {
               cc_error("!Null pointer referenced");
               return -1;
           }
-          break;
-      case SCMD_CHECKNULLREG:
+          NEXT;
+      SCMD_CASE(SCMD_CHECKNULLREG):
           if (reg1.IsNull()) {
               cc_error("!Null string referenced");
               return -1;
           }
-          break;
-      case SCMD_NUMFUNCARGS:
+          NEXT;
+      SCMD_CASE(SCMD_NUMFUNCARGS):
           num_args_to_func = arg1.IValue;
-          break;
-      case SCMD_CALLAS:{
+          NEXT;
+      SCMD_CASE(SCMD_CALLAS):{
           PUSH_CALL_STACK;
 
           // CallScriptFunction to a function in another script
@@ -1035,9 +1057,9 @@ int ccInstance::Run(int32_t curpc)
           was_just_callas = func_callstack.Count;
           num_args_to_func = -1;
           POP_CALL_STACK;
-          break;
+          NEXT;
                        }
-      case SCMD_CALLEXT: {
+      SCMD_CASE(SCMD_CALLEXT): {
           // CallScriptFunction to a real 'C' code function
           was_just_callas = -1;
           if (num_args_to_func < 0)
@@ -1114,12 +1136,12 @@ int ccInstance::Run(int32_t curpc)
           current_instance = this;
           next_call_needs_object = 0;
           num_args_to_func = -1;
-          break;
+          NEXT;
                          }
-      case SCMD_PUSHREAL:
+      SCMD_CASE(SCMD_PUSHREAL):
           PushToFuncCallStack(func_callstack, reg1);
-          break;
-      case SCMD_SUBREALSTACK:
+          NEXT;
+      SCMD_CASE(SCMD_SUBREALSTACK):
           PopFromFuncCallStack(func_callstack, arg1.IValue);
           if (was_just_callas >= 0)
           {
@@ -1127,8 +1149,8 @@ int ccInstance::Run(int32_t curpc)
               PopValuesFromStack(arg1.IValue);
               was_just_callas = -1;
           }
-          break;
-      case SCMD_CALLOBJ:
+          NEXT;
+      SCMD_CASE(SCMD_CALLOBJ):
           // set the OP register
           if (reg1.IsNull()) {
               cc_error("!Null pointer referenced");
@@ -1162,17 +1184,17 @@ int ccInstance::Run(int32_t curpc)
               return -1;
           }
           next_call_needs_object = 1;
-          break;
-      case SCMD_SHIFTLEFT:
+          NEXT;
+      SCMD_CASE(SCMD_SHIFTLEFT):
           reg1.SetInt32(reg1.IValue << reg2.IValue);
-          break;
-      case SCMD_SHIFTRIGHT:
+          NEXT;
+      SCMD_CASE(SCMD_SHIFTRIGHT):
           reg1.SetInt32(reg1.IValue >> reg2.IValue);
-          break;
-      case SCMD_THISBASE:
+          NEXT;
+      SCMD_CASE(SCMD_THISBASE):
           thisbase[curnest] = arg1.IValue;
-          break;
-      case SCMD_NEWARRAY:
+          NEXT;
+      SCMD_CASE(SCMD_NEWARRAY):
           {
               int numElements = reg1.IValue;
               if ((numElements < 1) || (numElements > 1000000))
@@ -1182,9 +1204,9 @@ int ccInstance::Run(int32_t curpc)
               }
               DynObjectRef ref = globalDynamicArray.Create(numElements, arg2.IValue, arg3.GetAsBool());
               reg1.SetDynamicObject(ref.second, &globalDynamicArray);
-              break;
+              NEXT;
           }
-      case SCMD_NEWUSEROBJECT:
+      SCMD_CASE(SCMD_NEWUSEROBJECT):
           {
               const int32_t size = arg2.IValue;
               if (size < 0)
@@ -1194,43 +1216,43 @@ int ccInstance::Run(int32_t curpc)
               }
               ScriptUserObject *suo = ScriptUserObject::CreateManaged(size);
               reg1.SetDynamicObject(suo, suo);
-              break;
+              NEXT;
           }
-      case SCMD_FADD:
+      SCMD_CASE(SCMD_FADD):
           reg1.SetFloat(reg1.FValue + arg2.IValue); // arg2 was used as int here originally
-          break;
-      case SCMD_FSUB:
+          NEXT;
+      SCMD_CASE(SCMD_FSUB):
           reg1.SetFloat(reg1.FValue - arg2.IValue); // arg2 was used as int here originally
-          break;
-      case SCMD_FMULREG:
+          NEXT;
+      SCMD_CASE(SCMD_FMULREG):
           reg1.SetFloat(reg1.FValue * reg2.FValue);
-          break;
-      case SCMD_FDIVREG:
+          NEXT;
+      SCMD_CASE(SCMD_FDIVREG):
           if (reg2.FValue == 0.0) {
               cc_error("!Floating point divide by zero");
               return -1;
           } 
           reg1.SetFloat(reg1.FValue / reg2.FValue);
-          break;
-      case SCMD_FADDREG:
+          NEXT;
+      SCMD_CASE(SCMD_FADDREG):
           reg1.SetFloat(reg1.FValue + reg2.FValue);
-          break;
-      case SCMD_FSUBREG:
+          NEXT;
+      SCMD_CASE(SCMD_FSUBREG):
           reg1.SetFloat(reg1.FValue - reg2.FValue);
-          break;
-      case SCMD_FGREATER:
+          NEXT;
+      SCMD_CASE(SCMD_FGREATER):
           reg1.SetFloatAsBool(reg1.FValue > reg2.FValue);
-          break;
-      case SCMD_FLESSTHAN:
+          NEXT;
+      SCMD_CASE(SCMD_FLESSTHAN):
           reg1.SetFloatAsBool(reg1.FValue < reg2.FValue);
-          break;
-      case SCMD_FGTE:
+          NEXT;
+      SCMD_CASE(SCMD_FGTE):
           reg1.SetFloatAsBool(reg1.FValue >= reg2.FValue);
-          break;
-      case SCMD_FLTE:
+          NEXT;
+      SCMD_CASE(SCMD_FLTE):
           reg1.SetFloatAsBool(reg1.FValue <= reg2.FValue);
-          break;
-      case SCMD_ZEROMEMORY:
+          NEXT;
+      SCMD_CASE(SCMD_ZEROMEMORY):
           // Check if we are zeroing at stack tail
           if (registers[SREG_MAR] == registers[SREG_SP]) {
               // creating a local variable -- check the stack to ensure no mem overrun
@@ -1254,8 +1276,8 @@ int ccInstance::Run(int32_t curpc)
 				registers[SREG_MAR].Type);
             return -1;
           }
-          break;
-      case SCMD_CREATESTRING:
+          NEXT;
+      SCMD_CASE(SCMD_CREATESTRING):
           if (stringClassImpl == nullptr) {
               cc_error("No string class implementation set, but opcode was used");
               return -1;
@@ -1264,31 +1286,48 @@ int ccInstance::Run(int32_t curpc)
           reg1.SetDynamicObject(
               stringClassImpl->CreateString(direct_ptr1).second,
               &myScriptStringImpl);
-          break;
-      case SCMD_STRINGSEQUAL:
+          NEXT;
+      SCMD_CASE(SCMD_STRINGSEQUAL):
           if ((reg1.IsNull()) || (reg2.IsNull())) {
               cc_error("!Null pointer referenced");
               return -1;
           }
           direct_ptr1 = (const char*)reg1.GetDirectPtr();
           direct_ptr2 = (const char*)reg2.GetDirectPtr();
-          reg1.SetInt32AsBool(strcmp(direct_ptr1, direct_ptr2) == 0);
+          reg1.SetInt32AsBool(direct_ptr1 == direct_ptr2 || strcmp(direct_ptr1, direct_ptr2) == 0);
           
-          break;
-      case SCMD_STRINGSNOTEQ:
+          NEXT;
+      SCMD_CASE(SCMD_STRINGSNOTEQ):
           if ((reg1.IsNull()) || (reg2.IsNull())) {
               cc_error("!Null pointer referenced");
               return -1;
           }
           direct_ptr1 = (const char*)reg1.GetDirectPtr();
           direct_ptr2 = (const char*)reg2.GetDirectPtr();
-          reg1.SetInt32AsBool(strcmp(direct_ptr1, direct_ptr2) != 0 );
-          break;
-      case SCMD_LOOPCHECKOFF:
+          reg1.SetInt32AsBool(direct_ptr1 != direct_ptr2 && strcmp(direct_ptr1, direct_ptr2) != 0 );
+          NEXT;
+      SCMD_CASE(SCMD_LOOPCHECKOFF):
           if (loopIterationCheckDisabled == 0)
               loopIterationCheckDisabled++;
-          break;
-      default:
+          NEXT;
+      SCMD_CASE(SCMD_SUPER_LOADSPOFFS_MEMREAD):
+          registers[SREG_MAR] = GetStackPtrOffsetRw(arg1.IValue);
+          if (ccError)
+          {
+              return -1;
+          }
+          reg2 = registers[SREG_MAR].ReadValue();
+          NEXT;
+      SCMD_CASE(SCMD_SUPER_LITTOREG_PUSHREG):
+          reg1 = arg2;
+          ASSERT_STACK_SPACE_AVAILABLE(1);
+          PushValueToStack(registers[arg3.IValue]);
+          if (ccError)
+          {
+              return -1;
+          }
+          NEXT;
+      SCMD_DEFAULT:
           cc_error("instruction %d is not implemented", codeOp.Instruction.Code);
           return -1;
         }
@@ -1298,6 +1337,12 @@ int ccInstance::Run(int32_t curpc)
 
         pc += codeOp.ArgCount + 1;
     }
+#undef codeOp
+#undef arg1
+#undef arg2
+#undef arg3
+#undef reg1
+#undef reg2
 }
 
 String ccInstance::GetCallStack(int maxLines)
@@ -1340,6 +1385,19 @@ RuntimeScriptValue ccInstance::GetSymbolAddress(const char *symname)
     return rval_null;
 }
 
+const char *ccInstance::GetInstructionName(int32_t code)
+{
+    switch (code)
+    {
+    case SCMD_SUPER_LOADSPOFFS_MEMREAD: return "load.sp.offs+memread";
+    case SCMD_SUPER_LITTOREG_PUSHREG: return "mov+push";
+    default:
+        if (code >= 0 && code < CC_NUM_SCCMDS)
+            return sccmd_info[code].CmdName;
+        return "(unknown)";
+    }
+}
+
 void ccInstance::DumpInstruction(const ScriptOperation &op)
 {
     // line_num local var should be shared between all the instances
@@ -1460,6 +1518,8 @@ bool ccInstance::_Create(PScript scri, ccInstance * joined)
     {
         resolved_imports = joined->resolved_imports;
         code_fixups = joined->code_fixups;
+        code_ops = joined->code_ops;
+        code_op_index = joined->code_op_index;
     }
     else
     {
@@ -1475,6 +1535,10 @@ bool ccInstance::_Create(PScript scri, ccInstance * joined)
         {
             return false;
         }
+        if (!CreateDecodedOperations())
+        {
+            return false;
+        }
     }
 
     exports = new RuntimeScriptValue[scri->numexports];
@@ -1533,6 +1597,7 @@ void ccInstance::Free()
         if (instanceof->instances == 0)
         {
             simp.RemoveScriptExports(this);
+            ScriptProfiler::ForgetScript(instanceof.get());
         }
     }
 
@@ -1561,9 +1626,13 @@ void ccInstance::Free()
     {
         delete [] resolved_imports;
         delete [] code_fixups;
+        delete [] code_ops;
+        delete [] code_op_index;
     }
     resolved_imports = nullptr;
     code_fixups = nullptr;
+    code_ops = nullptr;
+    code_op_index = nullptr;
 }
 
 bool ccInstance::ResolveScriptImports(PScript scri)
@@ -1755,20 +1824,116 @@ bool ccInstance::CreateRuntimeCodeFixups(PScript scri)
     return true;
 }
 
-/*
-bool ccInstance::ReadOperation(ScriptOperation &op, int32_t at_pc)
+bool ccInstance::CreateDecodedOperations()
 {
-	op.Instruction.Code			= code[at_pc];
-	op.Instruction.InstanceId	= (op.Instruction.Code >> INSTANCE_ID_SHIFT) & INSTANCE_ID_MASK;
-	op.Instruction.Code		   &= INSTANCE_ID_REMOVEMASK; // now this is pure instruction code
+    // Operations are decoded sequentially from the beginning of the code;
+    // those that refer to stack or cannot be decoded for any other reason
+    // are left for the runtime, which will also report any error in them
+    std::vector<ScriptOperation> ops;
+    code_op_index = new int32_t[codesize];
+    for (int32_t at_pc = 0; at_pc < codesize;)
+    {
+        code_op_index[at_pc] = -1;
+        const int32_t instr = (int32_t)code[at_pc] & INSTANCE_ID_REMOVEMASK;
+        if (instr < 0 || instr >= CC_NUM_SCCMDS || at_pc + sccmd_info[instr].ArgCount >= codesize)
+        {
+            at_pc++;
+            continue;
+        }
+
+        const int arg_count = sccmd_info[instr].ArgCount;
+        bool can_decode = true;
+        for (int i = 1; i <= arg_count; ++i)
+        {
+            code_op_index[at_pc + i] = -1;
+            const char fixup = code_fixups[at_pc + i];
+            if (fixup == FIXUP_STACK ||
+                (fixup == FIXUP_IMPORT && !simp.getByIndex((int32_t)code[at_pc + i])))
+                can_decode = false;
+        }
 
-    int want_args = sccmd_info[op.Instruction.Code].ArgCount;
-    if (at_pc + want_args >= codesize)
+        if (can_decode)
+        {
+            ops.push_back(ScriptOperation());
+            if (!ReadOperation(ops.back(), at_pc, this))
+                return false;
+            code_op_index[at_pc] = (int32_t)(ops.size() - 1);
+        }
+        at_pc += arg_count + 1;
+    }
+
+    if (!ccGetOption(SCOPT_NOSUPERINSTR))
+        CreateSuperInstructions(ops);
+
+    code_ops = new ScriptOperation[ops.size()];
+    std::copy(ops.begin(), ops.end(), code_ops);
+    return true;
+}
+
+void ccInstance::CreateSuperInstructions(std::vector<ScriptOperation> &ops)
+{
+    // A fused operation replaces the first one of the sequence in the code
+    // index, while the following ones stay as they were, so that the jumps
+    // into the middle of the sequence are still valid
+    for (int32_t at_pc = 0; at_pc < codesize; ++at_pc)
     {
-        cc_error("unexpected end of code data at %d", at_pc + want_args);
+        if (code_op_index[at_pc] < 0)
+            continue;
+        const ScriptOperation first = ops[code_op_index[at_pc]];
+        const int32_t next_pc = at_pc + first.ArgCount + 1;
+        if (next_pc >= codesize || code_op_index[next_pc] < 0)
+            continue;
+        const ScriptOperation second = ops[code_op_index[next_pc]];
+
+        ScriptOperation fused;
+        if (first.Instruction.Code == SCMD_LOADSPOFFS && second.Instruction.Code == SCMD_MEMREAD)
+        {
+            fused.Instruction.Code = SCMD_SUPER_LOADSPOFFS_MEMREAD;
+            fused.Args[0] = first.Args[0];
+            fused.Args[1] = second.Args[0];
+        }
+        else if (first.Instruction.Code == SCMD_LITTOREG && second.Instruction.Code == SCMD_PUSHREG &&
+            second.Args[0].IValue >= 0 && second.Args[0].IValue < CC_NUM_REGISTERS)
+        {
+            fused.Instruction.Code = SCMD_SUPER_LITTOREG_PUSHREG;
+            fused.Args[0] = first.Args[0];
+            fused.Args[1] = first.Args[1];
+            fused.Args[2] = second.Args[0];
+        }
+        else
+        {
+            continue;
+        }
+        fused.ArgCount = first.ArgCount + second.ArgCount + 1;
+        ops.push_back(fused);
+        code_op_index[at_pc] = (int32_t)(ops.size() - 1);
+    }
+}
+
+bool ccInstance::ReadOperation(ScriptOperation &op, int32_t at_pc, ccInstance *stack_inst)
+{
+    if (at_pc < 0 || at_pc >= codesize)
+    {
+        cc_error("code offset is not valid (%d; %d)", at_pc, codesize);
+        return false;
+    }
+
+    op.Instruction.Code         = code[at_pc];
+    op.Instruction.InstanceId   = (op.Instruction.Code >> INSTANCE_ID_SHIFT) & INSTANCE_ID_MASK;
+    op.Instruction.Code        &= INSTANCE_ID_REMOVEMASK; // now this is pure instruction code
+
+    if (op.Instruction.Code < 0 || op.Instruction.Code >= CC_NUM_SCCMDS)
+    {
+        cc_error("invalid instruction %d found in code stream", op.Instruction.Code);
+        return false;
+    }
+
+    op.ArgCount = sccmd_info[op.Instruction.Code].ArgCount;
+    if (at_pc + op.ArgCount >= codesize)
+    {
+        cc_error("unexpected end of code data (%d; %d)", at_pc + op.ArgCount, codesize);
         return false;
     }
-    op.ArgCount = want_args;
 
     at_pc++;
     for (int i = 0; i < op.ArgCount; ++i, ++at_pc)
@@ -1777,7 +1942,7 @@ bool ccInstance::ReadOperation(ScriptOperation &op, int32_t at_pc)
         if (fixup > 0)
         {
             // could be relative pointer or import address
-            if (!FixupArgument(code[at_pc], fixup, op.Args[i]))
+            if (!FixupArgument(code[at_pc], fixup, op.Args[i], stack_inst))
             {
                 return false;
             }
@@ -1791,9 +1956,8 @@ bool ccInstance::ReadOperation(ScriptOperation &op, int32_t at_pc)
 
     return true;
 }
-*/
-/*
-bool ccInstance::FixupArgument(intptr_t code_value, char fixup_type, RuntimeScriptValue &argument)
+
+bool ccInstance::FixupArgument(intptr_t code_value, char fixup_type, RuntimeScriptValue &argument, ccInstance *stack_inst)
 {
     switch (fixup_type)
     {
@@ -1814,6 +1978,8 @@ bool ccInstance::FixupArgument(intptr_t code_value, char fixup_type, RuntimeScri
         break;
     case FIXUP_IMPORT:
         {
+            // NOTE: imports are not expected to change while the instance
+            // exists, same as the CALLAS instance ids written into the code
             const ScriptImport *import = simp.getByIndex((int32_t)code_value);
             if (import)
             {
@@ -1827,15 +1993,15 @@ bool ccInstance::FixupArgument(intptr_t code_value, char fixup_type, RuntimeScri
         }
         break;
     case FIXUP_STACK:
-        argument = GetStackPtrOffsetFw((int32_t)code_value);
+        argument = stack_inst->GetStackPtrOffsetFw((int32_t)code_value);
         break;
     default:
         cc_error("internal fixup type error: %d", fixup_type);
-        return false;;
+        return false;
     }
     return true;
 }
-*/
+
 //-----------------------------------------------------------------------------
 
 void ccInstance::PushValueToStack(const RuntimeScriptValue &rval)
@@ -21,6 +21,7 @@
 
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 #include "script/script_common.h"
 #include "script/cc_script.h"  // ccScript
@@ -148,6 +149,12 @@ public:
     int  numimports;
 
     char *code_fixups;
+    // Operations decoded once when the script is linked, with the code
+    // fixups already applied to their arguments
+    ScriptOperation *code_ops;
+    // Index of the decoded operation starting at each code position,
+    // or -1 if the operation has to be decoded at runtime
+    int32_t *code_op_index;
 
     // returns the currently executing instance, or NULL if none
     static ccInstance *GetCurrentInstance(void);
@@ -177,6 +184,8 @@ public:
     // Get the address of an exported symbol (function or variable) in the script
     RuntimeScriptValue GetSymbolAddress(const char *symname);
     void    DumpInstruction(const ScriptOperation &op);
+    // Get the readable name of the instruction
+    static const char *GetInstructionName(int32_t code);
     // Tells whether this instance is in the process of executing the byte-code
     bool    IsBeingRun() const;
 
@@ -190,10 +199,16 @@ protected:
     bool    AddGlobalVar(const ScriptVariable &glvar);
     ScriptVariable *FindGlobalVar(int32_t var_addr);
     bool    CreateRuntimeCodeFixups(PScript scri);
-	//bool    ReadOperation(ScriptOperation &op, int32_t at_pc);
+    // Decodes all the operations which do not depend on the runtime state
+    bool    CreateDecodedOperations();
+    // Fuses common sequences of decoded operations into superinstructions
+    void    CreateSuperInstructions(std::vector<ScriptOperation> &ops);
+    // Decodes operation at the given code position; stack fixups are
+    // resolved against the stack of the given instance
+    bool    ReadOperation(ScriptOperation &op, int32_t at_pc, ccInstance *stack_inst);
 
     // Runtime fixups
-    //bool    FixupArgument(intptr_t code_value, char fixup_type, RuntimeScriptValue &argument);
+    bool    FixupArgument(intptr_t code_value, char fixup_type, RuntimeScriptValue &argument, ccInstance *stack_inst);
 
     // Stack processing
     // Push writes new value and increments stack ptr;
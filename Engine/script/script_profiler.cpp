@@ -0,0 +1,260 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include "ac/timer.h"
+#include "script/cc_instance.h"
+#include "script/script_profiler.h"
+#include "util/file.h"
+#include "util/stream.h"
+#include "util/textstreamwriter.h"
+
+using namespace AGS::Common;
+
+namespace AGS
+{
+namespace Engine
+{
+
+namespace ScriptProfiler
+{
+
+// Node of the call tree; each distinct call stack has its own node
+struct CallNode
+{
+    uint32_t            Func;   // function id
+    uint32_t            Parent; // parent node index
+    std::unordered_map<uint32_t, uint32_t> Children; // function id to node index
+    uint64_t            Calls;
+    uint64_t            Instructions;
+    AGS_Clock::duration Time;
+
+    CallNode(uint32_t func, uint32_t parent)
+        : Func(func), Parent(parent), Calls(0), Instructions(0), Time(AGS_Clock::duration::zero()) {}
+};
+
+typedef std::pair<const ccScript*, int32_t> FuncKey;
+
+// Size of the instruction counter array; covers all real and engine-only
+// instruction codes
+const size_t InstructionCountSize = 256;
+
+bool                            Enabled = false;
+// Function ids by the script and entry position, and their display names
+std::map<FuncKey, uint32_t>     FuncIds;
+std::vector<String>             FuncNames;
+// Call tree, node 0 is the root, which is not a function
+std::vector<CallNode>           Nodes(1, CallNode(0, 0));
+// Current profiled call stack, as a list of node indexes
+std::vector<uint32_t>           Stack;
+AGS_Clock::time_point           LastMark;
+uint64_t                        InstructionCounts[InstructionCountSize];
+
+
+bool IsEnabled()
+{
+    return Enabled;
+}
+
+void SetEnabled(bool on)
+{
+    Enabled = on;
+    LastMark = AGS_Clock::now();
+}
+
+void Reset()
+{
+    FuncIds.clear();
+    FuncNames.clear();
+    Nodes.assign(1, CallNode(0, 0));
+    Stack.clear();
+    std::fill(InstructionCounts, InstructionCounts + InstructionCountSize, 0);
+    LastMark = AGS_Clock::now();
+}
+
+// Adds the time passed since the last mark to the current function
+static void MarkTime()
+{
+    const AGS_Clock::time_point now = AGS_Clock::now();
+    if (!Stack.empty())
+        Nodes[Stack.back()].Time += now - LastMark;
+    LastMark = now;
+}
+
+static String MakeFunctionName(const ccInstance *inst, int32_t entry_pc)
+{
+    const ccScript *scri = inst->instanceof.get();
+    String section = const_cast<ccScript*>(scri)->GetSectionName(entry_pc);
+    // Exported functions are known by name, others by their code position
+    for (int i = 0; i < scri->numexports; ++i)
+    {
+        const int32_t etype = (scri->export_addr[i] >> 24L) & 0x000ff;
+        const int32_t eaddr = (scri->export_addr[i] & 0x00ffffff);
+        if (etype == EXPORT_FUNCTION && eaddr == entry_pc)
+        {
+            String name = scri->exports[i];
+            size_t mangle_at = name.FindChar('$');
+            if (mangle_at != -1)
+                name.ClipRight(name.GetLength() - mangle_at);
+            return String::FromFormat("%s:%s", section.GetCStr(), name.GetCStr());
+        }
+    }
+    return String::FromFormat("%s:@%d", section.GetCStr(), entry_pc);
+}
+
+static uint32_t GetFunctionId(const ccInstance *inst, int32_t entry_pc)
+{
+    const FuncKey key(inst->instanceof.get(), entry_pc);
+    std::map<FuncKey, uint32_t>::const_iterator it = FuncIds.find(key);
+    if (it != FuncIds.end())
+        return it->second;
+    const uint32_t id = FuncNames.size();
+    FuncNames.push_back(MakeFunctionName(inst, entry_pc));
+    FuncIds.insert(std::make_pair(key, id));
+    return id;
+}
+
+void EnterFunction(const ccInstance *inst, int32_t entry_pc)
+{
+    MarkTime();
+    const uint32_t func = GetFunctionId(inst, entry_pc);
+    const uint32_t parent = Stack.empty() ? 0 : Stack.back();
+    std::unordered_map<uint32_t, uint32_t>::const_iterator it = Nodes[parent].Children.find(func);
+    uint32_t node;
+    if (it != Nodes[parent].Children.end())
+    {
+        node = it->second;
+    }
+    else
+    {
+        node = Nodes.size();
+        Nodes.push_back(CallNode(func, parent));
+        Nodes[parent].Children.insert(std::make_pair(func, node));
+    }
+    Nodes[node].Calls++;
+    Stack.push_back(node);
+}
+
+void LeaveFunction()
+{
+    if (Stack.empty())
+        return;
+    MarkTime();
+    Stack.pop_back();
+}
+
+size_t GetDepth()
+{
+    return Stack.size();
+}
+
+void UnwindTo(size_t depth)
+{
+    if (Stack.size() <= depth)
+        return;
+    MarkTime();
+    Stack.resize(depth);
+}
+
+void CountInstruction(int32_t code)
+{
+    InstructionCounts[code & (InstructionCountSize - 1)]++;
+    if (!Stack.empty())
+        Nodes[Stack.back()].Instructions++;
+}
+
+bool GetFunctionStats(const String &name, uint64_t &calls, uint64_t &instructions)
+{
+    calls = 0;
+    instructions = 0;
+    bool found = false;
+    for (size_t i = 1; i < Nodes.size(); ++i)
+    {
+        if (FuncNames[Nodes[i].Func] != name)
+            continue;
+        calls += Nodes[i].Calls;
+        instructions += Nodes[i].Instructions;
+        found = true;
+    }
+    return found;
+}
+
+void ForgetScript(const ccScript *script)
+{
+    // Function ids stay valid in the call tree, but the script's address
+    // may be reused by another script after this one is deleted
+    std::map<FuncKey, uint32_t>::iterator it = FuncIds.lower_bound(FuncKey(script, INT32_MIN));
+    while (it != FuncIds.end() && it->first.first == script)
+        it = FuncIds.erase(it);
+}
+
+static void WriteNode(TextStreamWriter &out, uint32_t node_index, const String &path, SampleType sample_type)
+{
+    const CallNode &node = Nodes[node_index];
+    String stack = path;
+    if (node_index > 0)
+    {
+        String name = FuncNames[node.Func];
+        name.Replace(';', ':'); // semicolons separate the stack frames
+        if (!stack.IsEmpty())
+            stack.AppendChar(';');
+        stack.Append(name);
+
+        const uint64_t value = sample_type == kSample_Instructions ? node.Instructions :
+            std::chrono::duration_cast<std::chrono::microseconds>(node.Time).count();
+        if (value > 0)
+            out.WriteFormat("%s %llu\n", stack.GetCStr(), (unsigned long long)value);
+    }
+    for (std::unordered_map<uint32_t, uint32_t>::const_iterator it = node.Children.begin();
+         it != node.Children.end(); ++it)
+        WriteNode(out, it->second, stack, sample_type);
+}
+
+bool WriteCollapsedStacks(const String &filename, SampleType sample_type)
+{
+    Stream *out = File::CreateFile(filename);
+    if (!out)
+        return false;
+    MarkTime();
+    TextStreamWriter writer(out);
+    WriteNode(writer, 0, "", sample_type);
+    return true;
+}
+
+bool WriteInstructionStats(const String &filename)
+{
+    Stream *out = File::CreateFile(filename);
+    if (!out)
+        return false;
+    std::vector<std::pair<uint64_t, int32_t>> counts;
+    for (size_t i = 0; i < InstructionCountSize; ++i)
+    {
+        if (InstructionCounts[i] > 0)
+            counts.push_back(std::make_pair(InstructionCounts[i], (int32_t)i));
+    }
+    std::sort(counts.rbegin(), counts.rend());
+    TextStreamWriter writer(out);
+    for (size_t i = 0; i < counts.size(); ++i)
+        writer.WriteFormat("%-32s %llu\n", ccInstance::GetInstructionName(counts[i].second),
+            (unsigned long long)counts[i].first);
+    return true;
+}
+
+} // namespace ScriptProfiler
+
+} // namespace Engine
+} // namespace AGS
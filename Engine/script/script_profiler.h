@@ -0,0 +1,93 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Script profiler counts executed instructions and time spent in the
+// script functions, separately for each distinct call stack.
+// The results may be written in the "collapsed stacks" text format, which
+// is accepted by the flamegraph tools: each line contains function names
+// separated by semicolons, followed by a space and the sample value.
+//
+//=============================================================================
+#ifndef __AGS_EE_SCRIPT__SCRIPTPROFILER_H
+#define __AGS_EE_SCRIPT__SCRIPTPROFILER_H
+
+#include "core/types.h"
+#include "util/string.h"
+
+struct ccInstance;
+struct ccScript;
+
+namespace AGS
+{
+namespace Engine
+{
+
+namespace ScriptProfiler
+{
+    // Which value to write as the collapsed stack samples
+    enum SampleType
+    {
+        kSample_Instructions,   // number of executed instructions
+        kSample_Microseconds    // time spent, in microseconds
+    };
+
+    // Tells if the profiler is collecting data
+    bool IsEnabled();
+    // Starts or stops collecting data; stopping does not clear the results
+    void SetEnabled(bool on);
+    // Clears all collected data
+    void Reset();
+
+    // Registers entering the script function which starts at the given
+    // code position of the instance
+    void EnterFunction(const ccInstance *inst, int32_t entry_pc);
+    // Registers leaving current script function
+    void LeaveFunction();
+    // Gets current depth of the profiled call stack
+    size_t GetDepth();
+    // Leaves the functions until the call stack is of the given depth;
+    // used when script execution is interrupted
+    void UnwindTo(size_t depth);
+    // Counts executed instruction with the given code
+    void CountInstruction(int32_t code);
+    // Gets the number of calls of the function with the given display name,
+    // and the instructions it executed, summed over all its call stacks;
+    // returns false if the function was never called
+    bool GetFunctionStats(const Common::String &name, uint64_t &calls, uint64_t &instructions);
+    // Should be called when the script is unloaded, as the profiler
+    // references scripts by their addresses
+    void ForgetScript(const ccScript *script);
+
+    // Writes collected data in collapsed stacks format
+    bool WriteCollapsedStacks(const Common::String &filename, SampleType sample_type);
+    // Writes the number of times each instruction was executed
+    bool WriteInstructionStats(const Common::String &filename);
+
+    // Helper class that unwinds the profiled call stack to the depth it
+    // was at when the helper was created
+    class StackGuard
+    {
+    public:
+        StackGuard(bool enabled) : _enabled(enabled), _depth(enabled ? GetDepth() : 0) {}
+        ~StackGuard() { if (_enabled) UnwindTo(_depth); }
+    private:
+        bool   _enabled;
+        size_t _depth;
+    };
+} // namespace ScriptProfiler
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_SCRIPT__SCRIPTPROFILER_H
@@ -15,6 +15,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "script/systemimports.h"
+#include "util/string_types.h"
 
 
 extern void quit(const char *);
@@ -22,6 +23,18 @@ extern void quit(const char *);
 SystemImports simp;
 SystemImports simp_for_plugin;
 
+// Special values of the hash table cells
+enum HashCell
+{
+    kHashCell_Empty   = -1,
+    kHashCell_Removed = -2
+};
+
+static size_t hash_name(const String &name)
+{
+    return FNV::Hash1a(name.GetCStr(), name.GetLength());
+}
+
 int SystemImports::add(const String &name, const RuntimeScriptValue &value, ccInstance *anotherscr)
 {
     int ixof;
@@ -35,22 +48,23 @@ int SystemImports::add(const String &name, const RuntimeScriptValue &value, ccIn
         return 0;
     }
 
-    ixof = imports.size();
-    for (size_t i = 0; i < imports.size(); ++i)
+    if (free_indexes.empty())
     {
-        if (imports[i].Name.IsEmpty())
-        {
-            ixof = i;
-            break;
-        }
+        ixof = imports.size();
+        imports.push_back(ScriptImport());
+    }
+    else
+    {
+        ixof = free_indexes.back();
+        free_indexes.pop_back();
     }
 
-    btree[name] = ixof;
-    if (ixof == imports.size())
-        imports.push_back(ScriptImport());
     imports[ixof].Name          = name; // TODO: rather make a string copy here for safety reasons
     imports[ixof].Value         = value;
     imports[ixof].InstancePtr   = anotherscr;
+    hash_insert(ixof);
+    if (name.FindChar('$') != -1)
+        mangled[name] = ixof;
     return 0;
 }
 
@@ -58,10 +72,7 @@ void SystemImports::remove(const String &name) {
     int idx = get_index_of(name);
     if (idx < 0)
         return;
-    btree.erase(imports[idx].Name);
-    imports[idx].Name.Empty();
-    imports[idx].Value.Invalidate();
-    imports[idx].InstancePtr = nullptr;
+    release(idx);
 }
 
 const ScriptImport *SystemImports::getByName(const String &name)
@@ -83,15 +94,15 @@ const ScriptImport *SystemImports::getByIndex(int index)
 
 int SystemImports::get_index_of(const String &name)
 {
-    IndexMap::const_iterator it = btree.find(name);
-    if (it != btree.end())
-        return it->second;
+    int idx = find_exact(name);
+    if (idx >= 0)
+        return idx;
 
     // CHECKME: what are "mangled names" and where do they come from?
     String mangled_name = String::FromFormat("%s$", name.GetCStr());
     // if it's a function with a mangled name, allow it
-    it = btree.lower_bound(mangled_name);
-    if (it != btree.end() && it->first.StartsWith(mangled_name))
+    IndexMap::const_iterator it = mangled.lower_bound(mangled_name);
+    if (it != mangled.end() && it->first.StartsWith(mangled_name))
         return it->second;
 
     if (name.GetLength() > 3)
@@ -120,17 +131,95 @@ void SystemImports::RemoveScriptExports(ccInstance *inst)
             continue;
 
         if (imports[i].InstancePtr == inst)
-        {
-            btree.erase(imports[i].Name);
-            imports[i].Name.Empty();
-            imports[i].Value.Invalidate();
-            imports[i].InstancePtr = nullptr;
-        }
+            release(i);
     }
 }
 
 void SystemImports::clear()
 {
-    btree.clear();
+    mangled.clear();
+    hash_table.clear();
+    hash_used = 0;
+    free_indexes.clear();
     imports.clear();
 }
+
+int SystemImports::find_exact(const String &name) const
+{
+    if (hash_table.empty())
+        return -1;
+    const size_t mask = hash_table.size() - 1;
+    for (size_t cell = hash_name(name) & mask; ; cell = (cell + 1) & mask)
+    {
+        const int idx = hash_table[cell];
+        if (idx == kHashCell_Empty)
+            return -1;
+        if (idx >= 0 && imports[idx].Name == name)
+            return idx;
+    }
+}
+
+void SystemImports::hash_insert(int index)
+{
+    // keep the table at most half full, counting removed cells,
+    // so that the probe sequences stay short
+    if ((hash_used + 1) * 2 > hash_table.size())
+    {
+        const size_t live_count = imports.size() - free_indexes.size();
+        size_t capacity = 64;
+        while (capacity < live_count * 4)
+            capacity *= 2;
+        rehash(capacity); // this also adds the new import
+        return;
+    }
+
+    const size_t mask = hash_table.size() - 1;
+    size_t cell = hash_name(imports[index].Name) & mask;
+    while (hash_table[cell] >= 0)
+        cell = (cell + 1) & mask;
+    if (hash_table[cell] == kHashCell_Empty)
+        hash_used++;
+    hash_table[cell] = index;
+}
+
+void SystemImports::hash_remove(int index)
+{
+    const size_t mask = hash_table.size() - 1;
+    for (size_t cell = hash_name(imports[index].Name) & mask; hash_table[cell] != kHashCell_Empty;
+         cell = (cell + 1) & mask)
+    {
+        if (hash_table[cell] == index)
+        {
+            hash_table[cell] = kHashCell_Removed;
+            return;
+        }
+    }
+}
+
+void SystemImports::rehash(size_t capacity)
+{
+    hash_table.assign(capacity, kHashCell_Empty);
+    hash_used = 0;
+    const size_t mask = capacity - 1;
+    for (size_t i = 0; i < imports.size(); ++i)
+    {
+        if (imports[i].Name.IsEmpty())
+            continue;
+        size_t cell = hash_name(imports[i].Name) & mask;
+        while (hash_table[cell] != kHashCell_Empty)
+            cell = (cell + 1) & mask;
+        hash_table[cell] = i;
+        hash_used++;
+    }
+}
+
+void SystemImports::release(int index)
+{
+    hash_remove(index);
+    if (imports[index].Name.FindChar('$') != -1)
+        mangled.erase(imports[index].Name);
+    imports[index].Name.Empty();
+    imports[index].Value.Invalidate();
+    imports[index].InstancePtr = nullptr;
+    free_indexes.push_back(index);
+}
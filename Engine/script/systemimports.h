@@ -38,12 +38,23 @@ struct ScriptImport
 struct SystemImports
 {
 private:
-    // Note we can't use a hash-map here, because we sometimes need to search
-    // by partial keys.
+    // Imports are found by the exact name using the open-addressing hash
+    // table of import indexes. Mangled function names (which have "$" followed
+    // by the number of arguments) are also kept in the sorted map, because
+    // they are sometimes searched for by the partial name.
     typedef std::map<String, int> IndexMap;
 
     std::vector<ScriptImport> imports;
-    IndexMap btree;
+    std::vector<int> free_indexes;  // released entries in the imports list
+    std::vector<int> hash_table;    // import index, or one of the HashCell values
+    size_t hash_used = 0;           // number of non-empty cells, including removed
+    IndexMap mangled;
+
+    int  find_exact(const String &name) const;
+    void hash_insert(int index);
+    void hash_remove(int index);
+    void rehash(size_t capacity);
+    void release(int index);
 
 public:
     int  add(const String &name, const RuntimeScriptValue &value, ccInstance *inst);
@@ -27,6 +27,13 @@ void Test_DoAllTests()
     Test_Version();
     Test_File();
     Test_IniFile();
+    Test_Compress();
+    Test_Script();
+    // benchmarks only print the timings, and take a while, so they
+    // are run only when requested explicitly
+#ifdef AGS_RUN_BENCHMARKS
+    Test_ScriptBenchmark();
+#endif
 
     Test_Gfx();
 }
@@ -18,6 +18,8 @@
 void Test_DoAllTests();
 // Math tests
 void Test_Math();
+// Compression tests
+void Test_Compress();
 // File tests
 void Test_File();
 void Test_IniFile();
@@ -25,6 +27,9 @@ void Test_IniFile();
 void Test_Gfx();
 // Memory / bit-byte operations
 void Test_Memory();
+// Script interpreter tests
+void Test_Script();
+void Test_ScriptBenchmark();
 // String tests
 void Test_ScriptSprintf();
 void Test_String();
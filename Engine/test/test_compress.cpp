@@ -0,0 +1,77 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include "core/platform.h"
+#ifdef AGS_RUN_TESTS
+
+#include <string.h>
+#include <vector>
+#include "debug/assert.h"
+#include "util/compress.h"
+
+// Compresses and decompresses the data, returns the compressed size
+size_t Test_LZ4RoundTrip(const std::vector<uint8_t> &data)
+{
+    std::vector<uint8_t> packed(lz4_compress_bound(data.size()));
+    const size_t packed_size = lz4_compress_block(data.data(), data.size(), packed.data(), packed.size());
+    assert(packed_size > 0);
+    std::vector<uint8_t> unpacked(data.size() + 1);
+    assert(lz4_decompress_block(packed.data(), packed_size, unpacked.data(), data.size()));
+    assert(memcmp(data.data(), unpacked.data(), data.size()) == 0);
+    // wrong expected size must be reported
+    assert(!lz4_decompress_block(packed.data(), packed_size, unpacked.data(), data.size() + 1));
+    return packed_size;
+}
+
+void Test_Compress()
+{
+    // Empty and tiny inputs are stored as literals
+    Test_LZ4RoundTrip(std::vector<uint8_t>());
+    Test_LZ4RoundTrip(std::vector<uint8_t>(1, 0x55));
+    Test_LZ4RoundTrip(std::vector<uint8_t>(12, 0x55));
+
+    // Repeating data must compress well; this also tests overlapping matches
+    std::vector<uint8_t> data(100000, 0xAB);
+    assert(Test_LZ4RoundTrip(data) < data.size() / 100);
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = (uint8_t)(i % 7);
+    assert(Test_LZ4RoundTrip(data) < data.size() / 100);
+
+    // Pseudo-random data is not compressible, but must survive the round trip
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        data[i] = (uint8_t)(seed >> 16);
+    }
+    Test_LZ4RoundTrip(data);
+    // Mixed data, with long literal runs and long matches
+    for (size_t i = 0; i < data.size() / 2; ++i)
+        data[i] = (uint8_t)((i / 1000) & 0xFF);
+    Test_LZ4RoundTrip(data);
+
+    // Output buffer too small
+    std::vector<uint8_t> packed(16);
+    assert(lz4_compress_block(data.data(), data.size(), packed.data(), packed.size()) == 0);
+
+    // Corrupt data must be rejected: back reference before the data start
+    const uint8_t bad_offset[] = { 0x14, 'A', 0x05, 0x00, 0x10, 'B' };
+    uint8_t out[32];
+    assert(!lz4_decompress_block(bad_offset, sizeof(bad_offset), out, 7));
+    // literal length exceeding the input
+    const uint8_t bad_literals[] = { 0x50, 'A', 'B' };
+    assert(!lz4_decompress_block(bad_literals, sizeof(bad_literals), out, 5));
+}
+
+#endif // AGS_RUN_TESTS
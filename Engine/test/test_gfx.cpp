@@ -15,11 +15,247 @@
 #include "core/platform.h"
 #ifdef AGS_RUN_TESTS
 
+#include <errno.h>
 #include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include "gfx/blender.h"
 #include "gfx/gfx_def.h"
+#include "gfx/memoryrenderer.h"
+#include "gfx/textureatlas.h"
 #include "debug/assert.h"
+#include "util/wgt2allg.h"
+
+extern "C" {
+    unsigned long _blender_trans24(unsigned long x, unsigned long y, unsigned long n);
+    unsigned long _blender_alpha32(unsigned long x, unsigned long y, unsigned long n);
+}
+unsigned long _myblender_alpha_trans24(unsigned long x, unsigned long y, unsigned long n);
+unsigned long _additive_alpha_copysrc_blender(unsigned long x, unsigned long y, unsigned long n);
 
 namespace GfxDef = AGS::Common::GfxDef;
+using AGS::Common::Bitmap;
+using AGS::Engine::AtlasRegion;
+using AGS::Engine::MemoryBatchRenderer;
+using AGS::Engine::MemoryDDB;
+using AGS::Engine::MemoryDrawListEntry;
+using AGS::Engine::MemorySpriteBatch;
+using AGS::Engine::TextureAtlas;
+
+// Tests that row blenders give same result as per-pixel blenders
+void Test_RowBlenders()
+{
+    // Every combination of source and destination alpha, with pseudo-random
+    // colors and some mask color pixels; odd size tests unaligned row end
+    const size_t count = 256 * 256 + 3;
+    std::vector<uint32_t> src(count), dst(count), expect(count), result(count);
+    uint32_t seed = 1;
+    for (size_t i = 0; i < count; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        src[i] = (((i >> 8) & 0xFF) << 24) | ((seed >> 8) & 0xFFFFFF);
+        seed = seed * 1103515245 + 12345;
+        dst[i] = ((i & 0xFF) << 24) | ((seed >> 8) & 0xFFFFFF);
+        if (i % 37 == 0)
+            src[i] = MASK_COLOR_32;
+    }
+
+    const PfnPixelBlender trans_blenders[] = { _argb2argb_blender, _rgb2argb_blender, _argb2rgb_blender,
+        _blender_alpha32, _trans_alpha_blender32, _blender_trans24, _myblender_alpha_trans24,
+        _additive_alpha_copysrc_blender, _opaque_alpha_blender };
+    const unsigned long alphas[] = { 0, 1, 100, 128, 254, 255 };
+    for (PfnPixelBlender pixel_blender : trans_blenders)
+    {
+        PfnTransRowBlender row_blender = get_trans_row_blender32(pixel_blender);
+        assert(row_blender);
+        for (unsigned long alpha : alphas)
+        {
+            for (size_t i = 0; i < count; ++i)
+                expect[i] = src[i] == MASK_COLOR_32 ? dst[i] : (uint32_t)pixel_blender(src[i], dst[i], alpha);
+            result = dst;
+            row_blender(result.data(), src.data(), count, alpha);
+            assert(result == expect);
+            // row start may be unaligned too
+            result = dst;
+            row_blender(result.data() + 1, src.data() + 1, count - 1, alpha);
+            assert(result[0] == dst[0] && std::equal(result.begin() + 1, result.end(), expect.begin() + 1));
+        }
+    }
+
+    const PfnPixelBlender lit_blenders[] = { _blender_trans24, _myblender_alpha_trans24,
+        _myblender_color32, _myblender_color32_light };
+    const unsigned long color = makecol32(200, 100, 50);
+    for (PfnPixelBlender pixel_blender : lit_blenders)
+    {
+        PfnLitRowBlender row_blender = get_lit_row_blender32(pixel_blender);
+        assert(row_blender);
+        for (unsigned long light : alphas)
+        {
+            for (size_t i = 0; i < count; ++i)
+                expect[i] = src[i] == MASK_COLOR_32 ? dst[i] : (uint32_t)pixel_blender(color, src[i], light);
+            result = dst;
+            row_blender(result.data(), src.data(), count, color, light);
+            assert(result == expect);
+        }
+    }
+}
+
+// Tests that atlas regions never overlap, and that freed space is reused
+void Test_TextureAtlas()
+{
+    const int page_w = 64, page_h = 64;
+    TextureAtlas atlas;
+    atlas.Init(page_w, page_h, 2);
+    AtlasRegion big;
+    assert(!atlas.Allocate(page_w + 1, 8, big));
+
+    // Fill the pages with the images of various sizes, checking overlaps
+    std::vector<uint8_t> used(2 * page_w * page_h);
+    std::vector<AtlasRegion> regions;
+    uint32_t seed = 1;
+    for (;;)
+    {
+        seed = seed * 1103515245 + 12345;
+        const int w = 1 + (seed >> 16) % 20;
+        const int h = 1 + (seed >> 8) % 20;
+        AtlasRegion r;
+        if (!atlas.Allocate(w, h, r))
+            break;
+        assert(r.Page >= 0 && r.Page < 2 && r.Width == w && r.Height == h);
+        assert(r.X >= 0 && r.Y >= 0 && r.X + w <= page_w && r.Y + h <= page_h);
+        for (int y = r.Y; y < r.Y + h; ++y)
+            for (int x = r.X; x < r.X + w; ++x)
+            {
+                uint8_t &px = used[r.Page * page_w * page_h + y * page_w + x];
+                assert(px == 0);
+                px = 1;
+            }
+        regions.push_back(r);
+    }
+    assert(regions.size() > 16);
+    assert(atlas.GetPageCount() == 2);
+
+    // Freed space is reused by the images of another height, and a page
+    // with no images left is released
+    size_t last_on_page1 = 0;
+    for (size_t i = 0; i < regions.size(); ++i)
+    {
+        if (regions[i].Page == 1)
+            last_on_page1 = i;
+    }
+    for (size_t i = 0; i < regions.size(); ++i)
+    {
+        if (regions[i].Page == 1)
+            assert(atlas.Free(regions[i]) == (i == last_on_page1));
+    }
+    assert(!atlas.IsPageInUse(1));
+    for (size_t i = 0; i < regions.size(); ++i)
+    {
+        if (regions[i].Page == 0)
+            atlas.Free(regions[i]);
+    }
+    assert(!atlas.IsPageInUse(0));
+    assert(atlas.Allocate(page_w, page_h, big));
+    assert(big.X == 0 && big.Y == 0);
+    assert(!atlas.Free(AtlasRegion()));
+    assert(atlas.Free(big));
+}
+
+// Surface which the null sprite callback draws upon
+static Bitmap *TestNullSpriteSurface;
+
+static bool TestNullSpriteCallback(int x, int y)
+{
+    TestNullSpriteSurface->FillRect(RectWH(x, y, 20, 10), 0x00102030);
+    return true;
+}
+
+// Fills the 32-bit bitmap with pseudo-random colors and some mask color pixels
+static void FillTestBitmap(Bitmap *bmp, uint32_t seed, bool with_alpha)
+{
+    for (int y = 0; y < bmp->GetHeight(); ++y)
+    {
+        uint32_t *row = reinterpret_cast<uint32_t*>(bmp->GetScanLineForWriting(y));
+        for (int x = 0; x < bmp->GetWidth(); ++x)
+        {
+            seed = seed * 1103515245 + 12345;
+            row[x] = with_alpha ? seed : ((seed >> 8) & 0xFFFFFF);
+            if ((x + y) % 7 == 0)
+                row[x] = MASK_COLOR_32;
+        }
+    }
+}
+
+static void CompareBandRendererOutput()
+{
+    const int surf_w = 120, surf_h = 100;
+    std::vector<std::unique_ptr<Bitmap>> sprites;
+    std::vector<std::unique_ptr<MemoryDDB>> ddbs;
+    MemorySpriteBatch batch;
+    // opaque, masked, alpha blended, translucent and invisible sprites,
+    // some of them partially off the surface
+    struct { int W, H, X, Y; bool Opaque, Alpha; int Trans; } const sprite_defs[] = {
+        { 50, 40, -10,  -5, true,  false, 0 },
+        { 70, 30,  30,  20, false, false, 0 },
+        { 40, 60,  70,  50, false, true,  0 },
+        { 90, 25,  10,  60, false, true,  100 },
+        { 30, 90,  40, -20, false, false, 128 },
+        { 60, 60,  20,  20, false, false, 255 },
+        { 45, 45,  90,  80, false, true,  0 },
+    };
+    uint32_t seed = 1;
+    for (const auto &def : sprite_defs)
+    {
+        sprites.emplace_back(new Bitmap(def.W, def.H, 32));
+        FillTestBitmap(sprites.back().get(), seed++, def.Alpha);
+        ddbs.emplace_back(new MemoryDDB(sprites.back().get(), def.Opaque, def.Alpha));
+        ddbs.back()->SetTransparency(def.Trans);
+        batch.List.push_back(MemoryDrawListEntry(ddbs.back().get(), def.X, def.Y));
+        // plugin callback in the middle of the list must keep the draw order
+        if (batch.List.size() == 3)
+            batch.List.push_back(MemoryDrawListEntry(nullptr, 55, 35));
+    }
+
+    Bitmap background(surf_w, surf_h, 32);
+    FillTestBitmap(&background, 100, false);
+    const Rect clip(5, 3, surf_w - 8, surf_h - 21);
+    Bitmap expect(surf_w, surf_h, 32), result(surf_w, surf_h, 32);
+    MemoryBatchRenderer renderer;
+    for (int tint = 0; tint < 2; ++tint)
+    {
+        const int tint_r = tint ? 40 : 0, tint_g = tint ? 80 : 0, tint_b = tint ? 120 : 0;
+        expect.Blit(&background, 0, 0, 0, 0, surf_w, surf_h);
+        expect.SetClip(clip);
+        TestNullSpriteSurface = &expect;
+        renderer.SetThreadCount(1);
+        renderer.RenderSpriteBatch(batch, &expect, 3, 2, TestNullSpriteCallback, tint_r, tint_g, tint_b);
+
+        result.Blit(&background, 0, 0, 0, 0, surf_w, surf_h);
+        result.SetClip(clip);
+        TestNullSpriteSurface = &result;
+        renderer.SetThreadCount(4);
+        renderer.RenderSpriteBatch(batch, &result, 3, 2, TestNullSpriteCallback, tint_r, tint_g, tint_b);
+
+        for (int y = 0; y < surf_h; ++y)
+            assert(memcmp(expect.GetScanLine(y), result.GetScanLine(y), surf_w * sizeof(uint32_t)) == 0);
+    }
+    TestNullSpriteSurface = nullptr;
+}
+
+// Tests that sprite batch drawn in surface bands on several threads gives
+// same result as drawn on the calling thread
+void Test_BandRenderer()
+{
+    // Bitmaps may only be created when Allegro is installed
+    const bool own_allegro = system_driver == nullptr;
+    if (own_allegro)
+        install_allegro(SYSTEM_NONE, &errno, atexit);
+    CompareBandRendererOutput();
+    if (own_allegro)
+        allegro_exit();
+}
 
 void Test_Gfx()
 {
@@ -36,6 +272,10 @@ void Test_Gfx()
         trans100_back[i] = GfxDef::LegacyTrans255ToTrans100(trans255[i]);
         assert(trans100[i] == trans100_back[i]);
     }
+
+    Test_RowBlenders();
+    Test_TextureAtlas();
+    Test_BandRenderer();
 }
 
 #endif // AGS_RUN_TESTS
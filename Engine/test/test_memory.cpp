@@ -15,11 +15,54 @@
 #include "core/platform.h"
 #ifdef AGS_RUN_TESTS
 
+#include <string.h>
+#include <vector>
 #include "util/memory.h"
+#include "util/slaballocator.h"
 #include "debug/assert.h"
 
 using namespace AGS::Common;
 
+void Test_SlabAllocator()
+{
+    SlabAllocator alloc(4096);
+    std::vector<void*> blocks;
+    // blocks of all the size classes and the large ones
+    for (size_t size = 0; size < 5000; size += 7)
+    {
+        void *p = alloc.Allocate(size);
+        assert(p != nullptr);
+        assert(((uintptr_t)p % 8) == 0);
+        memset(p, (int)(size & 0xFF), size);
+        blocks.push_back(p);
+    }
+    const SlabAllocatorStats &stats = alloc.GetStats();
+    assert(stats.LiveBlocks == blocks.size());
+    assert(stats.LargeAllocations > 0);
+    assert(stats.UsedBytes >= stats.LiveBytes);
+    assert(stats.ReservedBytes >= stats.UsedBytes);
+    // blocks must not overlap
+    for (size_t i = 0; i < blocks.size(); ++i)
+    {
+        const uint8_t *p = (const uint8_t*)blocks[i];
+        for (size_t j = 0; j < i * 7; ++j)
+            assert(p[j] == (uint8_t)((i * 7) & 0xFF));
+    }
+
+    // freed blocks are reused
+    const size_t reserved = stats.ReservedBytes;
+    void *p = blocks[10];
+    alloc.Free(p);
+    assert(alloc.Allocate(70) == p);
+    for (void *b : blocks)
+        alloc.Free(b);
+    assert(stats.LiveBlocks == 0);
+    assert(stats.LiveBytes == 0);
+    assert(stats.UsedBytes == 0);
+    assert(stats.ReservedBytes < reserved); // large blocks are released
+    assert(stats.GetFragmentation() == 1.f);
+}
+
 void Test_Memory()
 {
     int16_t i16 = (int16_t)0xABCD;
@@ -78,6 +121,8 @@ void Test_Memory()
     assert(dst_i16 == (int16_t)0xCDAB);
     assert(dst_i32 == (int32_t)0x12EFCDAB);
     assert(dst_i64 == (int64_t)0x9078563412EFCDAB);
+
+    Test_SlabAllocator();
 }
 
 #endif // AGS_RUN_TESTS
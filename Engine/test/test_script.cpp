@@ -0,0 +1,205 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include "core/platform.h"
+#ifdef AGS_RUN_TESTS
+
+#include <stdio.h>
+#include <algorithm>
+#include <stdlib.h>
+#include <vector>
+#include "ac/timer.h"
+#include "debug/assert.h"
+#include "script/cc_instance.h"
+#include "script/cc_options.h"
+#include "script/script_profiler.h"
+#include "script/script_runtime.h"
+#include "util/string_compat.h"
+
+using namespace AGS::Engine;
+
+// Number of iterations of the loop in the test script
+const int32_t TestLoopCount = 50000;
+// Number of the script instructions executed by the test script
+const int64_t TestInstructionCount = 16 + 16 * (int64_t)TestLoopCount;
+
+RuntimeScriptValue Sc_TestScriptNop(const RuntimeScriptValue *params, int32_t param_count)
+{
+    return RuntimeScriptValue().SetInt32(0);
+}
+
+// Helps to put together the script byte-code
+struct TestScriptWriter
+{
+    std::vector<int32_t> Code;
+    std::vector<int32_t> Fixups;
+    std::vector<char>    FixupTypes;
+
+    int32_t Op(int32_t cmd)
+    {
+        Code.push_back(cmd);
+        return Code.size() - 1;
+    }
+    int32_t Op(int32_t cmd, int32_t arg1)
+    {
+        int32_t at = Op(cmd);
+        Code.push_back(arg1);
+        return at;
+    }
+    int32_t Op(int32_t cmd, int32_t arg1, int32_t arg2)
+    {
+        int32_t at = Op(cmd, arg1);
+        Code.push_back(arg2);
+        return at;
+    }
+    void Fixup(char type)
+    {
+        Fixups.push_back(Code.size() - 1);
+        FixupTypes.push_back(type);
+    }
+    // Sets jump offset of the instruction at given position
+    void JumpTo(int32_t at, int32_t to)
+    {
+        Code[at + 1] = to - (at + 2);
+    }
+};
+
+// Makes a script with function "Test$0", equivalent to:
+//
+// int Test()
+// {
+//     TestScriptNop();
+//     int i = 0;
+//     int sum = 0;
+//     while (i < TestLoopCount) { sum += i; i++; }
+//     return sum;
+// }
+PScript Test_MakeScript()
+{
+    TestScriptWriter w;
+    w.Op(SCMD_LOOPCHECKOFF);
+    w.Op(SCMD_LITTOREG, SREG_AX, 0); w.Fixup(FIXUP_IMPORT);
+    w.Op(SCMD_CALLEXT, SREG_AX);
+    w.Op(SCMD_LITTOREG, SREG_AX, 0);
+    w.Op(SCMD_PUSHREG, SREG_AX); // i
+    w.Op(SCMD_LITTOREG, SREG_AX, 0);
+    w.Op(SCMD_PUSHREG, SREG_AX); // sum
+    const int32_t loop_at = w.Op(SCMD_LOADSPOFFS, 8);
+    w.Op(SCMD_MEMREAD, SREG_AX);
+    w.Op(SCMD_LITTOREG, SREG_BX, TestLoopCount);
+    w.Op(SCMD_LESSTHAN, SREG_AX, SREG_BX);
+    const int32_t jz_at = w.Op(SCMD_JZ, 0);
+    w.Op(SCMD_LOADSPOFFS, 4);
+    w.Op(SCMD_MEMREAD, SREG_CX);
+    w.Op(SCMD_LOADSPOFFS, 8);
+    w.Op(SCMD_MEMREAD, SREG_AX);
+    w.Op(SCMD_ADDREG, SREG_CX, SREG_AX);
+    w.Op(SCMD_LOADSPOFFS, 4);
+    w.Op(SCMD_MEMWRITE, SREG_CX);
+    w.Op(SCMD_ADD, SREG_AX, 1);
+    w.Op(SCMD_LOADSPOFFS, 8);
+    w.Op(SCMD_MEMWRITE, SREG_AX);
+    const int32_t jmp_at = w.Op(SCMD_JMP, 0);
+    const int32_t end_at = w.Op(SCMD_LOADSPOFFS, 4);
+    w.Op(SCMD_MEMREAD, SREG_AX);
+    w.Op(SCMD_SUB, SREG_SP, 8);
+    w.Op(SCMD_RET);
+    w.JumpTo(jz_at, end_at);
+    w.JumpTo(jmp_at, loop_at);
+
+    PScript scri(new ccScript());
+    scri->codesize = w.Code.size();
+    scri->code = (int32_t*)malloc(w.Code.size() * sizeof(int32_t));
+    std::copy(w.Code.begin(), w.Code.end(), scri->code);
+    scri->numfixups = w.Fixups.size();
+    scri->fixups = (int32_t*)malloc(w.Fixups.size() * sizeof(int32_t));
+    std::copy(w.Fixups.begin(), w.Fixups.end(), scri->fixups);
+    scri->fixuptypes = (char*)malloc(w.FixupTypes.size());
+    std::copy(w.FixupTypes.begin(), w.FixupTypes.end(), scri->fixuptypes);
+    scri->numimports = scri->importsCapacity = 1;
+    scri->imports = (char**)malloc(sizeof(char*));
+    scri->imports[0] = ags_strdup("TestScriptNop");
+    scri->numexports = scri->exportsCapacity = 1;
+    scri->exports = (char**)malloc(sizeof(char*));
+    scri->exports[0] = ags_strdup("Test$0");
+    scri->export_addr = (int32_t*)malloc(sizeof(int32_t));
+    scri->export_addr[0] = (EXPORT_FUNCTION << 24) | 0;
+    return scri;
+}
+
+// Runs the test script several times, returns the number of instructions
+// executed per second
+double Test_RunScript(PScript scri, bool super_instr, bool switch_dispatch, int run_count)
+{
+    ccSetOption(SCOPT_NOSUPERINSTR, !super_instr);
+    ccSetOption(SCOPT_SWITCHDISPATCH, switch_dispatch);
+    ccInstance *inst = ccInstance::CreateFromScript(scri);
+    assert(inst);
+
+    const int32_t expect = (int32_t)((int64_t)TestLoopCount * (TestLoopCount - 1) / 2);
+    const AGS_Clock::time_point start = AGS_Clock::now();
+    for (int i = 0; i < run_count; ++i)
+    {
+        int result = inst->CallScriptFunction("Test", 0, nullptr);
+        assert(result == 0);
+        assert(inst->returnValue == expect);
+    }
+    const double secs = std::chrono::duration<double>(AGS_Clock::now() - start).count();
+
+    delete inst;
+    ccSetOption(SCOPT_NOSUPERINSTR, 0);
+    ccSetOption(SCOPT_SWITCHDISPATCH, 0);
+    return secs > 0.0 ? (TestInstructionCount * run_count) / secs : 0.0;
+}
+
+void Test_Script()
+{
+    ccAddExternalStaticFunction("TestScriptNop", Sc_TestScriptNop);
+    PScript scri = Test_MakeScript();
+    // All the dispatch modes must give same results
+    Test_RunScript(scri, false, true, 1);
+    Test_RunScript(scri, true, true, 1);
+    Test_RunScript(scri, false, false, 1);
+    Test_RunScript(scri, true, false, 1);
+    // Profiler must see a balanced call stack, and record every call
+    ScriptProfiler::Reset();
+    ScriptProfiler::SetEnabled(true);
+    Test_RunScript(scri, true, false, 2);
+    assert(ScriptProfiler::GetDepth() == 0);
+    uint64_t calls, instructions;
+    assert(ScriptProfiler::GetFunctionStats("(unknown section):Test", calls, instructions));
+    assert(calls == 2);
+    assert(instructions > 0);
+    assert(!ScriptProfiler::GetFunctionStats("(unknown section):NoSuchFunction", calls, instructions));
+    ScriptProfiler::SetEnabled(false);
+    ScriptProfiler::Reset();
+    ccRemoveExternalSymbol("TestScriptNop");
+}
+
+void Test_ScriptBenchmark()
+{
+    const int run_count = 20;
+    ccAddExternalStaticFunction("TestScriptNop", Sc_TestScriptNop);
+    PScript scri = Test_MakeScript();
+    printf("Script benchmark, instructions per second:\n");
+    printf("  switch dispatch:                       %.0f\n", Test_RunScript(scri, false, true, run_count));
+    printf("  switch dispatch, superinstructions:    %.0f\n", Test_RunScript(scri, true, true, run_count));
+#if defined(AGS_SCRIPT_THREADED_DISPATCH) && (defined(__GNUC__) || defined(__clang__))
+    printf("  threaded dispatch:                     %.0f\n", Test_RunScript(scri, false, false, run_count));
+    printf("  threaded dispatch, superinstructions:  %.0f\n", Test_RunScript(scri, true, false, run_count));
+#endif
+    ccRemoveExternalSymbol("TestScriptNop");
+}
+
+#endif // AGS_RUN_TESTS